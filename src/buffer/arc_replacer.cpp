@@ -0,0 +1,210 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+ARCReplacer::ARCReplacer(size_t num_frames)
+    : num_frames_(num_frames), frames_(num_frames), t1_(num_frames), t2_(num_frames) {}
+
+auto ARCReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto victims = PickVictims(1);
+  if (victims.empty()) {
+    return false;
+  }
+  auto &frame = frames_[victims[0]];
+  if (frame.list_ == List::T1) {
+    t1_.Erase(victims[0]);
+    if (frame.referenced_ && frame.page_id_ != INVALID_PAGE_ID) {
+      b1_.PushFront(frame.page_id_);
+    }
+  } else {
+    t2_.Erase(victims[0]);
+    if (frame.page_id_ != INVALID_PAGE_ID) {
+      b2_.PushFront(frame.page_id_);
+    }
+  }
+  TrimGhosts();
+  frame = Frame{};
+  size_--;
+  *frame_id = victims[0];
+  return true;
+}
+
+void ARCReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  std::lock_guard<std::mutex> guard(latch_);
+  CheckFrameId(frame_id);
+  auto &frame = frames_[frame_id];
+  bool use = access_type != AccessType::Scan && access_type != AccessType::Prefetch;
+  switch (frame.list_) {
+    case List::None: {
+      // the page was just loaded into the frame
+      auto page_id = frame.page_id_;
+      bool in_b1 = page_id != INVALID_PAGE_ID && b1_.Contains(page_id);
+      bool in_b2 = page_id != INVALID_PAGE_ID && b2_.Contains(page_id);
+      if (use && in_b1) {
+        target_ = std::min(num_frames_, target_ + std::max<size_t>(1, b2_.Size() / b1_.Size()));
+      } else if (use && in_b2) {
+        auto delta = std::max<size_t>(1, b1_.Size() / b2_.Size());
+        target_ = target_ > delta ? target_ - delta : 0;
+      }
+      b1_.Erase(page_id);
+      b2_.Erase(page_id);
+      if (use && (in_b1 || in_b2)) {
+        frame.list_ = List::T2;
+        t2_.PushFront(frame_id);
+      } else {
+        frame.list_ = List::T1;
+        t1_.PushFront(frame_id);
+      }
+      frame.referenced_ = use;
+      TrimGhosts();
+      break;
+    }
+    case List::T1:
+      if (!use) {
+        break;
+      }
+      if (frame.referenced_) {
+        t1_.Erase(frame_id);
+        frame.list_ = List::T2;
+        t2_.PushFront(frame_id);
+      } else {
+        // the first use of a page that was scanned or prefetched
+        frame.referenced_ = true;
+        t1_.MoveToFront(frame_id);
+      }
+      break;
+    case List::T2:
+      if (use) {
+        t2_.MoveToFront(frame_id);
+      }
+      break;
+  }
+}
+
+void ARCReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::lock_guard<std::mutex> guard(latch_);
+  CheckFrameId(frame_id);
+  auto &frame = frames_[frame_id];
+  if (frame.list_ == List::None || frame.evictable_ == set_evictable) {
+    return;
+  }
+  frame.evictable_ = set_evictable;
+  if (set_evictable) {
+    size_++;
+  } else {
+    size_--;
+  }
+}
+
+void ARCReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  CheckFrameId(frame_id);
+  auto &frame = frames_[frame_id];
+  if (frame.list_ == List::None) {
+    return;
+  }
+  BUSTUB_ENSURE(frame.evictable_, "cannot remove a non-evictable frame");
+  if (frame.list_ == List::T1) {
+    t1_.Erase(frame_id);
+  } else {
+    t2_.Erase(frame_id);
+  }
+  frame = Frame{};
+  size_--;
+}
+
+auto ARCReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> guard(latch_);
+  return size_;
+}
+
+auto ARCReplacer::EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> guard(latch_);
+  return PickVictims(max_frames);
+}
+
+void ARCReplacer::Resize(size_t num_frames) {
+  std::lock_guard<std::mutex> guard(latch_);
+  for (auto frame_id = num_frames; frame_id < num_frames_; frame_id++) {
+    BUSTUB_ENSURE(frames_[frame_id].list_ == List::None, "cannot drop a tracked frame");
+  }
+  num_frames_ = num_frames;
+  target_ = std::min(target_, num_frames);
+  frames_.resize(num_frames);
+  t1_.Resize(num_frames);
+  t2_.Resize(num_frames);
+  TrimGhosts();
+}
+
+void ARCReplacer::SetPage(frame_id_t frame_id, page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  CheckFrameId(frame_id);
+  frames_[frame_id].page_id_ = page_id;
+}
+
+auto ARCReplacer::GetTarget() -> size_t {
+  std::lock_guard<std::mutex> guard(latch_);
+  return target_;
+}
+
+void ARCReplacer::CheckFrameId(frame_id_t frame_id) const {
+  BUSTUB_ENSURE(frame_id >= 0 && static_cast<size_t>(frame_id) < num_frames_, "invalid frame id");
+}
+
+auto ARCReplacer::NextEvictable(const FrameList &list, frame_id_t frame_id) const -> frame_id_t {
+  while (frame_id != FrameList::NONE && !frames_[frame_id].evictable_) {
+    frame_id = list.Prev(frame_id);
+  }
+  return frame_id;
+}
+
+auto ARCReplacer::PickVictims(size_t max_frames) const -> std::vector<frame_id_t> {
+  std::vector<frame_id_t> victims;
+  auto t1_size = t1_.Size();
+  auto t1_next = NextEvictable(t1_, t1_.Back());
+  auto t2_next = NextEvictable(t2_, t2_.Back());
+  while (victims.size() < max_frames && (t1_next != FrameList::NONE || t2_next != FrameList::NONE)) {
+    // fall back to the other list when the one whose turn it is has nothing evictable
+    if (t1_next != FrameList::NONE && (t1_size > target_ || t2_next == FrameList::NONE)) {
+      victims.push_back(t1_next);
+      t1_size--;
+      t1_next = NextEvictable(t1_, t1_.Prev(t1_next));
+    } else {
+      victims.push_back(t2_next);
+      t2_next = NextEvictable(t2_, t2_.Prev(t2_next));
+    }
+  }
+  return victims;
+}
+
+void ARCReplacer::TrimGhosts() {
+  while (b1_.Size() > 0 && t1_.Size() + b1_.Size() > num_frames_) {
+    b1_.PopBack();
+  }
+  while (t1_.Size() + t2_.Size() + b1_.Size() + b2_.Size() > 2 * num_frames_) {
+    if (b2_.Size() > 0) {
+      b2_.PopBack();
+    } else {
+      b1_.PopBack();
+    }
+  }
+}
+
+}  // namespace bustub
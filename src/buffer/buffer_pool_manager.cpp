@@ -11,184 +11,513 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager.h"
-#include <mutex>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 
 #include "common/config.h"
 #include "common/exception.h"
 #include "common/macros.h"
+#include "storage/disk/disk_manager_mmap.h"
 #include "storage/page/page_guard.h"
 
 namespace bustub {
 
+/** Starts every hot page file, see BufferPoolManager::SaveHotPages. */
+static constexpr char HOT_PAGE_MAGIC[8] = {'B', 'T', 'H', 'O', 'T', 'P', 'G', '1'};
+
 BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
-                                     LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
+                                     LogManager *log_manager, size_t num_instances, ReplacerPolicy replacer_policy,
+                                     HugePagePolicy huge_pages, size_t compressed_cache_size)
+    : pool_size_(pool_size),
+      page_size_(disk_manager->GetPageSize()),
+      disk_manager_(disk_manager),
+      mapped_disk_(dynamic_cast<DiskManagerMmap *>(disk_manager)),
+      frame_arena_(pool_size, page_size_, huge_pages),
+      disk_scheduler_(std::make_unique<DiskScheduler>(disk_manager)) {
+  BUSTUB_ENSURE(num_instances > 0 && num_instances <= pool_size, "every instance needs at least one frame");
+  if (compressed_cache_size > 0) {
+    compressed_cache_ = std::make_unique<CompressedPageCache>(compressed_cache_size, page_size_);
+  }
   // we allocate a consecutive memory space for the buffer pool
   pages_ = new Page[pool_size_];
-  // 给unique_ptr赋值的方法 数据类型+构造函数
-  replacer_ = std::make_unique<LRUKReplacer>(pool_size, replacer_k);
+  for (size_t i = 0; i < pool_size_; i++) {
+    pages_[i].data_ = frame_arena_.GetFrame(i);
+  }
 
-  // Initially, every page is in the free list.
-  for (size_t i = 0; i < pool_size_; ++i) {
-    free_list_.emplace_back(static_cast<int>(i));
+  // the first pool_size % num_instances instances take one extra frame
+  size_t offset = 0;
+  for (size_t i = 0; i < num_instances; i++) {
+    size_t instance_size = pool_size / num_instances + (i < pool_size % num_instances ? 1 : 0);
+    instances_.emplace_back(std::make_unique<BufferPoolManagerInstance>(
+        instance_size, pages_ + offset, num_instances, i, disk_manager, disk_scheduler_.get(), replacer_k, log_manager,
+        replacer_policy, compressed_cache_.get()));
+    offset += instance_size;
   }
+  prefetch_thread_ = std::thread(&BufferPoolManager::RunPrefetcher, this);
 }
 
-BufferPoolManager::~BufferPoolManager() { delete[] pages_; }
-
-auto BufferPoolManager::NewPage(page_id_t *page_id) -> Page * {
-  const std::lock_guard<std::mutex> guard(latch_);
-  int new_page_id = AllocatePage();
-  frame_id_t frame_id;
+BufferPoolManager::~BufferPoolManager() {
+  StopPageCleaner();
+  warm_up_stop_ = true;
+  WaitForWarmUp();
+  if (!hot_page_file_.empty()) {
+    SaveHotPages(hot_page_file_);
+  }
+  {
+    std::lock_guard<std::mutex> guard(prefetch_latch_);
+    prefetch_stop_ = true;
+  }
+  prefetch_cv_.notify_all();
+  prefetch_thread_.join();
+  instances_.clear();
+  delete[] pages_;
+}
 
-  if (!free_list_.empty()) {
-    // 空闲链表
-    frame_id = free_list_.back();
-    free_list_.pop_back();
-  } else {
-    // 2. 从replacer找
-    if (!replacer_->Evict(&frame_id)) {
-      return nullptr;
+auto BufferPoolManager::NewPage(page_id_t *page_id, tablespace_id_t tablespace) -> Page * {
+  EnsureWritable();
+  // try every instance once, starting from a different one each call
+  const size_t num_instances = instances_.size();
+  const size_t start = next_instance_.fetch_add(1, std::memory_order_relaxed);
+  for (size_t i = 0; i < num_instances; i++) {
+    auto page = instances_[(start + i) % num_instances]->NewPage(page_id, tablespace);
+    if (page != nullptr) {
+      return page;
     }
+  }
+  return nullptr;
+}
 
-    if (pages_[frame_id].IsDirty()) {
-      disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
-      pages_[frame_id].is_dirty_ = false;
-    }
-    page_table_.erase(pages_[frame_id].GetPageId());
+auto BufferPoolManager::FetchPage(page_id_t page_id, AccessType access_type) -> Page * {
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
   }
+  return GetInstance(page_id)->FetchPage(page_id, access_type);
+}
 
-  page_table_[new_page_id] = frame_id;
-  auto &current_page = pages_[frame_id];
-  // metadata
-  current_page.page_id_ = new_page_id;
-  current_page.ResetMemory();
-  current_page.is_dirty_ = false;
-  current_page.pin_count_ = 1;
+auto BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type) -> bool {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  return GetInstance(page_id)->UnpinPage(page_id, is_dirty, access_type);
+}
 
-  replacer_->RecordAccess(frame_id);
-  replacer_->SetEvictable(frame_id, false);
-  *page_id = new_page_id;
-  return &current_page;
+auto BufferPoolManager::FlushPage(page_id_t page_id) -> bool {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  return GetInstance(page_id)->FlushPage(page_id);
 }
 
-auto BufferPoolManager::FetchPage(page_id_t page_id, [[maybe_unused]] AccessType access_type) -> Page * {
-  // 先从读出来的页找，再从空闲链表找，再从替换器找
-  frame_id_t frame_id;
-  if (page_table_.find(page_id) != page_table_.end()) {
-    frame_id = page_table_[page_id];
-    pages_[frame_id].pin_count_++;
-    replacer_->RecordAccess(frame_id);
-    replacer_->SetEvictable(frame_id, false);
-    return &pages_[frame_id];
+void BufferPoolManager::FlushAllPages() {
+  // Consecutive page ids live in different instances, so collect the dirty pages of all of them before writing. No
+  // instance stays latched meanwhile; its frames of the pages are held until they are on disk.
+  std::vector<DiskManager::PageWrite> pages;
+  std::vector<std::vector<frame_id_t>> frames;
+  for (auto &instance : instances_) {
+    frames.push_back(instance->CollectDirtyPages(&pages));
   }
-  if (!free_list_.empty()) {
-    frame_id = free_list_.back();
-    free_list_.pop_back();
-  } else {
-    if (!replacer_->Evict(&frame_id)) {
-      return nullptr;
-    }
-    if (pages_[frame_id].IsDirty()) {
-      disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
-      pages_[frame_id].is_dirty_ = false;
-    }
-    page_table_.erase(pages_[frame_id].GetPageId());
+  disk_manager_->WritePages(std::move(pages));
+  for (size_t i = 0; i < instances_.size(); i++) {
+    instances_[i]->FinishDirtyPages(frames[i]);
   }
-  page_table_[page_id] = frame_id;
-  pages_[frame_id].page_id_ = page_id;
-  pages_[frame_id].is_dirty_ = false;
-  pages_[frame_id].pin_count_ = 1;
-  disk_manager_->ReadPage(page_id, pages_[frame_id].data_);
-  replacer_->RecordAccess(frame_id);
-  replacer_->SetEvictable(frame_id, false);
-  return &pages_[frame_id];
 }
 
-auto BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, [[maybe_unused]] AccessType access_type) -> bool {
-  const std::lock_guard<std::mutex> guard(latch_);
+auto BufferPoolManager::DeletePage(page_id_t page_id) -> bool {
+  EnsureWritable();
   if (page_id == INVALID_PAGE_ID) {
+    return true;
+  }
+  return GetInstance(page_id)->DeletePage(page_id);
+}
+
+auto BufferPoolManager::CreateTablespace() -> tablespace_id_t {
+  EnsureWritable();
+  return disk_manager_->CreateTablespace();
+}
+
+auto BufferPoolManager::DropTablespace(tablespace_id_t tablespace) -> bool {
+  EnsureWritable();
+  if (tablespace == DEFAULT_TABLESPACE || !disk_manager_->HasTablespace(tablespace)) {
+    // the cached pages of a tablespace that is not there may be pages of another one, dirty ones too
     return false;
   }
-  if (page_table_.find(page_id) == page_table_.end()) {
+  if (HasPinnedPages(tablespace)) {
     return false;
   }
-  auto frame_id = page_table_[page_id];
-  pages_[frame_id].is_dirty_ |= is_dirty;
-  if (pages_[frame_id].pin_count_ > 0) {
-    pages_[frame_id].pin_count_--;
-    if (pages_[frame_id].pin_count_ == 0) {
-      replacer_->SetEvictable(frame_id, true);
+  for (auto &instance : instances_) {
+    instance->DiscardPages(tablespace);
+  }
+  if (compressed_cache_ != nullptr) {
+    compressed_cache_->EraseIf(
+        [tablespace](page_id_t page_id) { return DiskManager::TablespaceOf(page_id) == tablespace; });
+  }
+  return disk_manager_->DropTablespace(tablespace);
+}
+
+auto BufferPoolManager::HasPinnedPages(tablespace_id_t tablespace) -> bool {
+  for (auto &instance : instances_) {
+    if (instance->HasPinnedPages(tablespace)) {
+      return true;
     }
-    return true;
   }
   return false;
 }
 
-auto BufferPoolManager::FlushPage(page_id_t page_id) -> bool {
-  const std::lock_guard<std::mutex> guard(latch_);
-  if (page_id == INVALID_PAGE_ID) {
-    return false;
+void BufferPoolManager::StartPageCleaner(double low_watermark, double high_watermark) {
+  BUSTUB_ENSURE(0 <= low_watermark && low_watermark <= high_watermark && high_watermark <= 1,
+                "page cleaner watermarks must satisfy 0 <= low <= high <= 1");
+  BUSTUB_ENSURE(!page_cleaner_thread_.joinable(), "the page cleaner is already running");
+  page_cleaner_stop_ = false;
+  page_cleaner_thread_ = std::thread(&BufferPoolManager::RunPageCleaner, this, low_watermark, high_watermark);
+}
+
+void BufferPoolManager::StopPageCleaner() {
+  if (!page_cleaner_thread_.joinable()) {
+    return;
   }
-  if (page_table_.find(page_id) == page_table_.end()) {
-    return false;
+  {
+    std::lock_guard<std::mutex> guard(page_cleaner_latch_);
+    page_cleaner_stop_ = true;
   }
-  auto frame_id = page_table_[page_id];
-  disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
-  pages_[frame_id].is_dirty_ = false;
-  return true;
+  page_cleaner_cv_.notify_all();
+  page_cleaner_thread_.join();
 }
 
-void BufferPoolManager::FlushAllPages() {
-  const std::lock_guard<std::mutex> guard(latch_);
-  for (size_t i = 0; i < pool_size_; ++i) {
-    if (pages_[i].is_dirty_ && pages_[i].page_id_ != INVALID_PAGE_ID) {
-      disk_manager_->WritePage(pages_[i].GetPageId(), pages_[i].GetData());
-      pages_[i].is_dirty_ = false;
+void BufferPoolManager::RunPageCleaner(double low_watermark, double high_watermark) {
+  std::unique_lock<std::mutex> lock(page_cleaner_latch_);
+  while (!page_cleaner_stop_) {
+    lock.unlock();
+    size_t written = 0;
+    for (auto &instance : instances_) {
+      auto frames = static_cast<double>(instance->GetPoolSize());
+      written += instance->CleanFrames(static_cast<size_t>(low_watermark * frames),
+                                       static_cast<size_t>(high_watermark * frames));
+    }
+    lock.lock();
+    // keep going while there is work, otherwise sleep until the next round
+    if (written == 0) {
+      page_cleaner_cv_.wait_for(lock, page_cleaner_interval, [this] { return page_cleaner_stop_; });
     }
   }
 }
 
-auto BufferPoolManager::DeletePage(page_id_t page_id) -> bool {
-  const std::lock_guard<std::mutex> guard(latch_);
-  if (page_table_.find(page_id) == page_table_.end()) {
-    return true;
+void BufferPoolManager::Resize(size_t pool_size) {
+  const size_t num_instances = instances_.size();
+  BUSTUB_ENSURE(pool_size >= num_instances, "every instance needs at least one frame");
+  std::lock_guard<std::mutex> guard(resize_latch_);
+
+  // set up every frame we need before touching any instance, so that no instance latch is held while mapping memory
+  std::vector<size_t> instance_sizes;
+  size_t new_frames = 0;
+  for (size_t i = 0; i < num_instances; i++) {
+    size_t instance_size = pool_size / num_instances + (i < pool_size % num_instances ? 1 : 0);
+    instance_sizes.push_back(instance_size);
+    new_frames += instance_size - std::min(instance_size, instances_[i]->GetCapacity());
   }
-  auto frame_id = page_table_[page_id];
-  if (pages_[frame_id].pin_count_ != 0) {
-    return false;
+  Page *pages = nullptr;
+  if (new_frames > 0) {
+    auto arena = std::make_unique<FrameArena>(new_frames, page_size_, frame_arena_.GetHugePagePolicy());
+    auto new_pages = std::make_unique<Page[]>(new_frames);
+    for (size_t i = 0; i < new_frames; i++) {
+      new_pages[i].data_ = arena->GetFrame(i);
+    }
+    pages = new_pages.get();
+    resize_arenas_.push_back(std::move(arena));
+    resize_pages_.push_back(std::move(new_pages));
   }
-  if (pages_[frame_id].IsDirty()) {
-    disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
-    pages_[frame_id].is_dirty_ = false;
+
+  for (size_t i = 0; i < num_instances; i++) {
+    auto capacity = instances_[i]->GetCapacity();
+    instances_[i]->Resize(instance_sizes[i], pages);
+    if (instance_sizes[i] > capacity) {
+      pages += instance_sizes[i] - capacity;
+    }
   }
-  pages_[frame_id].ResetMemory();
-  pages_[frame_id].is_dirty_ = false;
-  pages_[frame_id].pin_count_ = 0;
-  pages_[frame_id].page_id_ = INVALID_PAGE_ID;
-  page_table_.erase(page_id);
-  replacer_->Remove(frame_id);
-  free_list_.push_back(frame_id);
-  DeallocatePage(page_id);
-  return true;
+  pool_size_.store(pool_size, std::memory_order_release);
 }
 
-auto BufferPoolManager::AllocatePage() -> page_id_t { return next_page_id_++; }
+void BufferPoolManager::SetReplacerPolicy(ReplacerPolicy policy) {
+  std::lock_guard<std::mutex> guard(resize_latch_);
+  for (auto &instance : instances_) {
+    instance->SetReplacerPolicy(policy);
+  }
+}
 
-auto BufferPoolManager::FetchPageBasic(page_id_t page_id) -> BasicPageGuard { return {this, FetchPage(page_id)}; }
+auto BufferPoolManager::GetStats() -> BufferPoolStats {
+  BufferPoolStats stats;
+  for (auto &instance : instances_) {
+    stats += instance->GetStats();
+  }
+  if (compressed_cache_ != nullptr) {
+    compressed_cache_->AddStats(&stats);
+  }
+  return stats;
+}
 
-auto BufferPoolManager::FetchPageRead(page_id_t page_id) -> ReadPageGuard {
-  auto page = FetchPage(page_id);
+void BufferPoolManager::Prefetch(std::vector<page_id_t> page_ids) {
+  if (mapped_disk_ != nullptr) {
+    // reads of a mapped file do not go through frames
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> guard(prefetch_latch_);
+    for (auto page_id : page_ids) {
+      if (page_id != INVALID_PAGE_ID && prefetch_queue_.size() < pool_size_) {
+        prefetch_queue_.push_back({page_id, 1, nullptr});
+      }
+    }
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManager::PrefetchChain(page_id_t page_id, size_t num_pages, NextPageIdFn next_page_id) {
+  if (mapped_disk_ != nullptr) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> guard(prefetch_latch_);
+    if (page_id == INVALID_PAGE_ID || num_pages == 0 || prefetch_queue_.size() >= pool_size_) {
+      return;
+    }
+    prefetch_queue_.push_back({page_id, num_pages, std::move(next_page_id)});
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManager::RunPrefetcher() {
+  std::unique_lock<std::mutex> lock(prefetch_latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [this] { return prefetch_stop_ || !prefetch_queue_.empty(); });
+    if (prefetch_stop_) {
+      return;
+    }
+    auto request = std::move(prefetch_queue_.front());
+    prefetch_queue_.pop_front();
+    if (request.num_pages_ == 1) {
+      // take the single pages queued behind it too, and read them all at once
+      std::vector<page_id_t> page_ids{request.page_id_};
+      while (!prefetch_queue_.empty() && prefetch_queue_.front().num_pages_ == 1 &&
+             page_ids.size() < DISK_SCHEDULER_BATCH) {
+        page_ids.push_back(prefetch_queue_.front().page_id_);
+        prefetch_queue_.pop_front();
+      }
+      lock.unlock();
+      PrefetchPages(page_ids);
+      lock.lock();
+      continue;
+    }
+    lock.unlock();
+
+    auto page_id = request.page_id_;
+    for (size_t i = 0; i < request.num_pages_ && page_id != INVALID_PAGE_ID; i++) {
+      GetInstance(page_id)->PrefetchPage(page_id);
+      if (i + 1 == request.num_pages_) {
+        break;
+      }
+      // the page is normally cached by now; looking at it is not a use
+      Page *page = nullptr;
+      try {
+        page = FetchPage(page_id, AccessType::Prefetch);
+      } catch (...) {
+        // the chain ends at a page that cannot be read, and a fetch of the page gets the error
+      }
+      if (page == nullptr) {
+        break;
+      }
+      page->RLatch();
+      auto next_page_id = request.next_page_id_(page->GetData());
+      page->RUnlatch();
+      UnpinPage(page_id, false, AccessType::Prefetch);
+      page_id = next_page_id;
+    }
+    lock.lock();
+  }
+}
+
+void BufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids) {
+  struct PendingRead {
+    BufferPoolManagerInstance *instance_;
+    frame_id_t frame_id_;
+    std::future<bool> read_;
+  };
+  std::vector<PendingRead> reads;
+  for (auto page_id : page_ids) {
+    auto *instance = GetInstance(page_id);
+    frame_id_t frame_id;
+    auto read = instance->StartPrefetch(page_id, &frame_id);
+    if (read.valid()) {
+      reads.push_back({instance, frame_id, std::move(read)});
+    }
+  }
+  for (auto &read : reads) {
+    try {
+      read.read_.get();
+    } catch (...) {
+      // a prefetch is only a hint; a fetch of the page gets the error
+      read.instance_->AbortLoad(read.frame_id_);
+      continue;
+    }
+    read.instance_->EndPrefetch(read.frame_id_);
+  }
+}
+
+void BufferPoolManager::EnableWarmRestart(const std::string &hot_page_file) {
+  std::lock_guard<std::mutex> guard(warm_up_latch_);
+  BUSTUB_ENSURE(!warm_up_thread_.joinable(), "warm restart is already enabled");
+  hot_page_file_ = hot_page_file;
+  warm_up_thread_ = std::thread([this, hot_page_file] { LoadHotPages(hot_page_file); });
+}
+
+void BufferPoolManager::WaitForWarmUp() {
+  std::lock_guard<std::mutex> guard(warm_up_latch_);
+  if (warm_up_thread_.joinable()) {
+    warm_up_thread_.join();
+  }
+}
+
+auto BufferPoolManager::SaveHotPages(const std::string &hot_page_file) -> bool {
+  // interleave the instances by rank, so that a smaller pool later reads the hottest pages of every instance
+  std::vector<std::vector<page_id_t>> resident;
+  size_t max_pages = 0;
+  for (auto &instance : instances_) {
+    resident.push_back(instance->GetResidentPages());
+    max_pages = std::max(max_pages, resident.back().size());
+  }
+  std::vector<page_id_t> page_ids;
+  for (size_t rank = 0; rank < max_pages; rank++) {
+    for (auto &pages : resident) {
+      if (rank < pages.size()) {
+        page_ids.push_back(pages[rank]);
+      }
+    }
+  }
+
+  // write a new file and move it over the old one, so that a crash never leaves half a list behind
+  auto tmp_file = hot_page_file + ".tmp";
+  {
+    std::ofstream out(tmp_file, std::ios::binary | std::ios::trunc);
+    uint64_t count = page_ids.size();
+    out.write(HOT_PAGE_MAGIC, sizeof(HOT_PAGE_MAGIC));
+    out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    out.write(reinterpret_cast<const char *>(page_ids.data()),
+              static_cast<std::streamsize>(page_ids.size() * sizeof(page_id_t)));
+    if (!out.good()) {
+      return false;
+    }
+  }
+  return std::rename(tmp_file.c_str(), hot_page_file.c_str()) == 0;
+}
+
+auto BufferPoolManager::LoadHotPages(const std::string &hot_page_file) -> size_t {
+  std::ifstream in(hot_page_file, std::ios::binary);
+  char magic[sizeof(HOT_PAGE_MAGIC)];
+  uint64_t count = 0;
+  in.read(magic, sizeof(magic));
+  in.read(reinterpret_cast<char *>(&count), sizeof(count));
+  if (!in.good() || memcmp(magic, HOT_PAGE_MAGIC, sizeof(magic)) != 0) {
+    return 0;
+  }
+  // only the hottest pages that fit are worth reading
+  std::vector<page_id_t> page_ids(std::min<uint64_t>(count, GetPoolSize()));
+  in.read(reinterpret_cast<char *>(page_ids.data()), static_cast<std::streamsize>(page_ids.size() * sizeof(page_id_t)));
+  if (!in.good()) {
+    return 0;
+  }
+  std::sort(page_ids.begin(), page_ids.end());
+  page_ids.erase(std::unique(page_ids.begin(), page_ids.end()), page_ids.end());
+
+  size_t loaded = 0;
+  std::vector<DiskManager::PageRead> reads;
+  std::vector<std::pair<BufferPoolManagerInstance *, frame_id_t>> frames;
+  for (size_t begin = 0; begin < page_ids.size() && !warm_up_stop_; begin += WARM_UP_READ_PAGES) {
+    auto end = std::min(begin + WARM_UP_READ_PAGES, page_ids.size());
+    for (auto i = begin; i < end; i++) {
+      if (page_ids[i] < 0) {
+        continue;
+      }
+      auto *instance = GetInstance(page_ids[i]);
+      frame_id_t frame_id;
+      // pages fetched since startup are skipped, and so are pages without a free frame
+      auto *page = instance->BeginPrefetch(page_ids[i], false, &frame_id);
+      if (page != nullptr) {
+        reads.emplace_back(page_ids[i], page->GetData());
+        frames.emplace_back(instance, frame_id);
+      }
+    }
+    bool read = true;
+    try {
+      disk_manager_->ReadPages(std::move(reads));
+    } catch (...) {
+      // e.g. a page of a tablespace dropped since the list was saved; the pages are not worth reading one by one
+      read = false;
+    }
+    for (auto [instance, frame_id] : frames) {
+      if (read) {
+        instance->EndPrefetch(frame_id);
+      } else {
+        instance->AbortLoad(frame_id);
+      }
+    }
+    loaded += read ? frames.size() : 0;
+    reads.clear();
+    frames.clear();
+  }
+  return loaded;
+}
+
+void BufferPoolManager::EnsureWritable() const {
+  if (disk_manager_->IsReadOnly()) {
+    throw Exception("the buffer pool is read-only");
+  }
+}
+
+auto BufferPoolManager::FetchPageBasic(page_id_t page_id, AccessType access_type) -> BasicPageGuard {
+  return {this, FetchPage(page_id, access_type)};
+}
+
+auto BufferPoolManager::FetchPageRead(page_id_t page_id, AccessType access_type) -> ReadPageGuard {
+  if (mapped_disk_ != nullptr && page_id != INVALID_PAGE_ID) {
+    // straight into the mapping; a page past the end of the file reads as zeros through a frame
+    if (const auto *data = mapped_disk_->GetMappedPage(page_id, access_type == AccessType::Scan); data != nullptr) {
+      return {page_id, data};
+    }
+  }
+  auto page = FetchPage(page_id, access_type);
+  if (page == nullptr) {
+    return {};
+  }
   page->RLatch();
   return {this, page};
 }
 
-auto BufferPoolManager::FetchPageWrite(page_id_t page_id) -> WritePageGuard {
-  auto page = FetchPage(page_id);
+auto BufferPoolManager::FetchPageWrite(page_id_t page_id, AccessType access_type) -> WritePageGuard {
+  EnsureWritable();
+  auto page = FetchPage(page_id, access_type);
+  if (page == nullptr) {
+    return {};
+  }
   page->WLatch();
   return {this, page};
 }
 
-auto BufferPoolManager::NewPageGuarded(page_id_t *page_id) -> BasicPageGuard { return {this, NewPage(page_id)}; }
+auto BufferPoolManager::FetchPageOptimistic(page_id_t page_id, AccessType access_type) -> OptimisticPageGuard {
+  if (mapped_disk_ != nullptr && page_id != INVALID_PAGE_ID) {
+    if (const auto *data = mapped_disk_->GetMappedPage(page_id, access_type == AccessType::Scan); data != nullptr) {
+      return {page_id, data};
+    }
+  }
+  auto page = FetchPage(page_id, access_type);
+  if (page == nullptr) {
+    return {};
+  }
+  return {this, page};
+}
+
+auto BufferPoolManager::NewPageGuarded(page_id_t *page_id, tablespace_id_t tablespace) -> BasicPageGuard {
+  return {this, NewPage(page_id, tablespace)};
+}
 
 }  // namespace bustub
@@ -0,0 +1,810 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_instance.cpp
+//
+// Identification: src/buffer/buffer_pool_manager_instance.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include <mutex>
+
+#include <algorithm>
+
+#include "buffer/frame_arena.h"
+#include "common/config.h"
+#include "common/exception.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, Page *pages, uint32_t num_instances,
+                                                     uint32_t instance_index, DiskManager *disk_manager,
+                                                     DiskScheduler *disk_scheduler, size_t replacer_k,
+                                                     LogManager *log_manager,
+                                                     ReplacerPolicy replacer_policy,
+                                                     CompressedPageCache *compressed_cache)
+    : pool_size_(pool_size),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      disk_manager_(disk_manager),
+      disk_scheduler_(disk_scheduler),
+      log_manager_(log_manager),
+      compressed_cache_(compressed_cache),
+      page_table_(2 * pool_size),
+      replacer_owner_(MakeReplacer(replacer_policy, pool_size, replacer_k)),
+      replacer_(replacer_owner_.get()),
+      replacer_policy_(replacer_policy),
+      replacer_k_(replacer_k),
+      replacer_size_(pool_size),
+      frames_(pool_size) {
+  BUSTUB_ASSERT(num_instances > 0, "a buffer pool has at least one instance");
+  BUSTUB_ASSERT(instance_index < num_instances, "instance index out of range");
+
+  // Initially, every page is in the free list.
+  for (size_t i = 0; i < pool_size; ++i) {
+    frames_[i].page_ = &pages[i];
+    free_list_.emplace_back(static_cast<int>(i));
+  }
+}
+
+auto BufferPoolManagerInstance::LookupFrame(page_id_t page_id, std::unique_lock<std::mutex> &lock,
+                                            frame_id_t *frame_id) -> bool {
+  while (true) {
+    frame_id_t found;
+    if (!page_table_.Find(page_id, &found)) {
+      return false;
+    }
+    if (frames_[found].io_ == FrameIoState::Idle) {
+      *frame_id = found;
+      return true;
+    }
+    // the page is being read in, or the frame is still writing back its previous page; look again afterwards
+    frames_[found].io_cv_.wait(lock);
+  }
+}
+
+auto BufferPoolManagerInstance::AcquireFrame(std::unique_lock<std::mutex> &lock, page_id_t page_id,
+                                             frame_id_t *frame_id) -> bool {
+  bool spill = false;
+  bool write_back = false;
+  while (true) {
+    if (!free_list_.empty()) {
+      *frame_id = free_list_.back();
+      free_list_.pop_back();
+      break;
+    }
+    if (!GetReplacer()->Evict(frame_id)) {
+      return false;
+    }
+    std::lock_guard<std::mutex> frame_guard(frames_[*frame_id].latch_);
+    auto &victim = *frames_[*frame_id].page_;
+    if (victim.pin_count_ > 0) {
+      // FetchPage pinned the page without the instance latch after the replacer picked it. The fetch may have recorded
+      // its access before the replacer dropped the frame, so track the frame again, pinned, or it is never evicted.
+      auto *replacer = GetReplacer();
+      replacer->SetPage(*frame_id, victim.page_id_);
+      replacer->RecordAccess(*frame_id);
+      replacer->SetEvictable(*frame_id, false);
+      continue;
+    }
+    // the page may have been pinned and unpinned again since, which made the frame evictable once more
+    GetReplacer()->Remove(*frame_id);
+    if (victim.page_id_ != INVALID_PAGE_ID && (victim.is_dirty_ || compressed_cache_ != nullptr)) {
+      // the victim stays in the page table until it is on disk and in the compressed cache, so nobody reads a stale
+      // copy or misses the cached one in the meantime
+      write_back = victim.is_dirty_;
+      victim.is_dirty_ = false;
+      frames_[*frame_id].io_ = FrameIoState::Writing;
+      spill = true;
+      stats_.RecordEviction();
+    } else if (victim.page_id_ != INVALID_PAGE_ID) {
+      stats_.RecordEviction();
+      page_table_.Erase(victim.page_id_);
+      victim.page_id_ = INVALID_PAGE_ID;
+    }
+    break;
+  }
+  // nobody holds a guard on the frame; a version left odd would fail every optimistic read of the next page
+  frames_[*frame_id].page_->AlignVersion();
+  if (page_id != INVALID_PAGE_ID) {
+    page_table_.Insert(page_id, *frame_id);
+  }
+  if (!spill) {
+    return true;
+  }
+
+  auto &victim = *frames_[*frame_id].page_;
+  lock.unlock();
+  if (write_back) {
+    disk_manager_->WritePage(victim.GetPageId(), victim.GetData());
+  }
+  if (compressed_cache_ != nullptr) {
+    compressed_cache_->Put(victim.GetPageId(), victim.GetData());
+  }
+  LockLatch(lock);
+  if (write_back) {
+    stats_.RecordForegroundWriteBack();
+  }
+  {
+    std::lock_guard<std::mutex> frame_guard(frames_[*frame_id].latch_);
+    page_table_.Erase(victim.page_id_);
+    victim.page_id_ = INVALID_PAGE_ID;
+  }
+  FinishFrameIo(*frame_id);
+  return true;
+}
+
+auto BufferPoolManagerInstance::LockLatch() -> std::unique_lock<std::mutex> {
+  std::unique_lock<std::mutex> lock(latch_, std::defer_lock);
+  LockLatch(lock);
+  return lock;
+}
+
+void BufferPoolManagerInstance::LockLatch(std::unique_lock<std::mutex> &lock) {
+  // only read the clock when we actually have to wait
+  if (lock.try_lock()) {
+    return;
+  }
+  auto start = std::chrono::steady_clock::now();
+  lock.lock();
+  stats_.RecordLatchWait(std::chrono::steady_clock::now() - start);
+}
+
+void BufferPoolManagerInstance::FinishFrameIo(frame_id_t frame_id) {
+  auto &frame = frames_[frame_id];
+  {
+    std::lock_guard<std::mutex> frame_guard(frame.latch_);
+    frame.io_ = FrameIoState::Idle;
+  }
+  frame.io_cv_.notify_all();
+}
+
+void BufferPoolManagerInstance::RetireFrames(std::unique_lock<std::mutex> &lock) {
+  std::vector<frame_id_t> frames;
+  std::vector<DiskManager::PageWrite> pages;
+  for (auto frame_id : retiring_) {
+    auto &frame = frames_[frame_id];
+    auto &page = *frame.page_;
+    std::lock_guard<std::mutex> frame_guard(frame.latch_);
+    if (page.pin_count_ > 0 || frame.io_ != FrameIoState::Idle) {
+      continue;
+    }
+    // the frame was left non-evictable when it was unpinned, or is still evictable from before the shrink
+    auto *replacer = GetReplacer();
+    replacer->SetEvictable(frame_id, true);
+    replacer->Remove(frame_id);
+    if (page.page_id_ != INVALID_PAGE_ID && page.is_dirty_) {
+      // like a write-back during eviction, the page stays in the page table until it is on disk
+      page.is_dirty_ = false;
+      frame.io_ = FrameIoState::Writing;
+      frames.push_back(frame_id);
+      pages.emplace_back(page.page_id_, page.data_);
+    } else {
+      ReleaseFrame(frame_id);
+    }
+  }
+
+  if (!frames.empty()) {
+    lock.unlock();
+    disk_manager_->WritePages(std::move(pages), false);
+    LockLatch(lock);
+    for (auto frame_id : frames) {
+      auto &frame = frames_[frame_id];
+      {
+        std::lock_guard<std::mutex> frame_guard(frame.latch_);
+        if (static_cast<size_t>(frame_id) < pool_size_.load(std::memory_order_relaxed)) {
+          // the pool grew back while we were writing; the frame is clean now and goes to the free list instead
+          stats_.RecordEviction();
+          page_table_.Erase(frame.page_->page_id_);
+          frame.page_->page_id_ = INVALID_PAGE_ID;
+          free_list_.push_back(frame_id);
+        } else {
+          ReleaseFrame(frame_id);
+        }
+      }
+      FinishFrameIo(frame_id);
+    }
+    stats_.RecordBackgroundWriteBacks(frames.size());
+  }
+  UpdateRetiringFrames();
+}
+
+void BufferPoolManagerInstance::ReleaseFrame(frame_id_t frame_id) {
+  auto &frame = frames_[frame_id];
+  auto &page = *frame.page_;
+  if (page.page_id_ != INVALID_PAGE_ID) {
+    stats_.RecordEviction();
+    page_table_.Erase(page.page_id_);
+    page.page_id_ = INVALID_PAGE_ID;
+  }
+  page.is_dirty_ = false;
+  FrameArena::Discard(page.data_, disk_manager_->GetPageSize());
+  frame.retired_ = true;
+}
+
+void BufferPoolManagerInstance::UpdateRetiringFrames() {
+  auto pool_size = pool_size_.load(std::memory_order_relaxed);
+  retiring_.erase(std::remove_if(retiring_.begin(), retiring_.end(),
+                                 [&](frame_id_t frame_id) {
+                                   return frames_[frame_id].retired_ || static_cast<size_t>(frame_id) < pool_size;
+                                 }),
+                  retiring_.end());
+  // the replacer has to cover every frame that may still be tracked
+  size_t replacer_size = pool_size;
+  for (auto frame_id : retiring_) {
+    replacer_size = std::max(replacer_size, static_cast<size_t>(frame_id) + 1);
+  }
+  if (replacer_size != replacer_size_) {
+    GetReplacer()->Resize(replacer_size);
+    replacer_size_ = replacer_size;
+  }
+}
+
+void BufferPoolManagerInstance::Resize(size_t pool_size, Page *pages) {
+  BUSTUB_ASSERT(pool_size > 0, "an instance needs at least one frame");
+  auto lock = LockLatch();
+  auto old_pool_size = pool_size_.load(std::memory_order_relaxed);
+  auto capacity = frames_.Size();
+  if (pool_size > capacity) {
+    page_table_.Grow(2 * pool_size);
+    frames_.Grow(pool_size);
+    for (auto i = capacity; i < pool_size; i++) {
+      // nobody can reach the new frames before they are in the free list
+      frames_[i].page_ = &pages[i - capacity];
+      frames_[i].retired_ = true;
+    }
+  }
+  // Publish the size before looking at the frames. An unpin that still saw the old size has already made its frame
+  // evictable or not by the time we take the frame latch below.
+  pool_size_.store(pool_size, std::memory_order_release);
+
+  if (pool_size >= old_pool_size) {
+    UpdateRetiringFrames();
+    for (auto i = old_pool_size; i < pool_size; i++) {
+      auto &frame = frames_[i];
+      std::lock_guard<std::mutex> frame_guard(frame.latch_);
+      if (frame.retired_) {
+        frame.retired_ = false;
+        free_list_.push_back(static_cast<frame_id_t>(i));
+      } else if (frame.page_->pin_count_ == 0 && frame.io_ == FrameIoState::Idle) {
+        // an unpinned frame that had not been retired yet becomes a candidate for eviction again
+        GetReplacer()->SetEvictable(static_cast<frame_id_t>(i), true);
+      }
+    }
+    return;
+  }
+
+  for (auto it = free_list_.begin(); it != free_list_.end();) {
+    if (static_cast<size_t>(*it) < pool_size) {
+      ++it;
+      continue;
+    }
+    std::lock_guard<std::mutex> frame_guard(frames_[*it].latch_);
+    ReleaseFrame(*it);
+    it = free_list_.erase(it);
+  }
+  for (auto i = pool_size; i < old_pool_size; i++) {
+    if (!frames_[i].retired_) {
+      retiring_.push_back(static_cast<frame_id_t>(i));
+    }
+  }
+  RetireFrames(lock);
+}
+
+auto BufferPoolManagerInstance::GetNumRetiringFrames() -> size_t {
+  auto lock = LockLatch();
+  return retiring_.size();
+}
+
+void BufferPoolManagerInstance::SetReplacerPolicy(ReplacerPolicy policy) {
+  auto lock = LockLatch();
+  if (policy == replacer_policy_) {
+    return;
+  }
+  auto old_replacer = std::move(replacer_owner_);
+  auto capacity = frames_.Size();
+  // Visit the evictable frames coldest first, then the pinned ones, so that the new replacer starts out with roughly
+  // the recency order of the old one.
+  auto order = old_replacer->EvictionCandidates(capacity);
+  std::vector<bool> listed(capacity, false);
+  for (auto frame_id : order) {
+    listed[frame_id] = true;
+  }
+  for (size_t i = 0; i < capacity; i++) {
+    if (!listed[i]) {
+      order.push_back(static_cast<frame_id_t>(i));
+    }
+  }
+
+  replacer_owner_ = MakeReplacer(policy, replacer_size_, replacer_k_);
+  replacer_.store(replacer_owner_.get(), std::memory_order_release);
+  replacer_policy_ = policy;
+  // From here on, everyone holding the instance latch uses the new replacer. A hit path that loaded the old one is
+  // done with it once we got hold of its frame latch, so the old replacer can go after every frame was visited.
+  for (auto frame_id : order) {
+    auto &frame = frames_[frame_id];
+    // a frame with I/O in flight is registered by whoever finishes the I/O, or left out because it is being evicted
+    frame.io_cv_.wait(lock, [&] { return frame.io_ == FrameIoState::Idle; });
+    std::lock_guard<std::mutex> frame_guard(frame.latch_);
+    auto &page = *frame.page_;
+    if (page.page_id_ == INVALID_PAGE_ID) {
+      continue;
+    }
+    auto *replacer = GetReplacer();
+    replacer->SetPage(frame_id, page.page_id_);
+    replacer->RecordAccess(frame_id);
+    if (page.pin_count_ == 0 && static_cast<size_t>(frame_id) < pool_size_.load(std::memory_order_relaxed)) {
+      replacer->SetEvictable(frame_id, true);
+    }
+  }
+}
+
+auto BufferPoolManagerInstance::GetReplacerPolicy() -> ReplacerPolicy {
+  auto lock = LockLatch();
+  return replacer_policy_;
+}
+
+auto BufferPoolManagerInstance::NewPage(page_id_t *page_id, tablespace_id_t tablespace) -> Page * {
+  auto lock = LockLatch();
+  if (!retiring_.empty()) {
+    RetireFrames(lock);
+  }
+  frame_id_t frame_id;
+  if (!AcquireFrame(lock, INVALID_PAGE_ID, &frame_id)) {
+    return nullptr;
+  }
+
+  // only hand out a page id once we know there is a frame for it
+  bool reused;
+  page_id_t new_page_id = AllocatePage(&reused, tablespace);
+  frame_id_t stale_frame_id;
+  if (LookupFrame(new_page_id, lock, &stale_frame_id)) {
+    // a prefetch or the warm-up read an old copy of the page before its id was handed out again
+    std::unique_lock<std::mutex> stale_guard(frames_[stale_frame_id].latch_);
+    DropPage(stale_frame_id, stale_guard);
+  }
+  if (compressed_cache_ != nullptr) {
+    compressed_cache_->Erase(new_page_id);
+  }
+  stats_.RecordNewPage();
+  page_table_.Insert(new_page_id, frame_id);
+  auto &current_page = *frames_[frame_id].page_;
+  current_page.ResetMemory(disk_manager_->GetPageSize());
+  // metadata
+  std::lock_guard<std::mutex> frame_guard(frames_[frame_id].latch_);
+  current_page.page_id_ = new_page_id;
+  // a freed page still has its old data on disk, which a fetch after an eviction must not see
+  current_page.is_dirty_ = reused;
+  current_page.pin_count_ = 1;
+
+  auto *replacer = GetReplacer();
+  replacer->SetPage(frame_id, new_page_id);
+  replacer->RecordAccess(frame_id);
+  replacer->SetEvictable(frame_id, false);
+  *page_id = new_page_id;
+  return &current_page;
+}
+
+auto BufferPoolManagerInstance::FetchPage(page_id_t page_id, AccessType access_type) -> Page * {
+  // fast path: the page is cached and idle, pin it under its frame latch alone
+  frame_id_t frame_id;
+  if (page_table_.Find(page_id, &frame_id)) {
+    auto &frame = frames_[frame_id];
+    std::lock_guard<std::mutex> frame_guard(frame.latch_);
+    // the frame may have moved on to another page since we looked it up
+    if (frame.page_->page_id_ == page_id && frame.io_ == FrameIoState::Idle) {
+      frame.page_->pin_count_++;
+      // only load the replacer under the frame latch, see SetReplacerPolicy
+      auto *replacer = GetReplacer();
+      replacer->RecordAccess(frame_id, access_type);
+      replacer->SetEvictable(frame_id, false);
+      stats_.RecordHit(access_type);
+      stats_.RecordPinCount(frame.page_->pin_count_);
+      return frame.page_;
+    }
+  }
+
+  auto lock = LockLatch();
+  if (!retiring_.empty()) {
+    RetireFrames(lock);
+  }
+  // 先从读出来的页找，再从空闲链表找，再从替换器找
+  if (LookupFrame(page_id, lock, &frame_id)) {
+    auto &frame = frames_[frame_id];
+    std::lock_guard<std::mutex> frame_guard(frame.latch_);
+    frame.page_->pin_count_++;
+    auto *replacer = GetReplacer();
+    replacer->RecordAccess(frame_id, access_type);
+    replacer->SetEvictable(frame_id, false);
+    stats_.RecordHit(access_type);
+    stats_.RecordPinCount(frame.page_->pin_count_);
+    return frame.page_;
+  }
+  if (!AcquireFrame(lock, page_id, &frame_id)) {
+    return nullptr;
+  }
+  stats_.RecordMiss(access_type);
+  auto &page = *frames_[frame_id].page_;
+  {
+    std::lock_guard<std::mutex> frame_guard(frames_[frame_id].latch_);
+    page.page_id_ = page_id;
+    page.is_dirty_ = false;
+    page.pin_count_ = 1;
+    frames_[frame_id].io_ = FrameIoState::Loading;
+  }
+  lock.unlock();
+  try {
+    if (compressed_cache_ == nullptr || !compressed_cache_->Take(page_id, page.data_)) {
+      // read it ourselves: we have to wait for the page anyway, and handing the read to a worker would only add latency
+      disk_manager_->ReadPage(page_id, page.data_);
+    }
+  } catch (...) {
+    AbortLoad(frame_id);
+    throw;
+  }
+  LockLatch(lock);
+  auto *replacer = GetReplacer();
+  replacer->SetPage(frame_id, page_id);
+  replacer->RecordAccess(frame_id, access_type);
+  replacer->SetEvictable(frame_id, false);
+  FinishFrameIo(frame_id);
+  return &page;
+}
+
+auto BufferPoolManagerInstance::PrefetchPage(page_id_t page_id) -> bool {
+  frame_id_t frame_id;
+  auto read = StartPrefetch(page_id, &frame_id);
+  if (!read.valid()) {
+    return false;
+  }
+  try {
+    read.get();
+  } catch (...) {
+    // a prefetch is only a hint; a fetch of the page gets the error
+    AbortLoad(frame_id);
+    return false;
+  }
+  EndPrefetch(frame_id);
+  return true;
+}
+
+auto BufferPoolManagerInstance::StartPrefetch(page_id_t page_id, frame_id_t *frame_id) -> std::future<bool> {
+  auto *page = BeginPrefetch(page_id, true, frame_id);
+  if (page == nullptr) {
+    return {};
+  }
+  if (compressed_cache_ != nullptr && compressed_cache_->Take(page_id, page->data_)) {
+    std::promise<bool> done;
+    done.set_value(true);
+    return done.get_future();
+  }
+  return disk_scheduler_->ScheduleRead(page_id, page->data_);
+}
+
+auto BufferPoolManagerInstance::BeginPrefetch(page_id_t page_id, bool evict, frame_id_t *frame_id) -> Page * {
+  auto lock = LockLatch();
+  if (!retiring_.empty()) {
+    RetireFrames(lock);
+  }
+  if (page_table_.Find(page_id, frame_id) || (!evict && free_list_.empty()) ||
+      !AcquireFrame(lock, page_id, frame_id)) {
+    return nullptr;
+  }
+  auto &page = *frames_[*frame_id].page_;
+  std::lock_guard<std::mutex> frame_guard(frames_[*frame_id].latch_);
+  page.page_id_ = page_id;
+  page.is_dirty_ = false;
+  page.pin_count_ = 0;
+  frames_[*frame_id].io_ = FrameIoState::Loading;
+  return &page;
+}
+
+void BufferPoolManagerInstance::EndPrefetch(frame_id_t frame_id) {
+  auto lock = LockLatch();
+  auto page_id = frames_[frame_id].page_->page_id_;
+  if (compressed_cache_ != nullptr) {
+    // a batched read went straight to disk; the page must not be cached twice
+    compressed_cache_->Erase(page_id);
+  }
+  // nobody could pin the page while it was loading, so it can be evicted right away, unless a shrink retired the frame
+  auto *replacer = GetReplacer();
+  replacer->SetPage(frame_id, page_id);
+  replacer->RecordAccess(frame_id, AccessType::Prefetch);
+  if (static_cast<size_t>(frame_id) < pool_size_.load(std::memory_order_relaxed)) {
+    replacer->SetEvictable(frame_id, true);
+  }
+  stats_.RecordMiss(AccessType::Prefetch);
+  FinishFrameIo(frame_id);
+}
+
+void BufferPoolManagerInstance::AbortLoad(frame_id_t frame_id) {
+  auto lock = LockLatch();
+  {
+    // the loader held the only pin, and the replacer does not know the frame yet
+    std::unique_lock<std::mutex> frame_guard(frames_[frame_id].latch_);
+    frames_[frame_id].page_->pin_count_ = 0;
+    DropPage(frame_id, frame_guard);
+  }
+  FinishFrameIo(frame_id);
+}
+
+auto BufferPoolManagerInstance::GetResidentPages() -> std::vector<page_id_t> {
+  auto lock = LockLatch();
+  auto capacity = frames_.Size();
+  auto candidates = GetReplacer()->EvictionCandidates(capacity);
+  std::vector<bool> evictable(capacity, false);
+  for (auto frame_id : candidates) {
+    evictable[frame_id] = true;
+  }
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < capacity; i++) {
+    auto &frame = frames_[i];
+    std::lock_guard<std::mutex> frame_guard(frame.latch_);
+    if (!evictable[i] && frame.page_->page_id_ != INVALID_PAGE_ID && frame.io_ == FrameIoState::Idle) {
+      page_ids.push_back(frame.page_->page_id_);
+    }
+  }
+  for (auto it = candidates.rbegin(); it != candidates.rend(); ++it) {
+    page_ids.push_back(frames_[*it].page_->page_id_);
+  }
+  return page_ids;
+}
+
+auto BufferPoolManagerInstance::UnpinPage(page_id_t page_id, bool is_dirty, [[maybe_unused]] AccessType access_type)
+    -> bool {
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id)) {
+    return false;
+  }
+  auto &frame = frames_[frame_id];
+  const std::lock_guard<std::mutex> frame_guard(frame.latch_);
+  auto &page = *frame.page_;
+  // a frame with I/O in flight holds no pins from anyone but its loader
+  if (page.page_id_ != page_id || frame.io_ != FrameIoState::Idle) {
+    return false;
+  }
+  page.is_dirty_ |= is_dirty;
+  if (page.pin_count_ > 0) {
+    page.pin_count_--;
+    // a frame beyond the pool size is not evicted but retired, by the next thread that takes the instance latch
+    if (page.pin_count_ == 0 && static_cast<size_t>(frame_id) < pool_size_.load(std::memory_order_acquire)) {
+      GetReplacer()->SetEvictable(frame_id, true);
+    }
+    return true;
+  }
+  return false;
+}
+
+auto BufferPoolManagerInstance::FlushPage(page_id_t page_id) -> bool {
+  auto lock = LockLatch();
+  frame_id_t frame_id;
+  if (!LookupFrame(page_id, lock, &frame_id)) {
+    return false;
+  }
+  auto &page = *frames_[frame_id].page_;
+  {
+    // clear the flag first, so that a page dirtied again while we write stays dirty
+    std::lock_guard<std::mutex> frame_guard(frames_[frame_id].latch_);
+    page.is_dirty_ = false;
+  }
+  disk_manager_->WritePage(page.GetPageId(), page.GetData());
+  return true;
+}
+
+void BufferPoolManagerInstance::FlushAllPages() {
+  std::vector<DiskManager::PageWrite> pages;
+  auto frames = CollectDirtyPages(&pages);
+  disk_manager_->WritePages(std::move(pages));
+  FinishDirtyPages(frames);
+}
+
+auto BufferPoolManagerInstance::CollectDirtyPages(std::vector<DiskManager::PageWrite> *pages)
+    -> std::vector<frame_id_t> {
+  std::vector<frame_id_t> frames;
+  auto lock = LockLatch();
+  // frames that are retiring may still hold dirty pages
+  auto capacity = frames_.Size();
+  for (size_t i = 0; i < capacity; ++i) {
+    auto frame_id = static_cast<frame_id_t>(i);
+    auto &frame = frames_[frame_id];
+    // let a write-back in flight finish, so that every page is on disk when the caller is done. Only with our own
+    // latch held: the I/O may be a prefetch whose thread is about to take the latch of another instance.
+    frame.io_cv_.wait(lock, [&] { return frame.io_ == FrameIoState::Idle; });
+    std::lock_guard<std::mutex> frame_guard(frame.latch_);
+    auto &page = *frame.page_;
+    if (!page.is_dirty_ || page.page_id_ == INVALID_PAGE_ID) {
+      page.is_dirty_ = false;
+      continue;
+    }
+    // clear the flag first, so that a page dirtied again while we write stays dirty
+    page.is_dirty_ = false;
+    if (page.pin_count_ == 0) {
+      // like the page cleaner: fetchers wait for the write, and the frame is not evicted meanwhile
+      frame.io_ = FrameIoState::Writing;
+    } else {
+      // its holders must still be able to unpin it, so pin it as well instead
+      page.pin_count_++;
+    }
+    GetReplacer()->SetEvictable(frame_id, false);
+    frames.push_back(frame_id);
+    pages->emplace_back(page.page_id_, page.data_);
+  }
+  return frames;
+}
+
+void BufferPoolManagerInstance::FinishDirtyPages(const std::vector<frame_id_t> &frames) {
+  auto lock = LockLatch();
+  for (auto frame_id : frames) {
+    auto &frame = frames_[frame_id];
+    bool writing;
+    {
+      std::lock_guard<std::mutex> frame_guard(frame.latch_);
+      writing = frame.io_ == FrameIoState::Writing;
+      if (!writing) {
+        frame.page_->pin_count_--;
+      }
+      // a frame a shrink cut off in the meantime is left to RetireFrames
+      if (frame.page_->pin_count_ == 0 && static_cast<size_t>(frame_id) < pool_size_.load(std::memory_order_relaxed)) {
+        GetReplacer()->SetEvictable(frame_id, true);
+      }
+    }
+    if (writing) {
+      FinishFrameIo(frame_id);
+    }
+  }
+}
+
+auto BufferPoolManagerInstance::DeletePage(page_id_t page_id) -> bool {
+  auto lock = LockLatch();
+  frame_id_t frame_id;
+  if (!LookupFrame(page_id, lock, &frame_id)) {
+    if (compressed_cache_ != nullptr) {
+      // not before the lookup, which may wait for an eviction that puts the page there
+      compressed_cache_->Erase(page_id);
+    }
+    DeallocatePage(page_id);
+    return true;
+  }
+  std::unique_lock<std::mutex> frame_guard(frames_[frame_id].latch_);
+  auto &page = *frames_[frame_id].page_;
+  if (page.pin_count_ != 0) {
+    return false;
+  }
+  // no write-back: the page is freed, and NewPage hands it out again dirty, over whatever is on disk
+  page.is_dirty_ = false;
+  page.ResetMemory(disk_manager_->GetPageSize());
+  DropPage(frame_id, frame_guard);
+  DeallocatePage(page_id);
+  stats_.RecordDeletedPage();
+  return true;
+}
+
+auto BufferPoolManagerInstance::HasPinnedPages(tablespace_id_t tablespace) -> bool {
+  auto lock = LockLatch();
+  for (size_t i = 0; i < frames_.Size(); i++) {
+    auto &frame = frames_[i];
+    std::lock_guard<std::mutex> frame_guard(frame.latch_);
+    auto page_id = frame.page_->page_id_;
+    if (page_id != INVALID_PAGE_ID && DiskManager::TablespaceOf(page_id) == tablespace && frame.page_->pin_count_ > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void BufferPoolManagerInstance::DiscardPages(tablespace_id_t tablespace) {
+  auto lock = LockLatch();
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < frames_.Size(); i++) {
+    auto &frame = frames_[i];
+    std::lock_guard<std::mutex> frame_guard(frame.latch_);
+    auto page_id = frame.page_->page_id_;
+    if (page_id != INVALID_PAGE_ID && DiskManager::TablespaceOf(page_id) == tablespace) {
+      page_ids.push_back(page_id);
+    }
+  }
+  for (auto page_id : page_ids) {
+    frame_id_t frame_id;
+    if (!LookupFrame(page_id, lock, &frame_id)) {
+      continue;
+    }
+    std::unique_lock<std::mutex> frame_guard(frames_[frame_id].latch_);
+    if (frames_[frame_id].page_->pin_count_ == 0) {
+      DropPage(frame_id, frame_guard);
+    }
+  }
+}
+
+void BufferPoolManagerInstance::DropPage(frame_id_t frame_id, std::unique_lock<std::mutex> &frame_guard) {
+  auto &page = *frames_[frame_id].page_;
+  BUSTUB_ASSERT(page.pin_count_ == 0, "cannot drop a pinned page");
+  page_table_.Erase(page.page_id_);
+  page.is_dirty_ = false;
+  page.page_id_ = INVALID_PAGE_ID;
+  // a retiring frame was left non-evictable when it was unpinned
+  auto *replacer = GetReplacer();
+  replacer->SetEvictable(frame_id, true);
+  replacer->Remove(frame_id);
+  if (static_cast<size_t>(frame_id) < pool_size_.load(std::memory_order_relaxed)) {
+    free_list_.push_back(frame_id);
+  } else {
+    ReleaseFrame(frame_id);
+    frame_guard.unlock();
+    UpdateRetiringFrames();
+  }
+}
+
+auto BufferPoolManagerInstance::CleanFrames(size_t low_watermark, size_t high_watermark) -> size_t {
+  auto lock = LockLatch();
+  if (!retiring_.empty()) {
+    RetireFrames(lock);
+  }
+  size_t clean = free_list_.size();
+  if (clean >= low_watermark) {
+    return 0;
+  }
+  // only clean frames at the very front of the eviction order help the next evictions
+  auto candidates = GetReplacer()->EvictionCandidates(high_watermark - clean);
+  for (auto frame_id : candidates) {
+    std::lock_guard<std::mutex> frame_guard(frames_[frame_id].latch_);
+    if (frames_[frame_id].page_->is_dirty_) {
+      break;
+    }
+    clean++;
+  }
+  if (clean >= low_watermark) {
+    return 0;
+  }
+
+  std::vector<frame_id_t> frames;
+  std::vector<DiskManager::PageWrite> pages;
+  for (auto frame_id : candidates) {
+    auto &page = *frames_[frame_id].page_;
+    std::lock_guard<std::mutex> frame_guard(frames_[frame_id].latch_);
+    if (!page.is_dirty_ || page.pin_count_ > 0 || page.page_id_ == INVALID_PAGE_ID ||
+        frames_[frame_id].io_ != FrameIoState::Idle) {
+      continue;
+    }
+    // Keep the frame from being evicted while it is written. Fetchers wait for the write like they would for a
+    // write-back during eviction, so nobody modifies the page under us. The replacer keeps the frame's history.
+    page.is_dirty_ = false;
+    frames_[frame_id].io_ = FrameIoState::Writing;
+    GetReplacer()->SetEvictable(frame_id, false);
+    frames.push_back(frame_id);
+    pages.emplace_back(page.page_id_, page.data_);
+  }
+  if (frames.empty()) {
+    return 0;
+  }
+
+  // one batch, so that pages next to each other on disk go out in one write
+  lock.unlock();
+  disk_manager_->WritePages(std::move(pages), false);
+  LockLatch(lock);
+  for (auto frame_id : frames) {
+    // still before anyone can pin the page again; a frame a shrink cut off in the meantime is left to RetireFrames
+    if (static_cast<size_t>(frame_id) < pool_size_.load(std::memory_order_relaxed)) {
+      GetReplacer()->SetEvictable(frame_id, true);
+    }
+    FinishFrameIo(frame_id);
+  }
+  stats_.RecordBackgroundWriteBacks(frames.size());
+  return frames.size();
+}
+
+auto BufferPoolManagerInstance::AllocatePage(bool *reused, tablespace_id_t tablespace) -> page_id_t {
+  const page_id_t page_id = disk_manager_->AllocatePage(instance_index_, num_instances_, reused, tablespace);
+  ValidatePageId(page_id);
+  return page_id;
+}
+
+void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
+  assert(page_id % num_instances_ == instance_index_);  // allocated pages mod back to this BPI
+}
+
+}  // namespace bustub
@@ -0,0 +1,175 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.cpp
+//
+// Identification: src/buffer/buffer_pool_stats.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats.h"
+
+#include <algorithm>
+
+#include "fmt/format.h"
+
+namespace bustub {
+
+auto AccessTypeToString(AccessType access_type) -> const char * {
+  switch (access_type) {
+    case AccessType::Unknown:
+      return "unknown";
+    case AccessType::Get:
+      return "get";
+    case AccessType::Scan:
+      return "scan";
+    case AccessType::Prefetch:
+      return "prefetch";
+  }
+  return "invalid";
+}
+
+auto BufferPoolStats::Hits() const -> uint64_t {
+  uint64_t hits = 0;
+  for (auto count : hits_) {
+    hits += count;
+  }
+  return hits;
+}
+
+auto BufferPoolStats::Misses() const -> uint64_t {
+  uint64_t misses = 0;
+  for (auto count : misses_) {
+    misses += count;
+  }
+  return misses;
+}
+
+auto BufferPoolStats::HitRatio() const -> double {
+  auto fetches = Hits() + Misses();
+  return fetches == 0 ? 0 : static_cast<double>(Hits()) / static_cast<double>(fetches);
+}
+
+auto BufferPoolStats::CompressedHitRatio() const -> double {
+  auto lookups = compressed_hits_ + compressed_misses_;
+  return lookups == 0 ? 0 : static_cast<double>(compressed_hits_) / static_cast<double>(lookups);
+}
+
+auto BufferPoolStats::CompressionRatio() const -> double {
+  if (compressed_bytes_out_ == 0) {
+    return 0;
+  }
+  return static_cast<double>(compressed_bytes_in_) / static_cast<double>(compressed_bytes_out_);
+}
+
+auto BufferPoolStats::operator+=(const BufferPoolStats &other) -> BufferPoolStats & {
+  for (size_t i = 0; i < NUM_ACCESS_TYPES; i++) {
+    hits_[i] += other.hits_[i];
+    misses_[i] += other.misses_[i];
+  }
+  evictions_ += other.evictions_;
+  foreground_write_backs_ += other.foreground_write_backs_;
+  background_write_backs_ += other.background_write_backs_;
+  new_pages_ += other.new_pages_;
+  deleted_pages_ += other.deleted_pages_;
+  max_pin_count_ = std::max(max_pin_count_, other.max_pin_count_);
+  latch_wait_ += other.latch_wait_;
+  compressed_capacity_ += other.compressed_capacity_;
+  compressed_hits_ += other.compressed_hits_;
+  compressed_misses_ += other.compressed_misses_;
+  compressed_stores_ += other.compressed_stores_;
+  compressed_rejects_ += other.compressed_rejects_;
+  compressed_evictions_ += other.compressed_evictions_;
+  compressed_bytes_in_ += other.compressed_bytes_in_;
+  compressed_bytes_out_ += other.compressed_bytes_out_;
+  compressed_pages_ += other.compressed_pages_;
+  compressed_memory_ += other.compressed_memory_;
+  return *this;
+}
+
+auto BufferPoolStats::Since(const BufferPoolStats &earlier) const -> BufferPoolStats {
+  BufferPoolStats delta = *this;
+  for (size_t i = 0; i < NUM_ACCESS_TYPES; i++) {
+    delta.hits_[i] -= earlier.hits_[i];
+    delta.misses_[i] -= earlier.misses_[i];
+  }
+  delta.evictions_ -= earlier.evictions_;
+  delta.foreground_write_backs_ -= earlier.foreground_write_backs_;
+  delta.background_write_backs_ -= earlier.background_write_backs_;
+  delta.new_pages_ -= earlier.new_pages_;
+  delta.deleted_pages_ -= earlier.deleted_pages_;
+  delta.latch_wait_ -= earlier.latch_wait_;
+  delta.compressed_hits_ -= earlier.compressed_hits_;
+  delta.compressed_misses_ -= earlier.compressed_misses_;
+  delta.compressed_stores_ -= earlier.compressed_stores_;
+  delta.compressed_rejects_ -= earlier.compressed_rejects_;
+  delta.compressed_evictions_ -= earlier.compressed_evictions_;
+  delta.compressed_bytes_in_ -= earlier.compressed_bytes_in_;
+  delta.compressed_bytes_out_ -= earlier.compressed_bytes_out_;
+  return delta;
+}
+
+auto BufferPoolStats::ToRows() const -> std::vector<std::pair<std::string, std::string>> {
+  std::vector<std::pair<std::string, std::string>> rows;
+  rows.emplace_back("hit_ratio", fmt::format("{:.4f}", HitRatio()));
+  for (size_t i = 0; i < NUM_ACCESS_TYPES; i++) {
+    auto name = AccessTypeToString(static_cast<AccessType>(i));
+    rows.emplace_back(fmt::format("hits_{}", name), std::to_string(hits_[i]));
+    rows.emplace_back(fmt::format("misses_{}", name), std::to_string(misses_[i]));
+  }
+  rows.emplace_back("evictions", std::to_string(evictions_));
+  rows.emplace_back("foreground_write_backs", std::to_string(foreground_write_backs_));
+  rows.emplace_back("background_write_backs", std::to_string(background_write_backs_));
+  rows.emplace_back("new_pages", std::to_string(new_pages_));
+  rows.emplace_back("deleted_pages", std::to_string(deleted_pages_));
+  rows.emplace_back("max_pin_count", std::to_string(max_pin_count_));
+  rows.emplace_back("latch_wait_us", std::to_string(latch_wait_.count() / 1000));
+  if (compressed_capacity_ == 0) {
+    return rows;
+  }
+  rows.emplace_back("compressed_hit_ratio", fmt::format("{:.4f}", CompressedHitRatio()));
+  rows.emplace_back("compressed_hits", std::to_string(compressed_hits_));
+  rows.emplace_back("compressed_misses", std::to_string(compressed_misses_));
+  rows.emplace_back("compression_ratio", fmt::format("{:.2f}", CompressionRatio()));
+  rows.emplace_back("compressed_stores", std::to_string(compressed_stores_));
+  rows.emplace_back("compressed_rejects", std::to_string(compressed_rejects_));
+  rows.emplace_back("compressed_evictions", std::to_string(compressed_evictions_));
+  rows.emplace_back("compressed_pages", std::to_string(compressed_pages_));
+  rows.emplace_back("compressed_memory_kb",
+                    fmt::format("{}/{}", compressed_memory_ / 1024, compressed_capacity_ / 1024));
+  return rows;
+}
+
+auto BufferPoolStats::ToString() const -> std::string {
+  auto line = fmt::format(
+      "hit_ratio={:.4f} hits={} misses={} evictions={} write_backs={}+{} new_pages={} deleted_pages={} "
+      "max_pin_count={} latch_wait_us={}",
+      HitRatio(), Hits(), Misses(), evictions_, foreground_write_backs_, background_write_backs_, new_pages_,
+      deleted_pages_, max_pin_count_, latch_wait_.count() / 1000);
+  if (compressed_capacity_ > 0) {
+    line += fmt::format(" compressed_hit_ratio={:.4f} compression_ratio={:.2f} compressed_pages={}",
+                        CompressedHitRatio(), CompressionRatio(), compressed_pages_);
+  }
+  return line;
+}
+
+auto BufferPoolCounters::Snapshot() const -> BufferPoolStats {
+  BufferPoolStats stats;
+  for (size_t i = 0; i < NUM_ACCESS_TYPES; i++) {
+    stats.hits_[i] = hits_[i].load(std::memory_order_relaxed);
+    stats.misses_[i] = misses_[i].load(std::memory_order_relaxed);
+  }
+  stats.evictions_ = evictions_.load(std::memory_order_relaxed);
+  stats.foreground_write_backs_ = foreground_write_backs_.load(std::memory_order_relaxed);
+  stats.background_write_backs_ = background_write_backs_.load(std::memory_order_relaxed);
+  stats.new_pages_ = new_pages_.load(std::memory_order_relaxed);
+  stats.deleted_pages_ = deleted_pages_.load(std::memory_order_relaxed);
+  stats.max_pin_count_ = max_pin_count_.load(std::memory_order_relaxed);
+  stats.latch_wait_ = std::chrono::nanoseconds(latch_wait_ns_.load(std::memory_order_relaxed));
+  return stats;
+}
+
+}  // namespace bustub
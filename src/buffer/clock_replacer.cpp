@@ -14,16 +14,111 @@
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages) : num_frames_(num_pages), frames_(num_pages) {}
 
 ClockReplacer::~ClockReplacer() = default;
 
-auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto ClockReplacer::Evict(frame_id_t *frame_id) -> bool {
+  // Without interference two full turns of the hand find a victim: the first turn clears every reference bit. With
+  // concurrent evictions this thread only sees some of the positions, so keep going while anything is evictable.
+  while (size_.load(std::memory_order_acquire) > 0) {
+    auto candidate = hand_.fetch_add(1, std::memory_order_relaxed) % num_frames_.load(std::memory_order_acquire);
+    auto &frame = frames_[candidate];
+    if (frame.state_.load(std::memory_order_acquire) != EVICTABLE) {
+      continue;
+    }
+    if (frame.ref_.load(std::memory_order_relaxed)) {
+      // second chance
+      frame.ref_.store(false, std::memory_order_relaxed);
+      continue;
+    }
+    uint8_t expected = EVICTABLE;
+    if (frame.state_.compare_exchange_strong(expected, UNTRACKED, std::memory_order_acq_rel)) {
+      size_.fetch_sub(1, std::memory_order_acq_rel);
+      *frame_id = static_cast<frame_id_t>(candidate);
+      return true;
+    }
+  }
+  return false;
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  CheckFrameId(frame_id);
+  auto &frame = frames_[frame_id];
+  uint8_t expected = UNTRACKED;
+  frame.state_.compare_exchange_strong(expected, PINNED, std::memory_order_acq_rel);
+  if (access_type == AccessType::Scan) {
+    // scans do not earn a second chance, so their frames are the first ones the hand takes
+    return;
+  }
+  // skip the store when the bit is already set, so hot frames do not keep bouncing the cache line
+  if (!frame.ref_.load(std::memory_order_relaxed)) {
+    frame.ref_.store(true, std::memory_order_relaxed);
+  }
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  CheckFrameId(frame_id);
+  uint8_t expected = set_evictable ? PINNED : EVICTABLE;
+  if (frames_[frame_id].state_.compare_exchange_strong(expected, set_evictable ? EVICTABLE : PINNED,
+                                                       std::memory_order_acq_rel)) {
+    if (set_evictable) {
+      size_.fetch_add(1, std::memory_order_acq_rel);
+    } else {
+      size_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+  }
+}
 
-auto ClockReplacer::Size() -> size_t { return 0; }
+void ClockReplacer::Remove(frame_id_t frame_id) {
+  CheckFrameId(frame_id);
+  auto &frame = frames_[frame_id];
+  uint8_t expected = EVICTABLE;
+  if (frame.state_.compare_exchange_strong(expected, UNTRACKED, std::memory_order_acq_rel)) {
+    frame.ref_.store(false, std::memory_order_relaxed);
+    size_.fetch_sub(1, std::memory_order_acq_rel);
+    return;
+  }
+  BUSTUB_ENSURE(expected != PINNED, "cannot remove a non-evictable frame");
+}
+
+auto ClockReplacer::Size() -> size_t { return size_.load(std::memory_order_acquire); }
+
+auto ClockReplacer::EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> {
+  std::vector<frame_id_t> candidates;
+  std::vector<frame_id_t> second_chance;
+  auto hand = hand_.load(std::memory_order_relaxed);
+  auto num_frames = num_frames_.load(std::memory_order_acquire);
+  for (size_t i = 0; i < num_frames && candidates.size() < max_frames; i++) {
+    auto frame_id = (hand + i) % num_frames;
+    if (frames_[frame_id].state_.load(std::memory_order_acquire) != EVICTABLE) {
+      continue;
+    }
+    if (frames_[frame_id].ref_.load(std::memory_order_relaxed)) {
+      second_chance.push_back(static_cast<frame_id_t>(frame_id));
+    } else {
+      candidates.push_back(static_cast<frame_id_t>(frame_id));
+    }
+  }
+  for (size_t i = 0; i < second_chance.size() && candidates.size() < max_frames; i++) {
+    candidates.push_back(second_chance[i]);
+  }
+  return candidates;
+}
+
+void ClockReplacer::Resize(size_t num_frames) {
+  for (auto frame_id = num_frames; frame_id < num_frames_.load(std::memory_order_relaxed); frame_id++) {
+    BUSTUB_ENSURE(frames_[frame_id].state_.load(std::memory_order_acquire) == UNTRACKED,
+                  "cannot drop a tracked frame");
+  }
+  // frames beyond the old size may have been dropped by an earlier shrink; nobody has touched them since
+  frames_.Grow(num_frames);
+  num_frames_.store(num_frames, std::memory_order_release);
+}
+
+void ClockReplacer::CheckFrameId(frame_id_t frame_id) const {
+  BUSTUB_ENSURE(frame_id >= 0 && static_cast<size_t>(frame_id) < num_frames_.load(std::memory_order_acquire),
+                "invalid frame id");
+}
 
 }  // namespace bustub
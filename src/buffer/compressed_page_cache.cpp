@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.cpp
+//
+// Identification: src/buffer/compressed_page_cache.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/compressed_page_cache.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/util/lz_codec.h"
+
+namespace bustub {
+
+CompressedPageCache::CompressedPageCache(size_t capacity, size_t page_size)
+    : page_size_(page_size),
+      max_compressed_size_(page_size * 3 / 4),
+      num_chunks_(capacity / CHUNK_SIZE),
+      region_(std::make_unique<char[]>(num_chunks_ * CHUNK_SIZE)) {
+  BUSTUB_ASSERT(page_size <= LzCodec::MAX_INPUT_SIZE, "page too large to compress");
+  free_chunks_.reserve(num_chunks_);
+  // hand out the chunks from the front of the region first
+  for (size_t i = num_chunks_; i > 0; i--) {
+    free_chunks_.push_back(static_cast<uint32_t>(i - 1));
+  }
+}
+
+auto CompressedPageCache::Put(page_id_t page_id, const char *data) -> bool {
+  std::vector<char> compressed(max_compressed_size_);
+  auto size = LzCodec::Compress(data, page_size_, compressed.data(), compressed.size());
+  auto num_chunks = (size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = entries_.find(page_id);
+  if (it != entries_.end()) {
+    EraseEntry(it);
+  }
+  if (size == 0 || num_chunks > num_chunks_) {
+    rejects_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  while (free_chunks_.size() < num_chunks) {
+    EraseEntry(entries_.find(lru_.back()));
+    evictions_.fetch_add(1, std::memory_order_relaxed);
+  }
+  lru_.push_front(page_id);
+  auto &entry = entries_[page_id];
+  entry.size_ = size;
+  entry.lru_pos_ = lru_.begin();
+  for (size_t offset = 0; offset < size; offset += CHUNK_SIZE) {
+    auto chunk = free_chunks_.back();
+    free_chunks_.pop_back();
+    memcpy(region_.get() + chunk * CHUNK_SIZE, compressed.data() + offset, std::min(CHUNK_SIZE, size - offset));
+    entry.chunks_.push_back(chunk);
+  }
+  stores_.fetch_add(1, std::memory_order_relaxed);
+  bytes_in_.fetch_add(page_size_, std::memory_order_relaxed);
+  bytes_out_.fetch_add(size, std::memory_order_relaxed);
+  pages_.fetch_add(1, std::memory_order_relaxed);
+  used_chunks_.fetch_add(num_chunks, std::memory_order_relaxed);
+  return true;
+}
+
+auto CompressedPageCache::Take(page_id_t page_id, char *data) -> bool {
+  std::vector<char> compressed;
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    auto it = entries_.find(page_id);
+    if (it == entries_.end()) {
+      misses_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    auto &entry = it->second;
+    compressed.resize(entry.size_);
+    for (size_t i = 0; i < entry.chunks_.size(); i++) {
+      auto offset = i * CHUNK_SIZE;
+      memcpy(compressed.data() + offset, region_.get() + entry.chunks_[i] * CHUNK_SIZE,
+             std::min(CHUNK_SIZE, entry.size_ - offset));
+    }
+    EraseEntry(it);
+  }
+  BUSTUB_ENSURE(LzCodec::Decompress(compressed.data(), compressed.size(), data, page_size_),
+                "damaged page in the compressed cache");
+  hits_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void CompressedPageCache::Erase(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = entries_.find(page_id);
+  if (it != entries_.end()) {
+    EraseEntry(it);
+  }
+}
+
+void CompressedPageCache::EraseIf(const std::function<bool(page_id_t)> &pred) {
+  std::lock_guard<std::mutex> guard(latch_);
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    auto next = std::next(it);
+    if (pred(it->first)) {
+      EraseEntry(it);
+    }
+    it = next;
+  }
+}
+
+void CompressedPageCache::AddStats(BufferPoolStats *stats) {
+  stats->compressed_capacity_ += num_chunks_ * CHUNK_SIZE;
+  stats->compressed_hits_ += hits_.load(std::memory_order_relaxed);
+  stats->compressed_misses_ += misses_.load(std::memory_order_relaxed);
+  stats->compressed_stores_ += stores_.load(std::memory_order_relaxed);
+  stats->compressed_rejects_ += rejects_.load(std::memory_order_relaxed);
+  stats->compressed_evictions_ += evictions_.load(std::memory_order_relaxed);
+  stats->compressed_bytes_in_ += bytes_in_.load(std::memory_order_relaxed);
+  stats->compressed_bytes_out_ += bytes_out_.load(std::memory_order_relaxed);
+  stats->compressed_pages_ += pages_.load(std::memory_order_relaxed);
+  stats->compressed_memory_ += used_chunks_.load(std::memory_order_relaxed) * CHUNK_SIZE;
+}
+
+void CompressedPageCache::EraseEntry(std::unordered_map<page_id_t, Entry>::iterator it) {
+  auto &entry = it->second;
+  free_chunks_.insert(free_chunks_.end(), entry.chunks_.begin(), entry.chunks_.end());
+  used_chunks_.fetch_sub(entry.chunks_.size(), std::memory_order_relaxed);
+  pages_.fetch_sub(1, std::memory_order_relaxed);
+  lru_.erase(entry.lru_pos_);
+  entries_.erase(it);
+}
+
+}  // namespace bustub
@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+
+#include "common/exception.h"
+
+#if defined(__SANITIZE_ADDRESS__)
+#define BUSTUB_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define BUSTUB_ASAN 1
+#endif
+#endif
+
+#ifdef BUSTUB_ASAN
+#include <sanitizer/asan_interface.h>
+#endif
+
+namespace bustub {
+
+/** Size of an x86-64 / aarch64 default huge page, which explicit mappings must be a multiple of. */
+static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+FrameArena::FrameArena(size_t num_frames, size_t frame_size, HugePagePolicy huge_pages) {
+#ifdef BUSTUB_ASAN
+  stride_ = 2 * frame_size;
+#else
+  stride_ = frame_size;
+#endif
+  length_ = num_frames * stride_;
+  if (length_ == 0) {
+    return;
+  }
+
+#ifdef MAP_HUGETLB
+  if (huge_pages == HugePagePolicy::Explicit) {
+    auto length = (length_ + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    void *base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (base != MAP_FAILED) {
+      base_ = static_cast<char *>(base);
+      length_ = length;
+      huge_pages_ = HugePagePolicy::Explicit;
+    }
+  }
+#endif
+  if (base_ == nullptr) {
+    void *base = mmap(nullptr, length_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot map the buffer pool frames");
+    }
+    base_ = static_cast<char *>(base);
+#ifdef MADV_HUGEPAGE
+    // only a hint: without THP support the arena simply stays on regular pages
+    if (huge_pages != HugePagePolicy::None && madvise(base_, length_, MADV_HUGEPAGE) == 0) {
+      huge_pages_ = HugePagePolicy::Transparent;
+    }
+#endif
+  }
+
+#ifdef BUSTUB_ASAN
+  for (size_t i = 0; i < num_frames; i++) {
+    ASAN_POISON_MEMORY_REGION(GetFrame(i) + frame_size, stride_ - frame_size);
+  }
+#endif
+}
+
+void FrameArena::Discard(char *frame, size_t frame_size) {
+  // fails on huge pages, which cannot be given back piecemeal; the frame is reused as it is then
+  madvise(frame, frame_size, MADV_DONTNEED);
+}
+
+FrameArena::~FrameArena() {
+  if (base_ == nullptr) {
+    return;
+  }
+#ifdef BUSTUB_ASAN
+  ASAN_UNPOISON_MEMORY_REGION(base_, length_);
+#endif
+  munmap(base_, length_);
+}
+
+}  // namespace bustub
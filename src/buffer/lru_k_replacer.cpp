@@ -11,123 +11,213 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/lru_k_replacer.h"
+
+#include <algorithm>
+#include <utility>
+
 #include "common/exception.h"
 
 namespace bustub {
 
-LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_frames), k_(k) {
-  is_accessible_.resize(num_frames + 1);
-  current_size_ = 0;
+LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k)
+    : replacer_size_(num_frames),
+      k_(k),
+      history_(num_frames * k),
+      access_count_(num_frames, 0),
+      evictable_(num_frames, false),
+      scan_only_(num_frames, false),
+      prefetched_(num_frames, false),
+      heap_pos_(num_frames, NOT_IN_HEAP) {
+  BUSTUB_ASSERT(k > 0, "k must be positive");
+  heap_.reserve(num_frames);
 }
 
 auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
   std::lock_guard<std::mutex> guard(latch_);
-  *frame_id = 0;
-  if (history_map_.empty() && cache_map_.empty()) {
+  if (heap_.empty()) {
     return false;
   }
+  *frame_id = heap_.front();
+  HeapErase(*frame_id);
+  ResetFrame(*frame_id);
+  return true;
+}
 
-  auto it = history_list_.end();
-  while (it != history_list_.begin()) {
-    it--;
-    if (!is_accessible_[*it]) {
-      continue;
-    }
-    history_map_.erase(*it);
-    *frame_id = *it;
-    use_count_[*it] = 0;
-    is_accessible_[*it] = false;
-    current_size_--;
-    history_list_.erase(it);
-    return true;
+void LRUKReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  std::lock_guard<std::mutex> guard(latch_);
+  CheckFrameId(frame_id);
+  auto count = access_count_[frame_id];
+  if (prefetched_[frame_id] && access_type != AccessType::Prefetch) {
+    // the page is used for the first time, the prefetch was not a use
+    prefetched_[frame_id] = false;
+    count = 0;
   }
-  it = cache_list_.end();
-  while (it != cache_list_.begin()) {
-    it--;
-    if (!is_accessible_[*it]) {
-      continue;
+  if (access_type == AccessType::Scan || access_type == AccessType::Prefetch) {
+    if (count > 0) {
+      // a scan passing over a frame says nothing about whether it will be reused
+      return;
     }
-    *frame_id = *it;
-    use_count_[*it] = 0;
-    current_size_--;
-    is_accessible_[*it] = false;
-    cache_map_.erase(*it);
-    cache_list_.erase(it);
-    return true;
+    scan_only_[frame_id] = access_type == AccessType::Scan;
+    prefetched_[frame_id] = access_type == AccessType::Prefetch;
+  } else if (scan_only_[frame_id]) {
+    // first real use: forget the scan accesses
+    scan_only_[frame_id] = false;
+    count = 0;
+  }
+  history_[frame_id * k_ + count % k_] = current_timestamp_++;
+  access_count_[frame_id] = count + 1;
+  if (heap_pos_[frame_id] != NOT_IN_HEAP) {
+    HeapFix(heap_pos_[frame_id]);
   }
-  return false;
 }
 
-void LRUKReplacer::RecordAccess(frame_id_t frame_id, [[maybe_unused]] AccessType access_type) {
+void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
   std::lock_guard<std::mutex> guard(latch_);
-  if (frame_id > static_cast<int>(replacer_size_)) {
-    throw std::exception();
+  CheckFrameId(frame_id);
+  if (access_count_[frame_id] == 0 || evictable_[frame_id] == set_evictable) {
+    return;
   }
-  use_count_[frame_id]++;
-  if (use_count_[frame_id] == k_) {
-    if (history_map_.count(frame_id) != 0U) {
-      auto it = history_map_[frame_id];
-      history_list_.erase(it);
-    }
-    history_map_.erase(frame_id);
-    // 2. add frame_id into cache list
-    cache_list_.push_front(frame_id);
-    cache_map_[frame_id] = cache_list_.begin();
-  } else if (use_count_[frame_id] > k_) {
-    if (cache_map_.count(frame_id) != 0U) {
-      auto it = cache_map_[frame_id];
-      cache_list_.erase(it);
-    }
-    // 2. add frame_id into cache list
-    cache_list_.push_front(frame_id);
-    cache_map_[frame_id] = cache_list_.begin();
+  evictable_[frame_id] = set_evictable;
+  if (set_evictable) {
+    HeapPush(frame_id);
   } else {
-    if (history_map_.count(frame_id) == 0U) {
-      history_list_.push_front(frame_id);
-      history_map_[frame_id] = history_list_.begin();
-    }
+    HeapErase(frame_id);
   }
 }
 
-void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+void LRUKReplacer::Remove(frame_id_t frame_id) {
   std::lock_guard<std::mutex> guard(latch_);
-  if (frame_id > static_cast<int>(replacer_size_)) {
-    throw std::exception();
-  }
-  if (use_count_[frame_id] == 0) {
+  CheckFrameId(frame_id);
+  if (access_count_[frame_id] == 0) {
     return;
   }
-  if (!is_accessible_[frame_id] && set_evictable) {
-    current_size_++;
+  BUSTUB_ENSURE(evictable_[frame_id], "cannot remove a non-evictable frame");
+  HeapErase(frame_id);
+  ResetFrame(frame_id);
+}
+
+auto LRUKReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> guard(latch_);
+  return heap_.size();
+}
+
+auto LRUKReplacer::EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> guard(latch_);
+  std::vector<frame_id_t> candidates(heap_);
+  auto count = std::min(max_frames, candidates.size());
+  std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+                    [this](frame_id_t a, frame_id_t b) { return EvictsBefore(a, b); });
+  candidates.resize(count);
+  return candidates;
+}
+
+void LRUKReplacer::Resize(size_t num_frames) {
+  std::lock_guard<std::mutex> guard(latch_);
+  for (auto frame_id = num_frames; frame_id < replacer_size_; frame_id++) {
+    BUSTUB_ENSURE(access_count_[frame_id] == 0, "cannot drop a tracked frame");
+  }
+  replacer_size_ = num_frames;
+  history_.resize(num_frames * k_);
+  access_count_.resize(num_frames, 0);
+  evictable_.resize(num_frames, false);
+  scan_only_.resize(num_frames, false);
+  prefetched_.resize(num_frames, false);
+  heap_pos_.resize(num_frames, NOT_IN_HEAP);
+  heap_.reserve(num_frames);
+}
+
+void LRUKReplacer::CheckFrameId(frame_id_t frame_id) const {
+  BUSTUB_ENSURE(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "invalid frame id");
+}
+
+auto LRUKReplacer::EvictionTimestamp(frame_id_t frame_id) const -> size_t {
+  // With fewer than k accesses the ring has not wrapped and slot 0 holds the first access. Otherwise the next slot to
+  // be overwritten holds the k-th most recent access.
+  auto count = access_count_[frame_id];
+  return history_[frame_id * k_ + (count < k_ ? 0 : count % k_)];
+}
+
+auto LRUKReplacer::EvictsBefore(frame_id_t a, frame_id_t b) const -> bool {
+  // frames only touched by scans go first, then +inf backward k-distance, then the larger backward k-distance, i.e.
+  // the older timestamp
+  if (scan_only_[a] != scan_only_[b]) {
+    return scan_only_[a];
+  }
+  bool a_inf = access_count_[a] < k_;
+  bool b_inf = access_count_[b] < k_;
+  if (a_inf != b_inf) {
+    return a_inf;
   }
-  if (is_accessible_[frame_id] && !set_evictable) {
-    current_size_--;
+  return EvictionTimestamp(a) < EvictionTimestamp(b);
+}
+
+void LRUKReplacer::HeapPush(frame_id_t frame_id) {
+  heap_pos_[frame_id] = heap_.size();
+  heap_.push_back(frame_id);
+  HeapSiftUp(heap_.size() - 1);
+}
+
+void LRUKReplacer::HeapErase(frame_id_t frame_id) {
+  auto pos = heap_pos_[frame_id];
+  auto last = heap_.size() - 1;
+  if (pos != last) {
+    HeapSwap(pos, last);
+  }
+  heap_.pop_back();
+  heap_pos_[frame_id] = NOT_IN_HEAP;
+  if (pos != last) {
+    HeapFix(pos);
   }
-  is_accessible_[frame_id] = set_evictable;
 }
 
-void LRUKReplacer::Remove(frame_id_t frame_id) {
-  std::lock_guard<std::mutex> guard(latch_);
-  if (!is_accessible_[frame_id]) {
-    return;
+void LRUKReplacer::HeapFix(size_t pos) {
+  if (HeapSiftUp(pos) == pos) {
+    HeapSiftDown(pos);
   }
-  if (frame_id > static_cast<int>(replacer_size_)) {
-    return;
+}
+
+void LRUKReplacer::HeapSwap(size_t i, size_t j) {
+  std::swap(heap_[i], heap_[j]);
+  heap_pos_[heap_[i]] = i;
+  heap_pos_[heap_[j]] = j;
+}
+
+auto LRUKReplacer::HeapSiftUp(size_t pos) -> size_t {
+  while (pos > 0) {
+    auto parent = (pos - 1) / 2;
+    if (!EvictsBefore(heap_[pos], heap_[parent])) {
+      break;
+    }
+    HeapSwap(pos, parent);
+    pos = parent;
   }
-  if (use_count_[frame_id] < k_) {
-    auto it = history_map_[frame_id];
-    history_list_.erase(it);
-    history_map_.erase(frame_id);
-  } else {
-    auto it = cache_map_[frame_id];
-    cache_list_.erase(it);
-    cache_map_.erase(frame_id);
+  return pos;
+}
+
+void LRUKReplacer::HeapSiftDown(size_t pos) {
+  while (true) {
+    auto first = pos;
+    auto left = pos * 2 + 1;
+    auto right = left + 1;
+    if (left < heap_.size() && EvictsBefore(heap_[left], heap_[first])) {
+      first = left;
+    }
+    if (right < heap_.size() && EvictsBefore(heap_[right], heap_[first])) {
+      first = right;
+    }
+    if (first == pos) {
+      return;
+    }
+    HeapSwap(pos, first);
+    pos = first;
   }
-  use_count_[frame_id] = 0;
-  is_accessible_[frame_id] = false;
-  current_size_--;
 }
 
-auto LRUKReplacer::Size() -> size_t { return current_size_; }
+void LRUKReplacer::ResetFrame(frame_id_t frame_id) {
+  access_count_[frame_id] = 0;
+  evictable_[frame_id] = false;
+  scan_only_[frame_id] = false;
+  prefetched_[frame_id] = false;
+}
 
 }  // namespace bustub
@@ -18,12 +18,18 @@ LRUReplacer::LRUReplacer(size_t num_pages) {}
 
 LRUReplacer::~LRUReplacer() = default;
 
-auto LRUReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto LRUReplacer::Evict(frame_id_t *frame_id) -> bool { return false; }
 
-void LRUReplacer::Pin(frame_id_t frame_id) {}
+void LRUReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {}
 
-void LRUReplacer::Unpin(frame_id_t frame_id) {}
+void LRUReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {}
+
+void LRUReplacer::Remove(frame_id_t frame_id) {}
 
 auto LRUReplacer::Size() -> size_t { return 0; }
 
+auto LRUReplacer::EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> { return {}; }
+
+void LRUReplacer::Resize(size_t num_frames) {}
+
 }  // namespace bustub
@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include <thread>  // NOLINT
+
+namespace bustub {
+
+PageTable::PageTable(size_t max_entries) {
+  tables_.push_back(std::make_unique<Slots>(max_entries));
+  slots_.store(tables_.back().get(), std::memory_order_release);
+}
+
+PageTable::Slots::Slots(size_t max_entries) {
+  // keep the load factor at or below one half, so probe sequences stay short
+  size_t num_slots = 2;
+  int log_slots = 1;
+  while (num_slots < max_entries * 2) {
+    num_slots *= 2;
+    log_slots++;
+  }
+  mask_ = num_slots - 1;
+  shift_ = 64 - log_slots;
+  entries_ = std::make_unique<std::atomic<uint64_t>[]>(num_slots);
+  for (size_t i = 0; i < num_slots; i++) {
+    entries_[i].store(EMPTY, std::memory_order_relaxed);
+  }
+}
+
+auto PageTable::Find(page_id_t page_id, frame_id_t *frame_id) const -> bool {
+  const auto *slots = slots_.load(std::memory_order_acquire);
+  while (true) {
+    auto version = slots->version_.load(std::memory_order_acquire);
+    if ((version & 1) != 0) {
+      std::this_thread::yield();
+      continue;
+    }
+    auto entry = slots->entries_[slots->Probe(page_id)].load(std::memory_order_acquire);
+    // an entry Erase moved while we were probing may have been skipped, so a miss is only trusted if nothing moved
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (entry != EMPTY) {
+      *frame_id = EntryFrameId(entry);
+      return true;
+    }
+    if (slots->version_.load(std::memory_order_relaxed) == version) {
+      return false;
+    }
+  }
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  BUSTUB_ASSERT(page_id != INVALID_PAGE_ID, "cannot insert an invalid page id");
+  auto *slots = tables_.back().get();
+  auto slot = slots->Probe(page_id);
+  if (slots->entries_[slot].load(std::memory_order_relaxed) == EMPTY) {
+    BUSTUB_ASSERT(size_ < (slots->mask_ + 1) / 2, "page table is full");
+    size_++;
+  }
+  slots->entries_[slot].store(MakeEntry(page_id, frame_id), std::memory_order_release);
+}
+
+void PageTable::Erase(page_id_t page_id) {
+  auto *slots = tables_.back().get();
+  auto hole = slots->Probe(page_id);
+  if (slots->entries_[hole].load(std::memory_order_relaxed) == EMPTY) {
+    return;
+  }
+  slots->version_.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  // Backward-shift deletion: move every later entry of the cluster that may not sit after the hole into the hole.
+  for (auto slot = (hole + 1) & slots->mask_;; slot = (slot + 1) & slots->mask_) {
+    auto entry = slots->entries_[slot].load(std::memory_order_relaxed);
+    if (entry == EMPTY) {
+      break;
+    }
+    auto home = slots->Home(EntryPageId(entry));
+    bool stays = hole <= slot ? (hole < home && home <= slot) : (hole < home || home <= slot);
+    if (!stays) {
+      slots->entries_[hole].store(entry, std::memory_order_relaxed);
+      hole = slot;
+    }
+  }
+  slots->entries_[hole].store(EMPTY, std::memory_order_relaxed);
+  size_--;
+  slots->version_.fetch_add(1, std::memory_order_release);
+}
+
+void PageTable::Grow(size_t max_entries) {
+  if (max_entries <= Capacity()) {
+    return;
+  }
+  auto grown = std::make_unique<Slots>(max_entries);
+  const auto *slots = tables_.back().get();
+  for (size_t i = 0; i <= slots->mask_; i++) {
+    auto entry = slots->entries_[i].load(std::memory_order_relaxed);
+    if (entry != EMPTY) {
+      grown->entries_[grown->Probe(EntryPageId(entry))].store(entry, std::memory_order_relaxed);
+    }
+  }
+  slots_.store(grown.get(), std::memory_order_release);
+  tables_.push_back(std::move(grown));
+}
+
+auto PageTable::Slots::Probe(page_id_t page_id) const -> size_t {
+  for (auto slot = Home(page_id);; slot = (slot + 1) & mask_) {
+    auto entry = entries_[slot].load(std::memory_order_acquire);
+    if (entry == EMPTY || EntryPageId(entry) == page_id) {
+      return slot;
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,33 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_ahead_window.cpp
+//
+// Identification: src/buffer/read_ahead_window.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/read_ahead_window.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+void ReadAheadWindow::Advance(page_id_t page_id, page_id_t next_page_id) {
+  if (bpm_ == nullptr || window_size_ == 0 || page_id == current_page_id_) {
+    return;
+  }
+  current_page_id_ = page_id;
+  if (pages_until_refill_ > 0) {
+    pages_until_refill_--;
+    return;
+  }
+  // the first half of the chain is normally cached already, which the prefetcher finds out without any I/O
+  bpm_->PrefetchChain(next_page_id, window_size_, next_page_id_);
+  pages_until_refill_ = std::max<size_t>(window_size_ / 2, 1) - 1;
+}
+
+}  // namespace bustub
@@ -0,0 +1,62 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer.cpp
+//
+// Identification: src/buffer/replacer.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/replacer.h"
+
+#include "buffer/arc_replacer.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/two_queue_replacer.h"
+#include "common/util/string_util.h"
+
+namespace bustub {
+
+auto ReplacerPolicyToString(ReplacerPolicy policy) -> std::string {
+  switch (policy) {
+    case ReplacerPolicy::LRUK:
+      return "lru_k";
+    case ReplacerPolicy::Clock:
+      return "clock";
+    case ReplacerPolicy::TwoQ:
+      return "2q";
+    case ReplacerPolicy::ARC:
+      return "arc";
+  }
+  return "unknown";
+}
+
+auto ParseReplacerPolicy(const std::string &name, ReplacerPolicy *policy) -> bool {
+  auto lower = StringUtil::Lower(name);
+  for (auto candidate : {ReplacerPolicy::LRUK, ReplacerPolicy::Clock, ReplacerPolicy::TwoQ, ReplacerPolicy::ARC}) {
+    if (lower == ReplacerPolicyToString(candidate)) {
+      *policy = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+auto MakeReplacer(ReplacerPolicy policy, size_t num_frames, size_t k) -> std::unique_ptr<Replacer> {
+  switch (policy) {
+    case ReplacerPolicy::Clock:
+      return std::make_unique<ClockReplacer>(num_frames);
+    case ReplacerPolicy::TwoQ:
+      return std::make_unique<TwoQReplacer>(num_frames);
+    case ReplacerPolicy::ARC:
+      return std::make_unique<ARCReplacer>(num_frames);
+    case ReplacerPolicy::LRUK:
+      break;
+  }
+  return std::make_unique<LRUKReplacer>(num_frames, k);
+}
+
+}  // namespace bustub
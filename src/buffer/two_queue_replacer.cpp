@@ -0,0 +1,182 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.cpp
+//
+// Identification: src/buffer/two_queue_replacer.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_queue_replacer.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+TwoQReplacer::TwoQReplacer(size_t num_frames)
+    : num_frames_(num_frames), frames_(num_frames), a1in_(num_frames), am_(num_frames) {
+  SetLimits();
+}
+
+auto TwoQReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto victims = PickVictims(1);
+  if (victims.empty()) {
+    return false;
+  }
+  auto &frame = frames_[victims[0]];
+  if (frame.queue_ == Queue::A1In) {
+    a1in_.Erase(victims[0]);
+    if (frame.referenced_ && frame.page_id_ != INVALID_PAGE_ID) {
+      a1out_.PushFront(frame.page_id_);
+      if (a1out_.Size() > kout_) {
+        a1out_.PopBack();
+      }
+    }
+  } else {
+    am_.Erase(victims[0]);
+  }
+  frame = Frame{};
+  size_--;
+  *frame_id = victims[0];
+  return true;
+}
+
+void TwoQReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  std::lock_guard<std::mutex> guard(latch_);
+  CheckFrameId(frame_id);
+  auto &frame = frames_[frame_id];
+  bool reuse = access_type != AccessType::Scan && access_type != AccessType::Prefetch;
+  switch (frame.queue_) {
+    case Queue::None: {
+      // the page was just loaded into the frame
+      bool remembered = frame.page_id_ != INVALID_PAGE_ID && a1out_.Contains(frame.page_id_);
+      if (remembered) {
+        a1out_.Erase(frame.page_id_);
+      }
+      if (remembered && reuse) {
+        frame.queue_ = Queue::Am;
+        am_.PushFront(frame_id);
+      } else {
+        frame.queue_ = Queue::A1In;
+        a1in_.PushFront(frame_id);
+      }
+      frame.referenced_ = reuse;
+      break;
+    }
+    case Queue::A1In:
+      // a correlated reference, which does not move the frame
+      frame.referenced_ |= reuse;
+      break;
+    case Queue::Am:
+      if (reuse) {
+        am_.MoveToFront(frame_id);
+      }
+      break;
+  }
+}
+
+void TwoQReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::lock_guard<std::mutex> guard(latch_);
+  CheckFrameId(frame_id);
+  auto &frame = frames_[frame_id];
+  if (frame.queue_ == Queue::None || frame.evictable_ == set_evictable) {
+    return;
+  }
+  frame.evictable_ = set_evictable;
+  if (set_evictable) {
+    size_++;
+  } else {
+    size_--;
+  }
+}
+
+void TwoQReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  CheckFrameId(frame_id);
+  auto &frame = frames_[frame_id];
+  if (frame.queue_ == Queue::None) {
+    return;
+  }
+  BUSTUB_ENSURE(frame.evictable_, "cannot remove a non-evictable frame");
+  if (frame.queue_ == Queue::A1In) {
+    a1in_.Erase(frame_id);
+  } else {
+    am_.Erase(frame_id);
+  }
+  frame = Frame{};
+  size_--;
+}
+
+auto TwoQReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> guard(latch_);
+  return size_;
+}
+
+auto TwoQReplacer::EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> guard(latch_);
+  return PickVictims(max_frames);
+}
+
+void TwoQReplacer::Resize(size_t num_frames) {
+  std::lock_guard<std::mutex> guard(latch_);
+  for (auto frame_id = num_frames; frame_id < num_frames_; frame_id++) {
+    BUSTUB_ENSURE(frames_[frame_id].queue_ == Queue::None, "cannot drop a tracked frame");
+  }
+  num_frames_ = num_frames;
+  frames_.resize(num_frames);
+  a1in_.Resize(num_frames);
+  am_.Resize(num_frames);
+  SetLimits();
+}
+
+void TwoQReplacer::SetPage(frame_id_t frame_id, page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  CheckFrameId(frame_id);
+  frames_[frame_id].page_id_ = page_id;
+}
+
+void TwoQReplacer::CheckFrameId(frame_id_t frame_id) const {
+  BUSTUB_ENSURE(frame_id >= 0 && static_cast<size_t>(frame_id) < num_frames_, "invalid frame id");
+}
+
+auto TwoQReplacer::NextEvictable(const FrameList &queue, frame_id_t frame_id) const -> frame_id_t {
+  while (frame_id != FrameList::NONE && !frames_[frame_id].evictable_) {
+    frame_id = queue.Prev(frame_id);
+  }
+  return frame_id;
+}
+
+auto TwoQReplacer::PickVictims(size_t max_frames) const -> std::vector<frame_id_t> {
+  std::vector<frame_id_t> victims;
+  auto a1in_size = a1in_.Size();
+  auto a1in_next = NextEvictable(a1in_, a1in_.Back());
+  auto am_next = NextEvictable(am_, am_.Back());
+  while (victims.size() < max_frames && (a1in_next != FrameList::NONE || am_next != FrameList::NONE)) {
+    // fall back to the other queue when the one whose turn it is has nothing evictable
+    if (a1in_next != FrameList::NONE && (a1in_size > kin_ || am_next == FrameList::NONE)) {
+      victims.push_back(a1in_next);
+      a1in_size--;
+      a1in_next = NextEvictable(a1in_, a1in_.Prev(a1in_next));
+    } else {
+      victims.push_back(am_next);
+      am_next = NextEvictable(am_, am_.Prev(am_next));
+    }
+  }
+  return victims;
+}
+
+void TwoQReplacer::SetLimits() {
+  kin_ = std::max<size_t>(1, num_frames_ / 4);
+  kout_ = std::max<size_t>(1, num_frames_ / 2);
+  while (a1out_.Size() > kout_) {
+    a1out_.PopBack();
+  }
+}
+
+}  // namespace bustub
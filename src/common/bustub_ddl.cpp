@@ -5,6 +5,8 @@
 #include <shared_mutex>
 #include <string>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 #include "binder/binder.h"
 #include "binder/bound_expression.h"
@@ -40,6 +42,13 @@
 
 namespace bustub {
 
+/** The names of the tablespace policies, as SET and SHOW tablespaces take them. */
+static const std::vector<std::pair<std::string, TablespacePolicy>> TABLESPACE_POLICIES = {
+    {"shared", TablespacePolicy::Shared},
+    {"per_table", TablespacePolicy::PerTable},
+    {"per_object", TablespacePolicy::PerObject},
+};
+
 void BustubInstance::HandleCreateStatement(Transaction *txn, const CreateStatement &stmt, ResultWriter &writer) {
   std::unique_lock<std::shared_mutex> l(catalog_lock_);
   auto info = catalog_->CreateTable(txn, stmt.table_, Schema(stmt.columns_));
@@ -127,12 +136,49 @@ void BustubInstance::HandleExplainStatement(Transaction *txn, const ExplainState
 
 void BustubInstance::HandleVariableShowStatement(Transaction *txn, const VariableShowStatement &stmt,
                                                  ResultWriter &writer) {
+  if (StringUtil::Lower(stmt.variable_) == "buffer_pool") {
+    CmdDisplayBufferPool(writer);
+    return;
+  }
+  if (StringUtil::Lower(stmt.variable_) == "replacer") {
+    WriteOneCell(fmt::format("{}={}", stmt.variable_,
+                             ReplacerPolicyToString(buffer_pool_manager_->GetReplacerPolicy())),
+                 writer);
+    return;
+  }
+  if (StringUtil::Lower(stmt.variable_) == "tablespaces") {
+    std::shared_lock<std::shared_mutex> l(catalog_lock_);
+    for (const auto &[name, policy] : TABLESPACE_POLICIES) {
+      if (policy == catalog_->GetTablespacePolicy()) {
+        WriteOneCell(fmt::format("{}={}", stmt.variable_, name), writer);
+      }
+    }
+    return;
+  }
   auto content = GetSessionVariable(stmt.variable_);
   WriteOneCell(fmt::format("{}={}", stmt.variable_, content), writer);
 }
 
 void BustubInstance::HandleVariableSetStatement(Transaction *txn, const VariableSetStatement &stmt,
                                                 ResultWriter &writer) {
+  if (StringUtil::Lower(stmt.variable_) == "replacer") {
+    ReplacerPolicy policy;
+    if (!ParseReplacerPolicy(stmt.value_, &policy)) {
+      throw Exception(fmt::format("unknown replacer {}, expected lru_k, clock, 2q or arc", stmt.value_));
+    }
+    buffer_pool_manager_->SetReplacerPolicy(policy);
+    return;
+  }
+  if (StringUtil::Lower(stmt.variable_) == "tablespaces") {
+    for (const auto &[name, policy] : TABLESPACE_POLICIES) {
+      if (StringUtil::Lower(stmt.value_) == name) {
+        std::unique_lock<std::shared_mutex> l(catalog_lock_);
+        catalog_->SetTablespacePolicy(policy);
+        return;
+      }
+    }
+    throw Exception(fmt::format("unknown tablespaces {}, expected shared, per_table or per_object", stmt.value_));
+  }
   session_variables_[stmt.variable_] = stmt.value_;
 }
 
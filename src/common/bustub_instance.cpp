@@ -34,6 +34,7 @@
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_manager_tablespaces.h"
 #include "type/value_factory.h"
 
 namespace bustub {
@@ -42,11 +43,12 @@ auto BustubInstance::MakeExecutorContext(Transaction *txn, bool is_modify) -> st
   return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_, is_modify);
 }
 
-BustubInstance::BustubInstance(const std::string &db_file_name) {
+BustubInstance::BustubInstance(const std::string &db_file_name, size_t page_size) {
   enable_logging = false;
 
   // Storage related.
-  disk_manager_ = new DiskManager(db_file_name);
+  // tables and indexes can get files of their own, see SET tablespaces
+  disk_manager_ = new DiskManagerTablespaces(db_file_name, page_size);
 
   // Log related.
   log_manager_ = new LogManager(disk_manager_);
@@ -60,6 +62,14 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
     buffer_pool_manager_ = nullptr;
   }
 
+#ifndef __EMSCRIPTEN__
+  if (buffer_pool_manager_ != nullptr) {
+    buffer_pool_manager_->StartPageCleaner();
+    // read back what was cached before the last shutdown, and remember what is cached at the next one
+    buffer_pool_manager_->EnableWarmRestart(db_file_name + ".hot");
+  }
+#endif
+
   // Transaction (txn) related.
 
   lock_manager_ = new LockManager();
@@ -100,6 +110,12 @@ BustubInstance::BustubInstance() {
     buffer_pool_manager_ = nullptr;
   }
 
+#ifndef __EMSCRIPTEN__
+  if (buffer_pool_manager_ != nullptr) {
+    buffer_pool_manager_->StartPageCleaner();
+  }
+#endif
+
   // Transaction (txn) related.
 
   lock_manager_ = new LockManager();
@@ -163,6 +179,22 @@ void BustubInstance::CmdDisplayIndices(ResultWriter &writer) {
   writer.EndTable();
 }
 
+void BustubInstance::CmdDisplayBufferPool(ResultWriter &writer) {
+  auto stats = buffer_pool_manager_->GetStats();
+  writer.BeginTable(false);
+  writer.BeginHeader();
+  writer.WriteHeaderCell("name");
+  writer.WriteHeaderCell("value");
+  writer.EndHeader();
+  for (const auto &[name, value] : stats.ToRows()) {
+    writer.BeginRow();
+    writer.WriteCell(name);
+    writer.WriteCell(value);
+    writer.EndRow();
+  }
+  writer.EndTable();
+}
+
 void BustubInstance::WriteOneCell(const std::string &cell, ResultWriter &writer) {
   writer.BeginTable(true);
   writer.BeginRow();
@@ -176,6 +208,10 @@ void BustubInstance::CmdDisplayHelp(ResultWriter &writer) {
 
 \dt: show all tables
 \di: show all indices
+\dbp: show buffer pool statistics, same as `show buffer_pool`
+`set replacer = 'arc'`: switch the buffer pool to another replacement policy: lru_k, clock, 2q or arc
+`set tablespaces = 'per_table'`: give the tables and indexes created from now on files of their own: shared, per_table
+  or per_object; `show tablespaces` shows the current choice
 \help: show this message again
 
 BusTub shell currently only supports a small set of Postgres queries. We'll set
@@ -216,6 +252,10 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       CmdDisplayIndices(writer);
       return true;
     }
+    if (sql == "\\dbp") {
+      CmdDisplayBufferPool(writer);
+      return true;
+    }
     if (sql == "\\help") {
       CmdDisplayHelp(writer);
       return true;
@@ -0,0 +1,192 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz_codec.cpp
+//
+// Identification: src/common/util/lz_codec.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/lz_codec.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+namespace {
+
+/** log2 of the number of hash table entries. */
+constexpr size_t HASH_BITS = 12;
+/** The farthest back a match can be. */
+constexpr size_t MAX_OFFSET = 65535;
+/** The largest value of a nibble; it means the length continues in the following bytes. */
+constexpr size_t NIBBLE_MAX = 15;
+
+auto Read32(const char *p) -> uint32_t {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+auto Read64(const char *p) -> uint64_t {
+  uint64_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+auto Hash(uint32_t sequence) -> size_t { return (sequence * 2654435761U) >> (32 - HASH_BITS); }
+
+/** Append the continuation bytes of a length whose nibble is NIBBLE_MAX. */
+auto PutLength(char **op, const char *op_end, size_t length) -> bool {
+  length -= NIBBLE_MAX;
+  while (length >= 255) {
+    if (*op == op_end) {
+      return false;
+    }
+    *(*op)++ = static_cast<char>(255);
+    length -= 255;
+  }
+  if (*op == op_end) {
+    return false;
+  }
+  *(*op)++ = static_cast<char>(length);
+  return true;
+}
+
+/** Add the continuation bytes of a length whose nibble is NIBBLE_MAX to length. */
+auto GetLength(const uint8_t **ip, const uint8_t *ip_end, size_t *length) -> bool {
+  uint8_t byte;
+  do {
+    if (*ip == ip_end) {
+      return false;
+    }
+    byte = *(*ip)++;
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+/** Append a sequence. A match_length of 0 makes it the last, literal-only sequence. */
+auto PutSequence(char **op, const char *op_end, const char *literals, size_t num_literals, size_t offset,
+                 size_t match_length) -> bool {
+  if (*op == op_end) {
+    return false;
+  }
+  auto literal_nibble = std::min(num_literals, NIBBLE_MAX);
+  auto match_nibble = match_length == 0 ? 0 : std::min(match_length - LzCodec::MIN_MATCH, NIBBLE_MAX);
+  *(*op)++ = static_cast<char>(literal_nibble << 4 | match_nibble);
+  if (literal_nibble == NIBBLE_MAX && !PutLength(op, op_end, num_literals)) {
+    return false;
+  }
+  if (static_cast<size_t>(op_end - *op) < num_literals) {
+    return false;
+  }
+  memcpy(*op, literals, num_literals);
+  *op += num_literals;
+  if (match_length == 0) {
+    return true;
+  }
+  if (op_end - *op < 2) {
+    return false;
+  }
+  *(*op)++ = static_cast<char>(offset & 0xff);
+  *(*op)++ = static_cast<char>(offset >> 8);
+  return match_nibble < NIBBLE_MAX || PutLength(op, op_end, match_length - LzCodec::MIN_MATCH);
+}
+
+}  // namespace
+
+auto LzCodec::Compress(const char *src, size_t size, char *dst, size_t capacity) -> size_t {
+  BUSTUB_ASSERT(size <= MAX_INPUT_SIZE, "input too large");
+  // position + 1 of the last occurrence of every hashed 4-byte sequence, 0 for none
+  uint32_t table[1 << HASH_BITS] = {};
+  char *op = dst;
+  const char *op_end = dst + capacity;
+  size_t anchor = 0;
+  size_t pos = 0;
+  while (pos + MIN_MATCH <= size) {
+    auto sequence = Read32(src + pos);
+    auto &entry = table[Hash(sequence)];
+    size_t candidate = entry;
+    entry = static_cast<uint32_t>(pos + 1);
+    if (candidate == 0 || pos + 1 - candidate > MAX_OFFSET || Read32(src + candidate - 1) != sequence) {
+      // step faster through data that does not compress
+      pos += 1 + ((pos - anchor) >> 6);
+      continue;
+    }
+    candidate--;
+    size_t length = MIN_MATCH;
+    // eight bytes at a time, then byte by byte for the tail
+    while (pos + length + 8 <= size && Read64(src + candidate + length) == Read64(src + pos + length)) {
+      length += 8;
+    }
+    while (pos + length < size && src[candidate + length] == src[pos + length]) {
+      length++;
+    }
+    if (!PutSequence(&op, op_end, src + anchor, pos - anchor, pos - candidate, length)) {
+      return 0;
+    }
+    pos += length;
+    anchor = pos;
+  }
+  if (!PutSequence(&op, op_end, src + anchor, size - anchor, 0, 0)) {
+    return 0;
+  }
+  return op - dst;
+}
+
+auto LzCodec::Decompress(const char *src, size_t size, char *dst, size_t dst_size) -> bool {
+  const auto *ip = reinterpret_cast<const uint8_t *>(src);
+  const auto *ip_end = ip + size;
+  char *op = dst;
+  const char *op_end = dst + dst_size;
+  while (ip != ip_end) {
+    auto token = *ip++;
+    size_t num_literals = token >> 4;
+    if (num_literals == NIBBLE_MAX && !GetLength(&ip, ip_end, &num_literals)) {
+      return false;
+    }
+    if (num_literals > static_cast<size_t>(ip_end - ip) || num_literals > static_cast<size_t>(op_end - op)) {
+      return false;
+    }
+    memcpy(op, ip, num_literals);
+    op += num_literals;
+    ip += num_literals;
+    if (ip == ip_end) {
+      // the last sequence
+      return op == op_end;
+    }
+    if (ip_end - ip < 2) {
+      return false;
+    }
+    size_t offset = ip[0] | static_cast<size_t>(ip[1]) << 8;
+    ip += 2;
+    size_t length = token & NIBBLE_MAX;
+    if (length == NIBBLE_MAX && !GetLength(&ip, ip_end, &length)) {
+      return false;
+    }
+    length += MIN_MATCH;
+    if (offset == 0 || offset > static_cast<size_t>(op - dst) || length > static_cast<size_t>(op_end - op)) {
+      return false;
+    }
+    // A match may overlap the bytes it produces. Whatever was copied so far repeats the match, so copy it in chunks
+    // that do not overlap, each one as large as everything before it.
+    const char *match = op - offset;
+    for (size_t copied = 0; copied < length;) {
+      auto chunk = std::min(offset + copied, length - copied);
+      memcpy(op + copied, match, chunk);
+      copied += chunk;
+    }
+    op += length;
+  }
+  return false;
+}
+
+}  // namespace bustub
@@ -27,12 +27,13 @@ void SeqScanExecutor::Init() {
 
 auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   while (!iterator_->IsEnd()) {
+    // the iterator reads its pages with AccessType::Scan, so the scan does not evict the working set
     auto [meta, tuple_] = iterator_->GetTuple();
     if (meta.is_deleted_) {
       ++(*iterator_);
       continue;
     }
-    *tuple = iterator_->GetTuple().second;
+    *tuple = std::move(tuple_);
     *rid = iterator_->GetRID();
     ++(*iterator_);
     return true;
@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "buffer/replacer_lists.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ARCReplacer implements the Adaptive Replacement Cache policy (Megiddo and Modha, FAST 2003).
+ *
+ * Frames are kept in two LRU lists: T1 holds pages used once since they were loaded, T2 pages used at least twice.
+ * The pages evicted from each list are remembered in a ghost list, B1 and B2, of page ids. The replacer keeps a target
+ * size p for T1 and evicts from T1 while T1 is larger than p, and from T2 otherwise. Loading a page that B1 still
+ * remembers means T1 was too small, so p grows; loading a page from B2 shrinks it. Either way the page goes to T2.
+ * Like in the paper, T1 plus B1 remember at most as many pages as there are frames, and all four lists twice that.
+ *
+ * Scan and prefetch accesses do not count as uses: they never move a frame, and a page that was only scanned or
+ * prefetched is not remembered in B1. The first real use of such a page moves it to the front of T1, the second one
+ * to T2.
+ *
+ * Pinned frames stay in their list and are skipped by Evict, which walks each list from its cold end. The paper breaks
+ * the tie at |T1| = p in favor of the page being loaded, which the replacer does not know about when it evicts; here
+ * T2 is evicted from. A latch serializes every call.
+ */
+class ARCReplacer : public Replacer {
+ public:
+  /**
+   * @brief Create a new ARCReplacer.
+   * @param num_frames the number of frames the replacer manages
+   */
+  explicit ARCReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ARCReplacer);
+
+  ~ARCReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  auto EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> override;
+
+  /** @brief Throws if a frame that is dropped is still tracked. The ghost lists and p follow the new size. */
+  void Resize(size_t num_frames) override;
+
+  /** @brief The page is looked up in B1 and B2 on its first recorded access. */
+  void SetPage(frame_id_t frame_id, page_id_t page_id) override;
+
+  /** @return the current target size of T1 */
+  auto GetTarget() -> size_t;
+
+ private:
+  /** The list a frame is in. */
+  enum class List : uint8_t { None = 0, T1, T2 };
+
+  /** What the replacer knows about a frame. */
+  struct Frame {
+    List list_{List::None};
+    bool evictable_{false};
+    /** Whether the page had an access other than a scan or prefetch since it was loaded. */
+    bool referenced_{false};
+    page_id_t page_id_{INVALID_PAGE_ID};
+  };
+
+  /** Throws if frame_id is not managed by this replacer. */
+  void CheckFrameId(frame_id_t frame_id) const;
+
+  /** @return the first evictable frame of the list walking from frame_id towards the front, or FrameList::NONE */
+  auto NextEvictable(const FrameList &list, frame_id_t frame_id) const -> frame_id_t;
+
+  /** @return up to max_frames evictable frames in eviction order */
+  auto PickVictims(size_t max_frames) const -> std::vector<frame_id_t>;
+
+  /** Forget the oldest ghosts until the lists are within their bounds. */
+  void TrimGhosts();
+
+  size_t num_frames_;
+  /** Target size of T1, between 0 and num_frames_. */
+  size_t target_{0};
+  /** Number of evictable frames. */
+  size_t size_{0};
+  std::vector<Frame> frames_;
+  FrameList t1_;
+  FrameList t2_;
+  GhostList b1_;
+  GhostList b2_;
+  std::mutex latch_;
+};
+
+}  // namespace bustub
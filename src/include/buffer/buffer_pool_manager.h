@@ -12,11 +12,18 @@
 
 #pragma once
 
-#include <list>
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
 #include <memory>
 #include <mutex>  // NOLINT
-#include <unordered_map>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/frame_arena.h"
 #include "buffer/lru_k_replacer.h"
 #include "common/config.h"
 #include "recovery/log_manager.h"
@@ -26,8 +33,38 @@
 
 namespace bustub {
 
+class DiskManagerMmap;
+
+/** Reads the id of the next page in a chain of pages (table heap pages, B+ tree leaves) from the data of a page. */
+using NextPageIdFn = std::function<page_id_t(const char *data)>;
+
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ *
+ * The frames are partitioned into one or more BufferPoolManagerInstances, each with its own page table, free list,
+ * replacer and latch. A page always lives in the instance `page_id % num_instances`, so requests for different pages
+ * mostly take different latches.
+ *
+ * The data of all frames is carved out of a single FrameArena, while the Page objects holding the frame metadata sit
+ * in a separate array. Frames added by Resize come from an arena and array of their own.
+ *
+ * Prefetches go through a DiskScheduler shared by the instances, so that the prefetch thread has many reads in flight
+ * at once and neighbouring pages are read in one I/O. A fetch that misses reads the page on its own thread instead,
+ * since it has to wait for the page anyway.
+ *
+ * An optional page cleaner thread writes back dirty pages ahead of eviction, see StartPageCleaner. A prefetch thread
+ * reads in the pages passed to Prefetch. After a restart, a warm-up thread can read back the pages that were cached
+ * before, see EnableWarmRestart.
+ *
+ * With a compressed cache, pages evicted from any instance are kept compressed in a second tier of bounded size, and
+ * misses are served from there before going to disk. See CompressedPageCache.
+ *
+ * On a DiskManagerMmap, the buffer pool is read-only: FetchPageRead and FetchPageOptimistic hand out guards that point
+ * into the mapping of the file, without a frame, a latch or a replacer. FetchPage still copies a page into a frame for
+ * whoever needs a Page. NewPage, FetchPageWrite and DeletePage throw.
+ *
+ * On a DiskManagerTablespaces, NewPage can create a page in a tablespace of its own, and DropTablespace drops every
+ * page of a tablespace at once, see CreateTablespace.
  */
 class BufferPoolManager {
  public:
@@ -37,9 +74,15 @@ class BufferPoolManager {
    * @param disk_manager the disk manager
    * @param replacer_k the lookback constant k for the LRU-K replacer
    * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param num_instances the number of partitions the pool_size frames are split into
+   * @param replacer_policy the replacement policy of every instance
+   * @param huge_pages how the memory of the frames is backed
+   * @param compressed_cache_size the size in bytes of the compressed cache below the buffer pool, 0 for none
    */
   BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
-                    LogManager *log_manager = nullptr);
+                    LogManager *log_manager = nullptr, size_t num_instances = 1,
+                    ReplacerPolicy replacer_policy = ReplacerPolicy::LRUK,
+                    HugePagePolicy huge_pages = HugePagePolicy::Transparent, size_t compressed_cache_size = 0);
 
   /**
    * @brief Destroy an existing BufferPoolManager.
@@ -47,11 +90,20 @@ class BufferPoolManager {
   ~BufferPoolManager();
 
   /** @brief Return the size (number of frames) of the buffer pool. */
-  auto GetPoolSize() -> size_t { return pool_size_; }
+  auto GetPoolSize() -> size_t { return pool_size_.load(std::memory_order_acquire); }
 
-  /** @brief Return the pointer to all the pages in the buffer pool. */
+  /** @brief Return the size of every page in bytes, which is the page size of the database file. */
+  auto GetPageSize() -> size_t { return page_size_; }
+
+  /** @brief Return the pointer to the pages the buffer pool was created with. Frames added by Resize are not here. */
   auto GetPages() -> Page * { return pages_; }
 
+  /** @brief Return how the memory of the frames is actually backed. */
+  auto GetHugePagePolicy() -> HugePagePolicy { return frame_arena_.GetHugePagePolicy(); }
+
+  /** @brief Return the number of instances the buffer pool is partitioned into. */
+  auto GetNumInstances() -> size_t { return instances_.size(); }
+
   /**
    * TODO(P1): Add implementation
    *
@@ -67,9 +119,10 @@ class BufferPoolManager {
    * Also, remember to record the access history of the frame in the replacer for the lru-k algorithm to work.
    *
    * @param[out] page_id id of created page
+   * @param tablespace the tablespace to create the page in
    * @return nullptr if no new pages could be created, otherwise pointer to new page
    */
-  auto NewPage(page_id_t *page_id) -> Page *;
+  auto NewPage(page_id_t *page_id, tablespace_id_t tablespace = DEFAULT_TABLESPACE) -> Page *;
 
   /**
    * TODO(P1): Add implementation
@@ -81,9 +134,10 @@ class BufferPoolManager {
    * BasicPageGuard structure.
    *
    * @param[out] page_id, the id of the new page
+   * @param tablespace the tablespace to create the page in
    * @return BasicPageGuard holding a new page
    */
-  auto NewPageGuarded(page_id_t *page_id) -> BasicPageGuard;
+  auto NewPageGuarded(page_id_t *page_id, tablespace_id_t tablespace = DEFAULT_TABLESPACE) -> BasicPageGuard;
 
   /**
    * TODO(P1): Add implementation
@@ -99,7 +153,8 @@ class BufferPoolManager {
    * In addition, remember to disable eviction and record the access history of the frame like you did for NewPage().
    *
    * @param page_id id of page to be fetched
-   * @param access_type type of access to the page, only needed for leaderboard tests.
+   * @param access_type type of access to the page. Pages fetched by AccessType::Scan are the first to be evicted and
+   * scans do not promote pages that are already cached, so a large scan cannot flush the working set.
    * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
    */
   auto FetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page *;
@@ -115,11 +170,21 @@ class BufferPoolManager {
    * the returned page already has a read or write latch held, respectively.
    *
    * @param page_id, the id of the page to fetch
+   * @param access_type type of access to the page, see FetchPage
    * @return PageGuard holding the fetched page
    */
-  auto FetchPageBasic(page_id_t page_id) -> BasicPageGuard;
-  auto FetchPageRead(page_id_t page_id) -> ReadPageGuard;
-  auto FetchPageWrite(page_id_t page_id) -> WritePageGuard;
+  auto FetchPageBasic(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> BasicPageGuard;
+  auto FetchPageRead(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> ReadPageGuard;
+  auto FetchPageWrite(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> WritePageGuard;
+
+  /**
+   * @brief Fetch a page for an optimistic read. The page is pinned but not latched, see OptimisticPageGuard.
+   *
+   * @param page_id, the id of the page to fetch
+   * @param access_type type of access to the page, see FetchPage
+   * @return OptimisticPageGuard holding the fetched page
+   */
+  auto FetchPageOptimistic(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> OptimisticPageGuard;
 
   /**
    * TODO(P1): Add implementation
@@ -153,7 +218,8 @@ class BufferPoolManager {
   /**
    * TODO(P1): Add implementation
    *
-   * @brief Flush all the pages in the buffer pool to disk.
+   * @brief Flush all the pages in the buffer pool to disk. The dirty pages of all instances are written in one batch,
+   * see DiskManager::WritePages.
    */
   void FlushAllPages();
 
@@ -172,41 +238,207 @@ class BufferPoolManager {
    */
   auto DeletePage(page_id_t page_id) -> bool;
 
- private:
-  /** Number of pages in the buffer pool. */
-  const size_t pool_size_;
-  /** The next page id to be allocated  */
-  std::atomic<page_id_t> next_page_id_ = 0;
+  /**
+   * @brief Create a tablespace for the pages of one table or index, or a group of them, see DiskManager.
+   * @return the new tablespace, DEFAULT_TABLESPACE if the disk manager keeps every page in the database file
+   */
+  auto CreateTablespace() -> tablespace_id_t;
 
-  /** Array of buffer pool pages. */
-  Page *pages_;
-  /** Pointer to the disk manager. */
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  /** Pointer to the log manager. Please ignore this for P1. */
-  LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
-  /** Replacer to find unpinned pages for replacement. */
-  std::unique_ptr<LRUKReplacer> replacer_;
-  /** List of free frames that don't have any pages on them. */
-  std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
-  std::mutex latch_;
+  /**
+   * @brief Drop a tablespace with every page in it. The cached pages of the tablespace are forgotten without being
+   * written back, and then the disk manager drops the tablespace, e.g. by unlinking its file. Nothing may fetch a page
+   * of the tablespace meanwhile.
+   * @param tablespace the tablespace to drop
+   * @return false if a page of the tablespace is pinned, or the disk manager has no such tablespace; nothing is dropped
+   * or forgotten then
+   */
+  auto DropTablespace(tablespace_id_t tablespace) -> bool;
+
+  /** @return whether a page of the tablespace is pinned, which keeps DropTablespace from dropping it */
+  auto HasPinnedPages(tablespace_id_t tablespace) -> bool;
+
+  /**
+   * @brief Start the page cleaner, a background thread that writes back dirty pages before they reach the front of
+   * the eviction order, so that NewPage and FetchPage rarely have to write a victim themselves.
+   *
+   * Every page_cleaner_interval the cleaner visits each instance. An instance starts cleaning when fewer than
+   * low_watermark of its frames are free or hold clean pages next in line for eviction, and stops once high_watermark
+   * of them do. See BufferPoolManagerInstance::CleanFrames.
+   *
+   * @param low_watermark fraction of the frames of an instance, between 0 and high_watermark
+   * @param high_watermark fraction of the frames of an instance, between low_watermark and 1
+   */
+  void StartPageCleaner(double low_watermark = PAGE_CLEANER_LOW_WATERMARK,
+                        double high_watermark = PAGE_CLEANER_HIGH_WATERMARK);
+
+  /** @brief Stop the page cleaner and wait for it to exit. Does nothing if it is not running. */
+  void StopPageCleaner();
+
+  /**
+   * @brief Change the number of frames of the buffer pool while it is in use. The frames are split among the
+   * instances like in the constructor.
+   *
+   * Growing adds frames to the free lists. Shrinking retires frames: a frame that is unpinned is written back if
+   * needed and given up right away, the others are given up once they are unpinned. Fetches of cached pages go on
+   * during the resize, and no instance latch is held while pages are written. See BufferPoolManagerInstance::Resize.
+   *
+   * @param pool_size the new size of the buffer pool, at least the number of instances
+   */
+  void Resize(size_t pool_size);
+
+  /**
+   * @brief Switch every instance to another replacement policy while the buffer pool is in use. Cached pages stay
+   * cached and are handed over to the new replacers, but their access history is lost. Fetches of cached pages go on
+   * during the switch. See BufferPoolManagerInstance::SetReplacerPolicy.
+   * @param policy the new replacement policy
+   */
+  void SetReplacerPolicy(ReplacerPolicy policy);
+
+  /** @brief Return the replacement policy of the buffer pool. */
+  auto GetReplacerPolicy() -> ReplacerPolicy { return instances_.front()->GetReplacerPolicy(); }
+
+  /**
+   * @brief Return the counters of the buffer pool, summed over all instances: fetch hits and misses, evictions,
+   * write-backs and so on, plus those of the compressed cache. Reading them never blocks the buffer pool.
+   */
+  auto GetStats() -> BufferPoolStats;
+
+  /**
+   * @brief Ask for pages to be read into the buffer pool in the background, without pinning them. Returns right away.
+   *
+   * Pages that are already cached are skipped, and so are pages for which no frame can be freed. Requests are dropped
+   * when more requests than the buffer pool has frames are already waiting. A FetchPage that arrives while the page is
+   * being read waits for that read instead of issuing its own. The reads of the queued pages are scheduled together,
+   * so they overlap and neighbouring pages are read in one I/O.
+   *
+   * Loading a page is recorded with the replacer as an AccessType::Prefetch access, which does not count as a use of
+   * the page.
+   *
+   * @param page_ids the pages that will be needed soon, in the order they will be needed
+   */
+  void Prefetch(std::vector<page_id_t> page_ids);
+
+  /**
+   * @brief Like Prefetch, for a chain of pages whose ids are only known once the page before is in memory. The
+   * prefetch thread reads page_id, then the page it points to, and so on, so the chain is read at the speed of the
+   * disk rather than the speed of whoever walks it.
+   * @param page_id the first page of the chain
+   * @param num_pages how many pages of the chain to read
+   * @param next_page_id reads the id of the next page from a page of the chain
+   */
+  void PrefetchChain(page_id_t page_id, size_t num_pages, NextPageIdFn next_page_id);
+
+  /**
+   * @brief Make the buffer pool survive restarts warm. The pages listed in hot_page_file, if it exists, are read back
+   * in the background while the buffer pool is already in use, and the resident pages are listed there again when the
+   * buffer pool is destroyed.
+   *
+   * The warm-up reads the pages in page id order, WARM_UP_READ_PAGES at a time with runs of consecutive pages in a
+   * single read, see DiskManager::ReadPages. It only fills free frames, so it never evicts a page that was fetched in
+   * the meantime. If the buffer pool is smaller than before, the hottest pages are read.
+   *
+   * @param hot_page_file the sidecar file listing the hot pages, usually next to the database file
+   */
+  void EnableWarmRestart(const std::string &hot_page_file);
+
+  /** @brief Wait until the warm-up started by EnableWarmRestart is done. Returns right away if there is none. */
+  void WaitForWarmUp();
 
   /**
-   * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
-   * @return the id of the allocated page
+   * @brief Write the ids of the resident pages to a file, hottest first as ranked by the replacers, for a later warm
+   * restart. See EnableWarmRestart.
+   * @param hot_page_file the file to write
+   * @return false if the file cannot be written
    */
-  auto AllocatePage() -> page_id_t;
+  auto SaveHotPages(const std::string &hot_page_file) -> bool;
 
   /**
-   * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
-   * @param page_id id of the page to deallocate
+   * @brief Read the pages listed in a file written by SaveHotPages into free frames. This is what the warm-up thread
+   * runs; a missing or damaged file reads nothing.
+   * @param hot_page_file the file to read
+   * @return the number of pages read
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
+  auto LoadHotPages(const std::string &hot_page_file) -> size_t;
+
+ private:
+  /** @throws Exception if the database file is open read-only */
+  void EnsureWritable() const;
+
+  /** @return the instance responsible for page_id */
+  auto GetInstance(page_id_t page_id) -> BufferPoolManagerInstance * {
+    return instances_[static_cast<size_t>(page_id) % instances_.size()].get();
   }
 
-  // TODO(student): You may add additional private members and helper functions
+  /** Number of pages in the buffer pool. */
+  std::atomic<size_t> pool_size_;
+  /** Size of a page, and of every frame, in bytes. */
+  const size_t page_size_;
+  /** Pointer to the disk manager, shared by the instances. */
+  DiskManager *disk_manager_;
+  /** The disk manager if it maps the file read-only, see FetchPageRead; nullptr otherwise. */
+  DiskManagerMmap *mapped_disk_;
+  /** The data of every frame. */
+  FrameArena frame_arena_;
+  /** Array of buffer pool pages, sliced among the instances. */
+  Page *pages_;
+  /** Serializes Resize and SetReplacerPolicy. */
+  std::mutex resize_latch_;
+  /** The data of the frames added by every Resize that grew the pool beyond what it had before. */
+  std::vector<std::unique_ptr<FrameArena>> resize_arenas_;
+  /** The pages of those frames. */
+  std::vector<std::unique_ptr<Page[]>> resize_pages_;
+  /** Queues the prefetch reads of the instances. Outlives them. */
+  std::unique_ptr<DiskScheduler> disk_scheduler_;
+  /** The second cache tier shared by the instances, nullptr for none. Outlives them. */
+  std::unique_ptr<CompressedPageCache> compressed_cache_;
+  /** The partitions of the buffer pool. */
+  std::vector<std::unique_ptr<BufferPoolManagerInstance>> instances_;
+  /** Instance NewPage starts searching from, advanced round-robin to spread new pages evenly. */
+  std::atomic<size_t> next_instance_{0};
+
+  /** The page cleaner loop, run by page_cleaner_thread_ until StopPageCleaner. */
+  void RunPageCleaner(double low_watermark, double high_watermark);
+
+  /** The page cleaner, not joinable when it is not running. */
+  std::thread page_cleaner_thread_;
+  /** Protects page_cleaner_stop_. */
+  std::mutex page_cleaner_latch_;
+  /** Wakes the page cleaner up early when it is asked to stop. */
+  std::condition_variable page_cleaner_cv_;
+  /** Set to ask the page cleaner to exit. */
+  bool page_cleaner_stop_{false};
+
+  /** A chain of num_pages_ pages to prefetch, starting at page_id_. A single page has no next_page_id_. */
+  struct PrefetchRequest {
+    page_id_t page_id_;
+    size_t num_pages_;
+    NextPageIdFn next_page_id_;
+  };
+
+  /** The prefetch loop, run by prefetch_thread_ until the buffer pool is destroyed. */
+  void RunPrefetcher();
+
+  /** Read pages that are not cached into the buffer pool, with all the reads in flight at once. */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids);
+
+  /** Reads the pages queued by Prefetch. */
+  std::thread prefetch_thread_;
+  /** Protects prefetch_queue_ and prefetch_stop_. */
+  std::mutex prefetch_latch_;
+  /** Signalled when pages are queued or the prefetcher should exit. */
+  std::condition_variable prefetch_cv_;
+  /** Requests waiting to be prefetched. */
+  std::deque<PrefetchRequest> prefetch_queue_;
+  /** Set to ask the prefetcher to exit. */
+  bool prefetch_stop_{false};
+
+  /** Where the hot pages are listed on destruction, empty for nowhere. */
+  std::string hot_page_file_;
+  /** Reads back the hot pages after a restart, not joinable when it is not running. */
+  std::thread warm_up_thread_;
+  /** Protects warm_up_thread_. */
+  std::mutex warm_up_latch_;
+  /** Set to make the warm-up stop early. */
+  std::atomic<bool> warm_up_stop_{false};
 };
 }  // namespace bustub
@@ -0,0 +1,364 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_instance.h
+//
+// Identification: src/include/buffer/buffer_pool_manager_instance.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <future>              // NOLINT
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/compressed_page_cache.h"
+#include "buffer/growable_array.h"
+#include "buffer/page_table.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_scheduler.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/** In-flight disk I/O on a frame. The instance latch is not held while a frame is Loading or Writing. */
+enum class FrameIoState { Idle = 0, Loading, Writing };
+
+/**
+ * BufferPoolManagerInstance is one partition of the buffer pool. It owns a slice of the frames together with its own
+ * page table, free list, replacer and latch, so that instances never contend with each other.
+ *
+ * Pages are assigned to instances by page id: instance `i` of `n` only ever allocates and caches page ids with
+ * `page_id % n == i`. BufferPoolManager routes every request to the instance that owns the page.
+ *
+ * Disk reads and dirty write-backs run without the instance latch. While that I/O is in flight the frame is neither
+ * in the free list nor in the replacer, and threads that want the page on that frame wait on the frame's condition
+ * variable instead of the latch.
+ *
+ * Fetching a cached page and unpinning a page do not take the instance latch: they look the page up in the lock-free
+ * page table and then only take the latch of its frame. The frame latch guards the pin count and dirty flag of the
+ * frame. Changing which page a frame holds, or its I/O state, takes both latches, so a thread holding either one sees
+ * a consistent frame. The instance latch is always taken first.
+ *
+ * Dirty pages are written back either in the foreground, by the thread that evicts them, or in the background by
+ * CleanFrames, which the page cleaner of BufferPoolManager calls periodically.
+ *
+ * With a compressed cache, every evicted page is also put there, and a miss takes the page out of it before going to
+ * disk. The compression runs with the latch released, like a write-back.
+ *
+ * Resize changes the number of frames while the instance is in use. Frames are never moved or freed, so a page
+ * pointer handed out stays valid. Shrinking retires the frames at the end: a frame that is pinned or has I/O in
+ * flight keeps its page until it is unpinned and idle, and is retired by the next NewPage, fetch miss, prefetch or
+ * CleanFrames after that. A retired frame gives its memory back to the system and is reused if the instance grows
+ * again.
+ */
+class BufferPoolManagerInstance {
+ public:
+  /**
+   * @brief Creates a new BufferPoolManagerInstance.
+   * @param pool_size the number of frames owned by this instance
+   * @param pages the frames owned by this instance, at least pool_size long (not owned)
+   * @param num_instances total number of instances in the buffer pool
+   * @param instance_index index of this instance in the buffer pool
+   * @param disk_manager the disk manager
+   * @param disk_scheduler the disk scheduler prefetches are read through, shared with the other instances (not owned)
+   * @param replacer_k the lookback constant k for the LRU-K replacer
+   * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param replacer_policy the replacement policy of this instance
+   * @param compressed_cache the cache evicted pages are compressed into, shared with the other instances (not owned);
+   * nullptr for none
+   */
+  BufferPoolManagerInstance(size_t pool_size, Page *pages, uint32_t num_instances, uint32_t instance_index,
+                            DiskManager *disk_manager, DiskScheduler *disk_scheduler,
+                            size_t replacer_k = LRUK_REPLACER_K, LogManager *log_manager = nullptr,
+                            ReplacerPolicy replacer_policy = ReplacerPolicy::LRUK,
+                            CompressedPageCache *compressed_cache = nullptr);
+
+  DISALLOW_COPY_AND_MOVE(BufferPoolManagerInstance);
+
+  ~BufferPoolManagerInstance() = default;
+
+  /** @brief Return the size (number of frames) of this instance. Frames still retiring are not counted. */
+  auto GetPoolSize() -> size_t { return pool_size_.load(std::memory_order_acquire); }
+
+  /** @brief Return the number of frames this instance ever had, retired ones included. */
+  auto GetCapacity() -> size_t { return frames_.Size(); }
+
+  /** @brief Return the number of frames that are beyond the pool size but still hold a page. */
+  auto GetNumRetiringFrames() -> size_t;
+
+  /**
+   * @brief Change the number of frames of this instance. Growing adds frames to the free list, reusing retired ones
+   * first. Shrinking retires the frames at and above pool_size, writing back dirty pages with the latch released.
+   * Must not run concurrently with another Resize.
+   * @param pool_size the new number of frames, at least one
+   * @param pages the frames to add beyond GetCapacity(), at least pool_size - GetCapacity() long if that is positive
+   * (not owned)
+   */
+  void Resize(size_t pool_size, Page *pages);
+
+  /**
+   * @brief Switch to another replacement policy while the instance is in use. The new replacer is published under the
+   * instance latch, then every cached page is registered with it, coldest first as ranked by the old replacer. The
+   * new replacer starts without any access history beyond that. Must not run concurrently with Resize or another
+   * SetReplacerPolicy.
+   * @param policy the new replacement policy; nothing happens if it is the current one
+   */
+  void SetReplacerPolicy(ReplacerPolicy policy);
+
+  /** @brief Return the current replacement policy of this instance. */
+  auto GetReplacerPolicy() -> ReplacerPolicy;
+
+  /** @brief See BufferPoolManager::NewPage. The new page id always belongs to this instance. */
+  auto NewPage(page_id_t *page_id, tablespace_id_t tablespace = DEFAULT_TABLESPACE) -> Page *;
+
+  /** @brief See BufferPoolManager::FetchPage. */
+  auto FetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page *;
+
+  /**
+   * @brief Read a page into a frame without pinning it, unless it is already cached. See BufferPoolManager::Prefetch.
+   * @param page_id the page to read
+   * @return true if the page was read
+   */
+  auto PrefetchPage(page_id_t page_id) -> bool;
+
+  /**
+   * @brief Like PrefetchPage, but return once the read is scheduled, so that many reads can be in flight at once.
+   * @param page_id the page to read
+   * @param[out] frame_id the frame to pass to EndPrefetch once the read is complete
+   * @return a future that is ready once the page is read, or an invalid future if the page is cached or there is no
+   * frame for it
+   */
+  auto StartPrefetch(page_id_t page_id, frame_id_t *frame_id) -> std::future<bool>;
+
+  /**
+   * @brief The first half of PrefetchPage, for reading several pages in one I/O: take a frame for the page and mark it
+   * Loading. Fetchers of the page wait until EndPrefetch.
+   * @param page_id the page to read
+   * @param evict whether a page may be evicted for it, or only a free frame will do
+   * @param[out] frame_id the frame to pass to EndPrefetch
+   * @return the page to read the data into, or nullptr if the page is cached or there is no frame for it
+   */
+  auto BeginPrefetch(page_id_t page_id, bool evict, frame_id_t *frame_id) -> Page *;
+
+  /** @brief The second half of PrefetchPage, once the data of the page has been read. */
+  void EndPrefetch(frame_id_t frame_id);
+
+  /**
+   * @brief Instead of EndPrefetch, when the read of the page failed: forget the page and free the frame. Fetchers
+   * waiting for the page look it up again, and read it themselves.
+   */
+  void AbortLoad(frame_id_t frame_id);
+
+  /**
+   * @brief List the pages in this instance, hottest first: pinned pages, then the others in reverse eviction order.
+   * Pages with I/O in flight are left out.
+   */
+  auto GetResidentPages() -> std::vector<page_id_t>;
+
+  /** @brief See BufferPoolManager::UnpinPage. */
+  auto UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type = AccessType::Unknown) -> bool;
+
+  /** @brief See BufferPoolManager::FlushPage. */
+  auto FlushPage(page_id_t page_id) -> bool;
+
+  /** @brief Flush all the pages of this instance to disk, in one batch. */
+  void FlushAllPages();
+
+  /**
+   * @brief Collect the dirty pages of this instance for a batch write and mark them clean. Until FinishDirtyPages, none
+   * of them is evicted: an unpinned page is marked as being written, like the page cleaner does, and a pinned one is
+   * pinned once more. The instance latch is released before returning, so the write goes on without it.
+   * @param[out] pages the dirty pages are appended here
+   * @return the frames of the pages, for FinishDirtyPages
+   */
+  auto CollectDirtyPages(std::vector<DiskManager::PageWrite> *pages) -> std::vector<frame_id_t>;
+
+  /** @brief Let go of the frames of CollectDirtyPages once their pages are written. */
+  void FinishDirtyPages(const std::vector<frame_id_t> &frames);
+
+  /** @brief See BufferPoolManager::DeletePage. */
+  auto DeletePage(page_id_t page_id) -> bool;
+
+  /** @brief Return whether a page of the tablespace is pinned in this instance. */
+  auto HasPinnedPages(tablespace_id_t tablespace) -> bool;
+
+  /**
+   * @brief Forget every unpinned page of the tablespace without writing it back, for BufferPoolManager::DropTablespace.
+   * Waits for the I/O in flight on them.
+   */
+  void DiscardPages(tablespace_id_t tablespace);
+
+  /**
+   * @brief Write back dirty pages that are next in line for eviction, so that eviction finds clean frames. Nothing is
+   * written while the free frames plus the clean pages at the front of the eviction order add up to at least
+   * low_watermark. Below that, every dirty page among the next high_watermark frames to be used (free frames
+   * included) is written back, in eviction order.
+   * @param low_watermark number of clean frames below which the instance starts cleaning
+   * @param high_watermark number of clean frames the instance cleans up to
+   * @return the number of pages written back
+   */
+  auto CleanFrames(size_t low_watermark, size_t high_watermark) -> size_t;
+
+  /** @brief Return the counters of this instance. */
+  auto GetStats() const -> BufferPoolStats { return stats_.Snapshot(); }
+
+ private:
+  /** Number of frames in use. Frames at and above it are retiring or retired. */
+  std::atomic<size_t> pool_size_;
+  /** How many instances are in the buffer pool. */
+  const uint32_t num_instances_;
+  /** Index of this instance in the buffer pool, and so the stripe of the disk manager it allocates pages in. */
+  const uint32_t instance_index_;
+
+  /** Pointer to the disk manager. */
+  DiskManager *disk_manager_ __attribute__((__unused__));
+  /** Pointer to the disk scheduler for prefetches, shared by the instances. */
+  DiskScheduler *disk_scheduler_;
+  /** Pointer to the log manager. Please ignore this for P1. */
+  LogManager *log_manager_ __attribute__((__unused__));
+  /** The second cache tier below this instance, nullptr for none. */
+  CompressedPageCache *compressed_cache_;
+  /**
+   * Page table for keeping track of buffer pool pages. A frame writing back its old page is also listed under the
+   * page it is being acquired for, so the table may hold up to two entries per frame.
+   */
+  PageTable page_table_;
+  /** The current replacer. */
+  std::unique_ptr<Replacer> replacer_owner_;
+  /**
+   * Replacer to find unpinned pages for replacement, the one owned by replacer_owner_. SetReplacerPolicy swaps it
+   * under the instance latch, so the paths that do not take the instance latch only load it while holding a frame
+   * latch.
+   */
+  std::atomic<Replacer *> replacer_;
+  /** The policy of the current replacer. Protected by the instance latch. */
+  ReplacerPolicy replacer_policy_;
+  /** The lookback constant for LRU-K replacers. */
+  const size_t replacer_k_;
+  /** Number of frames replacer_ was last sized for. */
+  size_t replacer_size_;
+  /** List of free frames that don't have any pages on them. */
+  std::list<frame_id_t> free_list_;
+  /**
+   * Serializes changes to page_table_, free_list_, retiring_, the I/O state and page ids of the frames, and
+   * evictions.
+   */
+  std::mutex latch_;
+
+  /** A frame and what the instance knows about it. */
+  struct Frame {
+    /** The page held by the frame. */
+    Page *page_{nullptr};
+    /** Protects the metadata (not the data) of the page and the I/O state. */
+    std::mutex latch_;
+    /** I/O in flight on the frame. */
+    FrameIoState io_{FrameIoState::Idle};
+    /** Signalled when the I/O on the frame finishes. */
+    std::condition_variable io_cv_;
+    /** Whether the frame was given up by a shrink and is not in use. Protected by the instance latch. */
+    bool retired_{false};
+  };
+
+  /** Every frame this instance ever had. */
+  GrowableArray<Frame> frames_;
+  /** Frames at and above pool_size_ that are not retired yet. */
+  std::vector<frame_id_t> retiring_;
+  /** Hits, misses, evictions and the like. */
+  BufferPoolCounters stats_;
+
+  /**
+   * @brief Find the frame holding page_id, waiting for any I/O in flight on it to finish.
+   * @param page_id the page to look up
+   * @param lock the held instance latch, released while waiting
+   * @param[out] frame_id the frame holding the page
+   * @return false if the page is not in this instance
+   */
+  auto LookupFrame(page_id_t page_id, std::unique_lock<std::mutex> &lock, frame_id_t *frame_id) -> bool;
+
+  /** @brief Return the current replacer. See replacer_ for when it may be used. */
+  auto GetReplacer() -> Replacer * { return replacer_.load(std::memory_order_acquire); }
+
+  /** @brief Lock the instance latch, adding the time spent waiting for it to the stats. */
+  auto LockLatch() -> std::unique_lock<std::mutex>;
+
+  /** @brief Lock the instance latch again after releasing it, adding the time spent waiting for it to the stats. */
+  void LockLatch(std::unique_lock<std::mutex> &lock);
+
+  /**
+   * @brief Mark a frame Idle after its I/O finished, and wake up the threads waiting for it. Caller should acquire the
+   * latch before calling this function.
+   */
+  void FinishFrameIo(frame_id_t frame_id);
+
+  /**
+   * @brief Pick a frame to hold a new page, first from the free list, then from the replacer. A dirty victim is
+   * written back, and with a compressed cache any victim is put there, with the latch released; then the victim is
+   * removed from the page table. A victim pinned by a concurrent fetch
+   * after the replacer picked it is left alone. Caller should acquire the latch before calling this function.
+   * @param lock the held instance latch
+   * @param page_id the page that will occupy the frame, entered into the page table before any I/O so that
+   * concurrent fetchers wait for this frame instead of loading the page a second time; INVALID_PAGE_ID for none
+   * @param[out] frame_id the frame that is now unused
+   * @return false if every frame is pinned
+   */
+  auto AcquireFrame(std::unique_lock<std::mutex> &lock, page_id_t page_id, frame_id_t *frame_id) -> bool;
+
+  /**
+   * @brief Forget the page on an unpinned, idle frame without writing it back, and free or retire the frame. Caller
+   * should acquire the latch before calling this function.
+   * @param frame_id the frame holding the page
+   * @param frame_guard the held latch of the frame, which may be released
+   */
+  void DropPage(frame_id_t frame_id, std::unique_lock<std::mutex> &frame_guard);
+
+  /**
+   * @brief Retire the frames in retiring_ that are unpinned and idle. Dirty pages are written back in one batch with
+   * the latch released. Caller should acquire the latch before calling this function.
+   * @param lock the held instance latch
+   */
+  void RetireFrames(std::unique_lock<std::mutex> &lock);
+
+  /**
+   * @brief Retire a frame: forget its page and give its memory back. The frame must be unpinned, idle and not tracked
+   * by the replacer. Caller should acquire the latch and the frame latch before calling this function.
+   */
+  void ReleaseFrame(frame_id_t frame_id);
+
+  /**
+   * @brief Drop the frames that are retired or back in the pool from retiring_, and size the replacer for the frames
+   * left. Caller should acquire the latch before calling this function.
+   */
+  void UpdateRetiringFrames();
+
+  /**
+   * @brief Allocate a page on disk, congruent to instance_index_ modulo num_instances_. Caller should acquire the latch
+   * before calling this function.
+   * @param[out] reused set to whether the page was freed before, so the disk may hold old data for it
+   * @param tablespace the tablespace to allocate the page in
+   * @return the id of the allocated page
+   */
+  auto AllocatePage(bool *reused, tablespace_id_t tablespace) -> page_id_t;
+
+  /** @brief Check that the page id is one this instance is responsible for. */
+  void ValidatePageId(page_id_t page_id) const;
+
+  /**
+   * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
+   * @param page_id id of the page to deallocate
+   */
+  void DeallocatePage(page_id_t page_id) { disk_manager_->DeallocatePage(page_id); }
+};
+}  // namespace bustub
@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+
+namespace bustub {
+
+/** Number of AccessType values. */
+static constexpr size_t NUM_ACCESS_TYPES = 4;
+
+/** @return the lower-case name of an access type */
+auto AccessTypeToString(AccessType access_type) -> const char *;
+
+/** A copy of the counters of a buffer pool at one point in time, see BufferPoolManager::GetStats. */
+struct BufferPoolStats {
+  /** FetchPage calls served from a frame, by AccessType. */
+  std::array<uint64_t, NUM_ACCESS_TYPES> hits_{};
+  /** Pages read from disk by FetchPage and the prefetcher, by AccessType. */
+  std::array<uint64_t, NUM_ACCESS_TYPES> misses_{};
+  /** Pages evicted to make room for another page. */
+  uint64_t evictions_{0};
+  /** Dirty pages written back by the thread that evicted them. */
+  uint64_t foreground_write_backs_{0};
+  /** Dirty pages written back by the page cleaner. */
+  uint64_t background_write_backs_{0};
+  /** Pages created by NewPage. */
+  uint64_t new_pages_{0};
+  /** Pages deleted by DeletePage. */
+  uint64_t deleted_pages_{0};
+  /** The highest pin count any page reached. */
+  uint64_t max_pin_count_{0};
+  /** Time spent waiting to acquire an instance latch. */
+  std::chrono::nanoseconds latch_wait_{0};
+  /** Size of the memory region of the compressed cache tier, 0 when there is none. */
+  uint64_t compressed_capacity_{0};
+  /** Buffer pool misses served from the compressed cache. */
+  uint64_t compressed_hits_{0};
+  /** Buffer pool misses the compressed cache could not serve, which went to disk. */
+  uint64_t compressed_misses_{0};
+  /** Evicted pages kept by the compressed cache. */
+  uint64_t compressed_stores_{0};
+  /** Evicted pages that did not compress well enough to be kept. */
+  uint64_t compressed_rejects_{0};
+  /** Pages the compressed cache dropped to make room for others. */
+  uint64_t compressed_evictions_{0};
+  /** Size of the pages kept by the compressed cache, before and after compression. */
+  uint64_t compressed_bytes_in_{0};
+  uint64_t compressed_bytes_out_{0};
+  /** Pages in the compressed cache right now, and the memory they take. */
+  uint64_t compressed_pages_{0};
+  uint64_t compressed_memory_{0};
+
+  /** @return fetch hits of every access type */
+  auto Hits() const -> uint64_t;
+
+  /** @return fetch misses of every access type */
+  auto Misses() const -> uint64_t;
+
+  /** @return the fraction of fetches that were hits, 0 without any fetch */
+  auto HitRatio() const -> double;
+
+  /** @return the fraction of buffer pool misses served by the compressed cache, 0 without any */
+  auto CompressedHitRatio() const -> double;
+
+  /** @return the size of the pages kept by the compressed cache divided by their compressed size, 0 without any */
+  auto CompressionRatio() const -> double;
+
+  /** Add up the counters of two instances. */
+  auto operator+=(const BufferPoolStats &other) -> BufferPoolStats &;
+
+  /**
+   * @return what happened since the earlier snapshot; max_pin_count_ stays the overall maximum, and the size and
+   * contents of the compressed cache stay the current ones
+   */
+  auto Since(const BufferPoolStats &earlier) const -> BufferPoolStats;
+
+  /** @return every counter as a (name, value) pair, in display order */
+  auto ToRows() const -> std::vector<std::pair<std::string, std::string>>;
+
+  /** @return a one-line summary */
+  auto ToString() const -> std::string;
+};
+
+/**
+ * The live counters of a buffer pool instance. Every update is a relaxed atomic operation, so neither updating nor
+ * reading the counters ever blocks the buffer pool. A snapshot is therefore not an atomic view of all counters.
+ */
+class BufferPoolCounters {
+ public:
+  void RecordHit(AccessType access_type) { Add(hits_[static_cast<size_t>(access_type)]); }
+  void RecordMiss(AccessType access_type) { Add(misses_[static_cast<size_t>(access_type)]); }
+  void RecordEviction() { Add(evictions_); }
+  void RecordForegroundWriteBack() { Add(foreground_write_backs_); }
+  void RecordBackgroundWriteBacks(uint64_t count) { Add(background_write_backs_, count); }
+  void RecordNewPage() { Add(new_pages_); }
+  void RecordDeletedPage() { Add(deleted_pages_); }
+  void RecordLatchWait(std::chrono::nanoseconds wait) { Add(latch_wait_ns_, static_cast<uint64_t>(wait.count())); }
+
+  void RecordPinCount(uint64_t pin_count) {
+    auto max = max_pin_count_.load(std::memory_order_relaxed);
+    while (pin_count > max && !max_pin_count_.compare_exchange_weak(max, pin_count, std::memory_order_relaxed)) {
+    }
+  }
+
+  /** @return the current value of every counter */
+  auto Snapshot() const -> BufferPoolStats;
+
+ private:
+  static void Add(std::atomic<uint64_t> &counter, uint64_t count = 1) {
+    counter.fetch_add(count, std::memory_order_relaxed);
+  }
+
+  // the hit counters change on every fetch, keep them away from the rest
+  alignas(64) std::array<std::atomic<uint64_t>, NUM_ACCESS_TYPES> hits_{};
+  alignas(64) std::array<std::atomic<uint64_t>, NUM_ACCESS_TYPES> misses_{};
+  std::atomic<uint64_t> evictions_{0};
+  std::atomic<uint64_t> foreground_write_backs_{0};
+  std::atomic<uint64_t> background_write_backs_{0};
+  std::atomic<uint64_t> new_pages_{0};
+  std::atomic<uint64_t> deleted_pages_{0};
+  std::atomic<uint64_t> max_pin_count_{0};
+  std::atomic<uint64_t> latch_wait_ns_{0};
+};
+
+}  // namespace bustub
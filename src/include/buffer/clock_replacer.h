@@ -12,17 +12,27 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
+#include <atomic>
 #include <vector>
 
+#include "buffer/growable_array.h"
 #include "buffer/replacer.h"
 #include "common/config.h"
+#include "common/macros.h"
 
 namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * The replacer takes no latch. Every frame has an atomic state and an atomic reference bit, so recording a hit is
+ * a single store to the reference bit. Evict advances an atomic clock hand over the frames. Evictable frames with the
+ * reference bit set get a second chance: the bit is cleared and the hand moves on. The first evictable frame with a
+ * clear bit is claimed with a compare-and-swap on its state, so concurrent evictions never return the same frame.
+ * AccessType::Scan accesses leave the reference bit alone, so frames used only by a scan are reclaimed first.
+ *
+ * Resize keeps the replacer latch-free: the frames live in a GrowableArray, and shrinking only lowers the number of
+ * frames the hand goes over.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -32,21 +42,55 @@ class ClockReplacer : public Replacer {
    */
   explicit ClockReplacer(size_t num_pages);
 
+  DISALLOW_COPY_AND_MOVE(ClockReplacer);
+
   /**
    * Destroys the ClockReplacer.
    */
   ~ClockReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown) override;
 
-  void Pin(frame_id_t frame_id) override;
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void Remove(frame_id_t frame_id) override;
 
   auto Size() -> size_t override;
 
+  /**
+   * @brief Walk one turn from the hand without moving it. Frames whose reference bit is clear come first, in hand
+   * order, followed by the ones the hand would have to give a second chance.
+   */
+  auto EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> override;
+
+  /** @brief Must not run concurrently with another Resize. Throws if a frame that is dropped is still tracked. */
+  void Resize(size_t num_frames) override;
+
  private:
-  // TODO(student): implement me!
+  /** Frame states. Only Evictable frames are candidates for eviction. */
+  static constexpr uint8_t UNTRACKED = 0;
+  static constexpr uint8_t PINNED = 1;
+  static constexpr uint8_t EVICTABLE = 2;
+
+  /** Throws if frame_id is not managed by this replacer. */
+  void CheckFrameId(frame_id_t frame_id) const;
+
+  /** What the replacer knows about a frame. */
+  struct Frame {
+    std::atomic<uint8_t> state_{UNTRACKED};
+    /** Set on access and cleared by the clock hand. */
+    std::atomic<bool> ref_{false};
+  };
+
+  std::atomic<size_t> num_frames_;
+  /** Every frame the replacer ever managed, which may be more than num_frames_ after shrinking. */
+  GrowableArray<Frame> frames_;
+  /** Monotonic clock hand; the frame it points at is hand_ % num_frames_. */
+  std::atomic<size_t> hand_{0};
+  /** Number of evictable frames. */
+  std::atomic<size_t> size_{0};
 };
 
 }  // namespace bustub
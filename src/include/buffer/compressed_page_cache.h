@@ -0,0 +1,128 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.h
+//
+// Identification: src/include/buffer/compressed_page_cache.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_stats.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * CompressedPageCache is a second cache tier between the buffer pool and the disk. Pages evicted from the buffer pool
+ * are kept here compressed with LzCodec, and a buffer pool miss looks here before reading from disk.
+ *
+ * The cache is exclusive: a page is either in a frame of the buffer pool or here, never both. Only clean pages are
+ * put here, so a cached page always matches the disk and can be dropped at any time. The buffer pool takes a page out
+ * when it reads it back, and erases it whenever it gets the page from elsewhere or deletes it.
+ *
+ * The compressed pages live in one memory region of a fixed size, carved into CHUNK_SIZE chunks. A page takes as many
+ * chunks as it needs, not necessarily adjacent ones, so the region never fragments. When it is full, the least
+ * recently put pages are dropped. A page that does not compress to at most three quarters of its size is not kept,
+ * since it would barely save any memory over keeping it in a frame.
+ *
+ * Compression and decompression run outside the latch, so instances of the buffer pool only serialize on copying
+ * the chunks.
+ */
+class CompressedPageCache {
+ public:
+  /** The unit of memory pages are stored in. */
+  static constexpr size_t CHUNK_SIZE = 256;
+
+  /**
+   * @brief Create a cache.
+   * @param capacity the size of the memory region in bytes, rounded down to whole chunks
+   * @param page_size the size of every page
+   */
+  CompressedPageCache(size_t capacity, size_t page_size);
+
+  DISALLOW_COPY_AND_MOVE(CompressedPageCache);
+
+  ~CompressedPageCache() = default;
+
+  /**
+   * @brief Compress a clean page and keep it, replacing the copy that is already kept, if any.
+   * @param page_id the page
+   * @param data the data of the page, page_size bytes
+   * @return false if the page does not compress well enough and is not kept
+   */
+  auto Put(page_id_t page_id, const char *data) -> bool;
+
+  /**
+   * @brief Take a page out of the cache.
+   * @param page_id the page
+   * @param[out] data where the data of the page goes, page_size bytes
+   * @return false if the page is not cached
+   */
+  auto Take(page_id_t page_id, char *data) -> bool;
+
+  /** @brief Drop a page. Does nothing if it is not cached. */
+  void Erase(page_id_t page_id);
+
+  /** @brief Drop every cached page whose id matches pred. */
+  void EraseIf(const std::function<bool(page_id_t)> &pred);
+
+  /** @brief Add the counters of the cache to stats. Never blocks. */
+  void AddStats(BufferPoolStats *stats);
+
+ private:
+  /** A kept page. */
+  struct Entry {
+    /** The chunks holding the compressed data, in order. */
+    std::vector<uint32_t> chunks_;
+    /** The size of the compressed data. */
+    size_t size_;
+    /** The position of the page in lru_. */
+    std::list<page_id_t>::iterator lru_pos_;
+  };
+
+  /** Give the chunks of a kept page back and forget it. Caller should hold the latch. */
+  void EraseEntry(std::unordered_map<page_id_t, Entry>::iterator it);
+
+  const size_t page_size_;
+  /** Pages that compress to more than this are not kept. */
+  const size_t max_compressed_size_;
+  const size_t num_chunks_;
+  /** The memory region, num_chunks_ chunks. */
+  std::unique_ptr<char[]> region_;
+
+  /** Protects entries_, lru_, free_chunks_ and the chunks of region_ that hold pages. */
+  std::mutex latch_;
+  std::unordered_map<page_id_t, Entry> entries_;
+  /** Kept pages, most recently put first. */
+  std::list<page_id_t> lru_;
+  /** Chunks not holding any page. */
+  std::vector<uint32_t> free_chunks_;
+
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> stores_{0};
+  std::atomic<uint64_t> rejects_{0};
+  std::atomic<uint64_t> evictions_{0};
+  std::atomic<uint64_t> bytes_in_{0};
+  std::atomic<uint64_t> bytes_out_{0};
+  /** Number of kept pages. */
+  std::atomic<uint64_t> pages_{0};
+  /** Number of chunks holding a page. */
+  std::atomic<uint64_t> used_chunks_{0};
+};
+
+}  // namespace bustub
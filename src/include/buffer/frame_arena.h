@@ -0,0 +1,78 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/** How the memory of the buffer pool frames is backed. */
+enum class HugePagePolicy {
+  /** Regular pages. */
+  None = 0,
+  /** Ask the kernel to back the arena with transparent huge pages where it can. */
+  Transparent,
+  /** Reserve explicit huge pages (hugetlbfs), falling back to transparent huge pages if none are available. */
+  Explicit
+};
+
+/**
+ * FrameArena holds the data of every frame of a buffer pool in one contiguous, page-aligned mapping, so that frames
+ * are suitable for direct I/O and a large pool is covered by few TLB entries when huge pages are available.
+ *
+ * The memory is mapped lazily and zeroed by the kernel, so creating even a very large arena costs almost nothing.
+ *
+ * In AddressSanitizer builds every frame is followed by a poisoned gap of the same size, so that running off the end
+ * of a page is still reported instead of silently corrupting the next frame.
+ */
+class FrameArena {
+ public:
+  /**
+   * @brief Map the arena.
+   * @param num_frames number of frames
+   * @param frame_size size of a frame in bytes, a multiple of the system page size
+   * @param huge_pages how the arena should be backed
+   * @throws Exception if the memory cannot be mapped
+   */
+  FrameArena(size_t num_frames, size_t frame_size, HugePagePolicy huge_pages = HugePagePolicy::Transparent);
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  ~FrameArena();
+
+  /** @return the data of the frame at index i */
+  auto GetFrame(size_t i) const -> char * { return base_ + i * stride_; }
+
+  /** @return how the arena is actually backed, which may be less than what was asked for */
+  auto GetHugePagePolicy() const -> HugePagePolicy { return huge_pages_; }
+
+  /**
+   * @brief Give the memory of a frame that is no longer used back to the system. The frame stays mapped and reads as
+   * zeros afterwards. Only a hint: memory on huge pages is kept.
+   * @param frame the data of the frame
+   * @param frame_size size of the frame in bytes
+   */
+  static void Discard(char *frame, size_t frame_size);
+
+ private:
+  char *base_{nullptr};
+  /** Length of the mapping in bytes. */
+  size_t length_{0};
+  /** Distance between the start of two consecutive frames. */
+  size_t stride_;
+  HugePagePolicy huge_pages_{HugePagePolicy::None};
+};
+
+}  // namespace bustub
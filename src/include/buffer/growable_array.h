@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// growable_array.h
+//
+// Identification: src/include/buffer/growable_array.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * GrowableArray is an array that can grow while other threads index into it without taking a latch, as the
+ * lock-free paths of the buffer pool do with its frames.
+ *
+ * Elements are allocated in chunks, one per Grow, and never move, so a reference to an element stays valid for the
+ * lifetime of the array. Indexing goes through a table of element pointers. Grow publishes a new table and keeps the
+ * ones it replaces until the array is destroyed, since a reader may still be looking at them. That costs one pointer
+ * per element and Grow.
+ */
+template <class T>
+class GrowableArray {
+ public:
+  /** @brief Create an array of size default-constructed elements. */
+  explicit GrowableArray(size_t size) { Grow(size); }
+
+  DISALLOW_COPY_AND_MOVE(GrowableArray);
+
+  ~GrowableArray() = default;
+
+  /** @return the element at index i, which must be below Size(). Lock-free. */
+  auto operator[](size_t i) const -> T & { return *table_.load(std::memory_order_acquire)[i]; }
+
+  /** @return the number of elements */
+  auto Size() const -> size_t { return size_.load(std::memory_order_acquire); }
+
+  /**
+   * @brief Append default-constructed elements until there are size of them. Does nothing if there already are. Must
+   * not run concurrently with another Grow.
+   */
+  void Grow(size_t size) {
+    auto old_size = size_.load(std::memory_order_relaxed);
+    if (size <= old_size) {
+      return;
+    }
+    auto chunk = std::make_unique<T[]>(size - old_size);
+    auto table = std::make_unique<T *[]>(size);
+    for (size_t i = 0; i < old_size; i++) {
+      table[i] = tables_.back()[i];
+    }
+    for (size_t i = old_size; i < size; i++) {
+      table[i] = &chunk[i - old_size];
+    }
+    // the new elements are fully constructed before anyone can reach them
+    table_.store(table.get(), std::memory_order_release);
+    size_.store(size, std::memory_order_release);
+    tables_.push_back(std::move(table));
+    chunks_.push_back(std::move(chunk));
+  }
+
+ private:
+  /** The current table, the last one of tables_. */
+  std::atomic<T **> table_{nullptr};
+  std::atomic<size_t> size_{0};
+  /** Every table ever published. */
+  std::vector<std::unique_ptr<T *[]>> tables_;
+  /** The elements, one chunk per Grow. */
+  std::vector<std::unique_ptr<T[]>> chunks_;
+};
+
+}  // namespace bustub
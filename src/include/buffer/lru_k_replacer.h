@@ -13,29 +13,15 @@
 #pragma once
 
 #include <limits>
-#include <list>
 #include <mutex>  // NOLINT
-#include <unordered_map>
 #include <vector>
 
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "common/macros.h"
 
 namespace bustub {
 
-enum class AccessType { Unknown = 0, Get, Scan };
-
-class LRUKNode {
- private:
-  /** History of last seen K timestamps of this page. Least recent timestamp stored in front. */
-  // Remove maybe_unused if you start using them. Feel free to change the member variables as you want.
-
-  [[maybe_unused]] std::list<size_t> history_;
-  [[maybe_unused]] size_t k_;
-  [[maybe_unused]] frame_id_t fid_;
-  [[maybe_unused]] bool is_evictable_{false};
-};
-
 /**
  * LRUKReplacer implements the LRU-k replacement policy.
  *
@@ -46,8 +32,22 @@ class LRUKNode {
  * A frame with less than k historical references is given
  * +inf as its backward k-distance. When multipe frames have +inf backward k-distance,
  * classical LRU algorithm is used to choose victim.
+ *
+ * All per-frame state lives in flat arrays indexed by frame_id_t and allocated up front, so
+ * recording an access never allocates. Only evictable frames are kept in an indexed min-heap
+ * ordered by eviction priority; pinned frames are never looked at by Evict. Evict, RecordAccess
+ * and SetEvictable are O(log n) in the number of evictable frames.
+ *
+ * Scan accesses do not count as reuse. A frame that has only been touched by scans sits at the
+ * cold end and is evicted before any other frame, and a scan over a frame that already has a
+ * history leaves that history alone. A large sequential scan therefore recycles its own frames
+ * instead of pushing out the working set.
+ *
+ * A prefetched frame ranks like a frame with a single access, so that prefetched pages do not
+ * push each other out before they are used. Its first real access replaces the prefetch in the
+ * history.
  */
-class LRUKReplacer {
+class LRUKReplacer : public Replacer {
  public:
   /**
    *
@@ -65,7 +65,7 @@ class LRUKReplacer {
    *
    * @brief Destroys the LRUReplacer.
    */
-  ~LRUKReplacer() = default;
+  ~LRUKReplacer() override = default;
 
   /**
    * TODO(P1): Add implementation
@@ -83,7 +83,7 @@ class LRUKReplacer {
    * @param[out] frame_id id of frame that is evicted.
    * @return true if a frame is evicted successfully, false if no frames can be evicted.
    */
-  auto Evict(frame_id_t *frame_id) -> bool;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
   /**
    * TODO(P1): Add implementation
@@ -95,10 +95,10 @@ class LRUKReplacer {
    * also use BUSTUB_ASSERT to abort the process if frame id is invalid.
    *
    * @param frame_id id of frame that received a new access.
-   * @param access_type type of access that was received. This parameter is only needed for
-   * leaderboard tests.
+   * @param access_type type of access that was received. AccessType::Scan accesses are not
+   * recorded as reuse, see the class comment.
    */
-  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown);
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown) override;
 
   /**
    * TODO(P1): Add implementation
@@ -117,7 +117,7 @@ class LRUKReplacer {
    * @param frame_id id of frame whose 'evictable' status will be modified
    * @param set_evictable whether the given frame is evictable or not
    */
-  void SetEvictable(frame_id_t frame_id, bool set_evictable);
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
   /**
    * TODO(P1): Add implementation
@@ -136,7 +136,7 @@ class LRUKReplacer {
    *
    * @param frame_id id of frame to be removed
    */
-  void Remove(frame_id_t frame_id);
+  void Remove(frame_id_t frame_id) override;
 
   /**
    * TODO(P1): Add implementation
@@ -145,23 +145,59 @@ class LRUKReplacer {
    *
    * @return size_t
    */
-  auto Size() -> size_t;
+  auto Size() -> size_t override;
+
+  /**
+   * @brief Return up to max_frames evictable frames in eviction order, without changing anything. Takes
+   * O(n log max_frames) in the number of evictable frames.
+   */
+  auto EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> override;
+
+  /** @brief Resize the per-frame arrays. Throws if a frame that is dropped is still tracked. */
+  void Resize(size_t num_frames) override;
 
  private:
-  // TODO(student): implement me! You can replace these member variables as you like.
-  // Remove maybe_unused if you start using them.
-  [[maybe_unused]] std::unordered_map<frame_id_t, LRUKNode> node_store_;
-  [[maybe_unused]] size_t current_timestamp_{0};
+  /** Throws if frame_id is not managed by this replacer. */
+  void CheckFrameId(frame_id_t frame_id) const;
+
+  /** @return the timestamp the frame is ordered by: its k-th most recent access, or its first if it has fewer. */
+  auto EvictionTimestamp(frame_id_t frame_id) const -> size_t;
+
+  /** @return true if frame a should be evicted before frame b */
+  auto EvictsBefore(frame_id_t a, frame_id_t b) const -> bool;
+
+  /** Heap maintenance. heap_pos_ is kept in sync with heap_. */
+  void HeapPush(frame_id_t frame_id);
+  void HeapErase(frame_id_t frame_id);
+  void HeapFix(size_t pos);
+  void HeapSwap(size_t i, size_t j);
+  auto HeapSiftUp(size_t pos) -> size_t;
+  void HeapSiftDown(size_t pos);
+
+  /** Forget everything about the frame. It must not be in the heap. */
+  void ResetFrame(frame_id_t frame_id);
+
+  static constexpr size_t NOT_IN_HEAP = std::numeric_limits<size_t>::max();
+
+  size_t current_timestamp_{0};
   size_t replacer_size_;
   size_t k_;
-  size_t current_size_;
-  std::vector<bool> is_accessible_;
   std::mutex latch_;
-  std::unordered_map<int, size_t> use_count_;
-  std::list<frame_id_t> history_list_;
-  std::unordered_map<frame_id_t, std::list<int>::iterator> history_map_;
-  std::list<frame_id_t> cache_list_;
-  std::unordered_map<frame_id_t, std::list<int>::iterator> cache_map_;
+
+  /** Last k access timestamps of every frame, as a ring of k slots per frame starting at frame_id * k. */
+  std::vector<size_t> history_;
+  /** Number of accesses recorded for every frame since it was last evicted or removed. */
+  std::vector<size_t> access_count_;
+  /** Whether every frame is evictable. */
+  std::vector<bool> evictable_;
+  /** Whether every frame has only been accessed by scans since it was last evicted or removed. */
+  std::vector<bool> scan_only_;
+  /** Whether every frame has only been prefetched since it was last evicted or removed. */
+  std::vector<bool> prefetched_;
+  /** Position of every frame in heap_, or NOT_IN_HEAP. */
+  std::vector<size_t> heap_pos_;
+  /** Evictable frames, with the next victim at the front. Capacity is reserved up front. */
+  std::vector<frame_id_t> heap_;
 };
 
 }  // namespace bustub
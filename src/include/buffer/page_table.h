@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the pages cached by a buffer pool instance to their frames.
+ *
+ * It is a hash table with open addressing and linear probing. Every slot is a single 64-bit atomic holding both the
+ * page id and the frame id, so a lookup touches one or two cache lines and never sees half an entry.
+ *
+ * Find is lock-free and may run concurrently with anything. Insert, Erase and Grow must be serialized by the caller.
+ * Erase moves entries back to keep probe sequences short (no tombstones), and bumps a version counter around the move
+ * so that a concurrent Find that might have missed the moving entry tries again.
+ *
+ * Grow copies the entries into a larger set of slots and publishes it. The slots it replaces are kept until the table
+ * is destroyed, and a Find that started on them answers as of the moment it started.
+ */
+class PageTable {
+ public:
+  /**
+   * @brief Create an empty page table.
+   * @param max_entries the most entries the table will ever hold at once
+   */
+  explicit PageTable(size_t max_entries);
+
+  DISALLOW_COPY_AND_MOVE(PageTable);
+
+  ~PageTable() = default;
+
+  /**
+   * @brief Look up a page. Lock-free.
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame holding the page, unchanged if the page is not in the table
+   * @return whether the page is in the table
+   */
+  auto Find(page_id_t page_id, frame_id_t *frame_id) const -> bool;
+
+  /**
+   * @brief Map page_id to frame_id, replacing any existing mapping. Must not run concurrently with Insert or Erase.
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * @brief Remove page_id from the table, if it is there. Must not run concurrently with Insert or Erase.
+   */
+  void Erase(page_id_t page_id);
+
+  /**
+   * @brief Make room for max_entries entries, keeping the ones in the table. Does nothing if there is room already.
+   * Must not run concurrently with Insert, Erase or another Grow.
+   */
+  void Grow(size_t max_entries);
+
+  /** @return the number of pages in the table */
+  auto Size() const -> size_t { return size_; }
+
+  /** @return the most entries the table can hold */
+  auto Capacity() const -> size_t { return (slots_.load(std::memory_order_relaxed)->mask_ + 1) / 2; }
+
+ private:
+  /** An empty slot. No entry looks like this since INVALID_PAGE_ID is never stored. */
+  static constexpr uint64_t EMPTY = ~static_cast<uint64_t>(0);
+
+  static auto MakeEntry(page_id_t page_id, frame_id_t frame_id) -> uint64_t {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static auto EntryPageId(uint64_t entry) -> page_id_t { return static_cast<page_id_t>(entry >> 32); }
+  static auto EntryFrameId(uint64_t entry) -> frame_id_t { return static_cast<frame_id_t>(entry & 0xFFFFFFFF); }
+
+  /** A set of slots, replaced as a whole by Grow. */
+  struct Slots {
+    explicit Slots(size_t max_entries);
+
+    /** @return the slot a page hashes to */
+    auto Home(page_id_t page_id) const -> size_t {
+      return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >>
+                                 shift_);
+    }
+
+    /** @return the slot holding page_id, or the empty slot that ends its probe sequence */
+    auto Probe(page_id_t page_id) const -> size_t;
+
+    /** Number of slots minus one. The number of slots is a power of two. */
+    size_t mask_;
+    /** 64 minus log2 of the number of slots, turning a 64-bit hash into a slot index. */
+    int shift_;
+    std::unique_ptr<std::atomic<uint64_t>[]> entries_;
+    /** Odd while Erase is moving entries around. */
+    std::atomic<uint64_t> version_{0};
+  };
+
+  /** The slots in use, the last of tables_. */
+  std::atomic<Slots *> slots_;
+  /** Every set of slots the table has had. */
+  std::vector<std::unique_ptr<Slots>> tables_;
+  size_t size_{0};
+};
+
+}  // namespace bustub
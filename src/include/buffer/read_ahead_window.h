@@ -0,0 +1,62 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_ahead_window.h
+//
+// Identification: src/include/buffer/read_ahead_window.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <utility>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * ReadAheadWindow keeps the next pages of a scan over a chain of pages (table heap pages, B+ tree leaves) prefetched,
+ * so that the scan does not stall on every page boundary.
+ *
+ * The id of a page is only known once the page before it is in memory, so the window hands the chain to
+ * BufferPoolManager::PrefetchChain, which follows it in the background. Every time the scan has used up half of the
+ * window, the window is topped up again from the page the scan is on.
+ */
+class ReadAheadWindow {
+ public:
+  /** An empty window that never prefetches anything. */
+  ReadAheadWindow() = default;
+
+  /**
+   * @param bpm the buffer pool to prefetch into
+   * @param window_size the most pages kept prefetched ahead of the scan, 0 disables read-ahead
+   * @param next_page_id reads the next page id from a page of the chain
+   */
+  ReadAheadWindow(BufferPoolManager *bpm, size_t window_size, NextPageIdFn next_page_id)
+      : bpm_(bpm), window_size_(window_size), next_page_id_(std::move(next_page_id)) {}
+
+  /**
+   * @brief Tell the window that the scan is on page_id, and top it up if needed. Does nothing if the scan was already
+   * on that page.
+   * @param page_id the page the scan is on
+   * @param next_page_id the page after it, as read by the scan
+   */
+  void Advance(page_id_t page_id, page_id_t next_page_id);
+
+ private:
+  BufferPoolManager *bpm_{nullptr};
+  size_t window_size_{0};
+  NextPageIdFn next_page_id_;
+  /** The page the scan is on. */
+  page_id_t current_page_id_{INVALID_PAGE_ID};
+  /** Pages the scan can still move on before the window is topped up. */
+  size_t pages_until_refill_{0};
+};
+
+}  // namespace bustub
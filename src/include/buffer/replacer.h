@@ -12,12 +12,25 @@
 
 #pragma once
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
+/** How a page is accessed. Prefetch is the buffer pool reading a page nobody has asked for yet. */
+enum class AccessType { Unknown = 0, Get, Scan, Prefetch };
+
+/** The replacement policies a BufferPoolManager can be configured with. */
+enum class ReplacerPolicy { LRUK = 0, Clock, TwoQ, ARC };
+
 /**
- * Replacer is an abstract class that tracks page usage.
+ * Replacer is an abstract class that tracks frame usage and picks frames to evict.
+ *
+ * Frames enter the replacer on their first recorded access and start out non-evictable. The buffer pool marks a
+ * frame evictable once nobody has it pinned. Only evictable frames are candidates for eviction.
  */
 class Replacer {
  public:
@@ -25,26 +38,93 @@ class Replacer {
   virtual ~Replacer() = default;
 
   /**
-   * Remove the victim frame as defined by the replacement policy.
-   * @param[out] frame_id id of frame that was removed, nullptr if no victim was found
+   * Remove the victim frame as defined by the replacement policy, along with its access history.
+   * @param[out] frame_id id of frame that was removed, unchanged if no victim was found
    * @return true if a victim frame was found, false otherwise
    */
-  virtual auto Victim(frame_id_t *frame_id) -> bool = 0;
+  virtual auto Evict(frame_id_t *frame_id) -> bool = 0;
 
   /**
-   * Pins a frame, indicating that it should not be victimized until it is unpinned.
-   * @param frame_id the id of the frame to pin
+   * Record an access to a frame, starting to track it if needed.
+   * @param frame_id the id of the frame that was accessed
+   * @param access_type type of access that was received
    */
-  virtual void Pin(frame_id_t frame_id) = 0;
+  virtual void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown) = 0;
 
   /**
-   * Unpins a frame, indicating that it can now be victimized.
-   * @param frame_id the id of the frame to unpin
+   * Toggle whether a tracked frame may be evicted. Has no effect on frames that are not tracked.
+   * @param frame_id the id of the frame
+   * @param set_evictable whether the frame may be evicted
+   */
+  virtual void SetEvictable(frame_id_t frame_id, bool set_evictable) = 0;
+
+  /**
+   * Stop tracking an evictable frame, regardless of its priority. Does nothing if the frame is not tracked.
+   * @param frame_id the id of the frame to remove
    */
-  virtual void Unpin(frame_id_t frame_id) = 0;
+  virtual void Remove(frame_id_t frame_id) = 0;
 
   /** @return the number of elements in the replacer that can be victimized */
   virtual auto Size() -> size_t = 0;
+
+  /**
+   * Look at the frames that would be evicted next, without evicting them or touching their history.
+   * @param max_frames the most frames to return
+   * @return up to max_frames evictable frames, in the order they would be evicted if nothing changes in the meantime
+   */
+  virtual auto EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> = 0;
+
+  /**
+   * Change the number of frames the replacer manages. Frames keep their state. When shrinking, the frames that are
+   * dropped must not be tracked.
+   * @param num_frames the new number of frames
+   */
+  virtual void Resize(size_t num_frames) = 0;
+
+  /**
+   * Tell the replacer which page a frame is being loaded with, before the first access of the page is recorded.
+   * Policies that remember the pages they evicted need it; the others ignore it.
+   * @param frame_id the id of the frame
+   * @param page_id the page the frame holds from now on
+   */
+  virtual void SetPage(frame_id_t frame_id, page_id_t page_id) {}
+
+  /** Remove the victim frame. Same as Evict. */
+  auto Victim(frame_id_t *frame_id) -> bool { return Evict(frame_id); }
+
+  /**
+   * Pins a frame, indicating that it should not be victimized until it is unpinned.
+   * @param frame_id the id of the frame to pin
+   */
+  void Pin(frame_id_t frame_id) { SetEvictable(frame_id, false); }
+
+  /**
+   * Unpins a frame, indicating that it can now be victimized. The unpin counts as an access.
+   * @param frame_id the id of the frame to unpin
+   */
+  void Unpin(frame_id_t frame_id) {
+    RecordAccess(frame_id);
+    SetEvictable(frame_id, true);
+  }
 };
 
+/** @return the name of a replacement policy, as accepted by ParseReplacerPolicy */
+auto ReplacerPolicyToString(ReplacerPolicy policy) -> std::string;
+
+/**
+ * Look up a replacement policy by name: lru_k, clock, 2q or arc, in any case.
+ * @param name the name of the policy
+ * @param[out] policy the policy, unchanged if the name is unknown
+ * @return false if the name is unknown
+ */
+auto ParseReplacerPolicy(const std::string &name, ReplacerPolicy *policy) -> bool;
+
+/**
+ * Create a replacer.
+ * @param policy the replacement policy
+ * @param num_frames the number of frames the replacer manages
+ * @param k the lookback constant, only used by the LRU-K replacer
+ */
+auto MakeReplacer(ReplacerPolicy policy, size_t num_frames, size_t k) -> std::unique_ptr<Replacer>;
+
 }  // namespace bustub
@@ -0,0 +1,140 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer_lists.h
+//
+// Identification: src/include/buffer/replacer_lists.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameList is a doubly-linked list of frame ids, for replacers that keep frames in recency order. The links live in
+ * a flat array indexed by frame id and allocated up front, so moving a frame around never allocates. A frame is in at
+ * most one FrameList of a replacer at a time; the replacer keeps track of which one.
+ */
+class FrameList {
+ public:
+  /** The frame id returned when there is no frame. */
+  static constexpr frame_id_t NONE = -1;
+
+  explicit FrameList(size_t num_frames) : links_(num_frames) {}
+
+  /** @return the number of frames in the list */
+  auto Size() const -> size_t { return size_; }
+
+  /** @return the most recently inserted frame, or NONE */
+  auto Front() const -> frame_id_t { return head_; }
+
+  /** @return the least recently inserted frame, or NONE */
+  auto Back() const -> frame_id_t { return tail_; }
+
+  /** @return the frame inserted just before frame_id, i.e. the next one walking from the back, or NONE */
+  auto Prev(frame_id_t frame_id) const -> frame_id_t { return links_[frame_id].prev_; }
+
+  /** @brief Insert a frame that is not in the list at the front. */
+  void PushFront(frame_id_t frame_id) {
+    auto &link = links_[frame_id];
+    link.prev_ = NONE;
+    link.next_ = head_;
+    if (head_ != NONE) {
+      links_[head_].prev_ = frame_id;
+    } else {
+      tail_ = frame_id;
+    }
+    head_ = frame_id;
+    size_++;
+  }
+
+  /** @brief Take a frame that is in the list out of it. */
+  void Erase(frame_id_t frame_id) {
+    auto &link = links_[frame_id];
+    if (link.prev_ != NONE) {
+      links_[link.prev_].next_ = link.next_;
+    } else {
+      head_ = link.next_;
+    }
+    if (link.next_ != NONE) {
+      links_[link.next_].prev_ = link.prev_;
+    } else {
+      tail_ = link.prev_;
+    }
+    size_--;
+  }
+
+  /** @brief Move a frame that is in the list to the front. */
+  void MoveToFront(frame_id_t frame_id) {
+    Erase(frame_id);
+    PushFront(frame_id);
+  }
+
+  /** @brief Change the number of frames the list can hold. Frames that are dropped must not be in the list. */
+  void Resize(size_t num_frames) { links_.resize(num_frames); }
+
+ private:
+  /** The neighbours of a frame. next_ points towards the back. */
+  struct Link {
+    frame_id_t prev_{NONE};
+    frame_id_t next_{NONE};
+  };
+
+  std::vector<Link> links_;
+  frame_id_t head_{NONE};
+  frame_id_t tail_{NONE};
+  size_t size_{0};
+};
+
+/**
+ * GhostList remembers the ids of pages that were evicted, most recent first, without their data. Replacers use it to
+ * recognize a page that comes back soon after it was evicted.
+ */
+class GhostList {
+ public:
+  /** @return the number of pages remembered */
+  auto Size() const -> size_t { return pages_.size(); }
+
+  /** @return whether the page is remembered */
+  auto Contains(page_id_t page_id) const -> bool { return index_.count(page_id) > 0; }
+
+  /** @brief Remember a page that is not remembered yet, as the most recent one. */
+  void PushFront(page_id_t page_id) {
+    pages_.push_front(page_id);
+    index_.emplace(page_id, pages_.begin());
+  }
+
+  /** @brief Forget a page. Does nothing if it is not remembered. */
+  void Erase(page_id_t page_id) {
+    auto it = index_.find(page_id);
+    if (it == index_.end()) {
+      return;
+    }
+    pages_.erase(it->second);
+    index_.erase(it);
+  }
+
+  /** @brief Forget the least recently remembered page. The list must not be empty. */
+  void PopBack() {
+    BUSTUB_ASSERT(!pages_.empty(), "ghost list is empty");
+    index_.erase(pages_.back());
+    pages_.pop_back();
+  }
+
+ private:
+  std::list<page_id_t> pages_;
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> index_;
+};
+
+}  // namespace bustub
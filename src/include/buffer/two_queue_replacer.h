@@ -0,0 +1,109 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.h
+//
+// Identification: src/include/buffer/two_queue_replacer.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "buffer/replacer_lists.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * TwoQReplacer implements the full version of the 2Q replacement policy (Johnson and Shasha, VLDB 1994).
+ *
+ * A page loaded into a frame enters A1in, a FIFO queue that absorbs the correlated references right after a load:
+ * hits in A1in do not move the frame. Pages evicted from A1in are remembered in A1out, a ghost queue of page ids. A
+ * page that is loaded again while A1out still remembers it has proven it is reused and goes to Am, an LRU queue.
+ * Frames are evicted from A1in while it holds more than a quarter of the frames, and from Am otherwise. A1out
+ * remembers up to half as many pages as there are frames.
+ *
+ * Scan and prefetch accesses do not count as reuse: they never move a frame, and a page that was only scanned or
+ * prefetched is not remembered in A1out. A one-off scan therefore stays in A1in and recycles its own frames.
+ *
+ * Pinned frames stay in their queue and are skipped by Evict, which walks each queue from its cold end. A latch
+ * serializes every call.
+ */
+class TwoQReplacer : public Replacer {
+ public:
+  /**
+   * @brief Create a new TwoQReplacer.
+   * @param num_frames the number of frames the replacer manages
+   */
+  explicit TwoQReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(TwoQReplacer);
+
+  ~TwoQReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  auto EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> override;
+
+  /** @brief Throws if a frame that is dropped is still tracked. The queue limits follow the new size. */
+  void Resize(size_t num_frames) override;
+
+  /** @brief The page is looked up in A1out on its first recorded access. */
+  void SetPage(frame_id_t frame_id, page_id_t page_id) override;
+
+ private:
+  /** The queue a frame is in. */
+  enum class Queue : uint8_t { None = 0, A1In, Am };
+
+  /** What the replacer knows about a frame. */
+  struct Frame {
+    Queue queue_{Queue::None};
+    bool evictable_{false};
+    /** Whether the page had an access other than a scan or prefetch since it was loaded. */
+    bool referenced_{false};
+    page_id_t page_id_{INVALID_PAGE_ID};
+  };
+
+  /** Throws if frame_id is not managed by this replacer. */
+  void CheckFrameId(frame_id_t frame_id) const;
+
+  /** @return the first evictable frame of the queue walking from frame_id towards the front, or FrameList::NONE */
+  auto NextEvictable(const FrameList &queue, frame_id_t frame_id) const -> frame_id_t;
+
+  /** @return up to max_frames evictable frames in eviction order */
+  auto PickVictims(size_t max_frames) const -> std::vector<frame_id_t>;
+
+  /** Set the queue limits for num_frames_ and forget the pages A1out has no room for. */
+  void SetLimits();
+
+  size_t num_frames_;
+  /** Most frames A1in holds before it is evicted from first. */
+  size_t kin_;
+  /** Most pages A1out remembers. */
+  size_t kout_;
+  /** Number of evictable frames. */
+  size_t size_{0};
+  std::vector<Frame> frames_;
+  FrameList a1in_;
+  FrameList am_;
+  GhostList a1out_;
+  std::mutex latch_;
+};
+
+}  // namespace bustub
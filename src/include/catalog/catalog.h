@@ -35,6 +35,16 @@ using table_oid_t = uint32_t;
 using column_oid_t = uint32_t;
 using index_oid_t = uint32_t;
 
+/** Which tables and indexes get a tablespace of their own, see Catalog::SetTablespacePolicy. */
+enum class TablespacePolicy {
+  /** Every table and index lives in DEFAULT_TABLESPACE. */
+  Shared,
+  /** A table and its indexes share a tablespace of their own. */
+  PerTable,
+  /** Every table and every index has a tablespace of its own. */
+  PerObject
+};
+
 /**
  * The TableInfo class maintains metadata about a table.
  */
@@ -91,12 +101,17 @@ struct IndexInfo {
   std::string table_name_;
   /** The size of the index key, in bytes */
   const size_t key_size_;
+  /** The tablespace the pages of the index are in */
+  tablespace_id_t tablespace_{DEFAULT_TABLESPACE};
 };
 
 /**
  * The Catalog is a non-persistent catalog that is designed for
  * use by executors within the DBMS execution engine. It handles
  * table creation, table lookup, index creation, and index lookup.
+ *
+ * Depending on the TablespacePolicy, new tables and indexes are put in tablespaces of their own, so that dropping them
+ * drops their tablespace, and with it every page they had, at once. Otherwise their pages are left behind.
  */
 class Catalog {
  public:
@@ -136,7 +151,9 @@ class Catalog {
     // When create_table_heap == false, it means that we're running binder tests (where no txn will be provided) or
     // we are running shell without buffer pool. We don't need to create TableHeap in this case.
     if (create_table_heap) {
-      table = std::make_unique<TableHeap>(bpm_);
+      auto tablespace =
+          tablespace_policy_ == TablespacePolicy::Shared ? DEFAULT_TABLESPACE : bpm_->CreateTablespace();
+      table = std::make_unique<TableHeap>(bpm_, tablespace);
     }
 
     // Fetch the table OID for the new table
@@ -225,11 +242,19 @@ class Catalog {
     // to allow specification of the index type itself, not
     // just the key, value, and comparator types
 
+    auto *table_meta = GetTable(table_name);
+    auto tablespace = DEFAULT_TABLESPACE;
+    if (tablespace_policy_ == TablespacePolicy::PerTable) {
+      tablespace = table_meta->table_->GetTablespace();
+    } else if (tablespace_policy_ == TablespacePolicy::PerObject) {
+      tablespace = bpm_->CreateTablespace();
+    }
+
     // TODO(chi): support both hash index and btree index
-    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+    auto index =
+        std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_, tablespace);
 
     // Populate the index with all tuples in table heap
-    auto *table_meta = GetTable(table_name);
     for (auto iter = table_meta->table_->MakeIterator(); !iter.IsEnd(); ++iter) {
       auto [meta, tuple] = iter.GetTuple();
       index->InsertEntry(tuple.KeyFromTuple(schema, key_schema, key_attrs), tuple.GetRid(), txn);
@@ -241,6 +266,7 @@ class Catalog {
     // Construct index information; IndexInfo takes ownership of the Index itself
     auto index_info =
         std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
+    index_info->tablespace_ = tablespace;
     auto *tmp = index_info.get();
 
     // Update internal tracking
@@ -333,6 +359,68 @@ class Catalog {
     return indexes;
   }
 
+  /**
+   * Drop the index `index_name` of table `table_name`, with its tablespace if it has one of its own.
+   * @param index_name The name of the index to drop
+   * @param table_name The name of the table of the index
+   * @return false if there is no such index, or a page of its tablespace is pinned; nothing is dropped then
+   */
+  auto DropIndex(const std::string &index_name, const std::string &table_name) -> bool {
+    auto *index_info = GetIndex(index_name, table_name);
+    if (index_info == NULL_INDEX_INFO) {
+      return false;
+    }
+    auto tablespace = OwnTablespaceOf(index_info, table_name);
+    if (tablespace != DEFAULT_TABLESPACE && bpm_->HasPinnedPages(tablespace)) {
+      return false;
+    }
+    index_names_.find(table_name)->second.erase(index_name);
+    indexes_.erase(index_info->index_oid_);
+    if (tablespace != DEFAULT_TABLESPACE) {
+      // nothing in it is pinned, so at worst the tablespace is gone already
+      bpm_->DropTablespace(tablespace);
+    }
+    return true;
+  }
+
+  /**
+   * Drop the table `table_name` and its indexes, with their tablespaces.
+   * @param table_name The name of the table to drop
+   * @return false if there is no such table, or a page of its tablespaces or those of its indexes is pinned; nothing
+   * is dropped then
+   */
+  auto DropTable(const std::string &table_name) -> bool {
+    auto *table_info = GetTable(table_name);
+    if (table_info == NULL_TABLE_INFO) {
+      return false;
+    }
+    auto tablespace = table_info->table_ != nullptr ? table_info->table_->GetTablespace() : DEFAULT_TABLESPACE;
+    std::vector<tablespace_id_t> tablespaces{tablespace};
+    for (auto *index_info : GetTableIndexes(table_name)) {
+      tablespaces.push_back(OwnTablespaceOf(index_info, table_name));
+    }
+    for (auto dropped : tablespaces) {
+      if (dropped != DEFAULT_TABLESPACE && bpm_->HasPinnedPages(dropped)) {
+        return false;
+      }
+    }
+    for (auto *index_info : GetTableIndexes(table_name)) {
+      DropIndex(index_info->name_, table_name);
+    }
+    index_names_.erase(table_name);
+    table_names_.erase(table_name);
+    tables_.erase(table_info->oid_);
+    if (tablespace != DEFAULT_TABLESPACE) {
+      bpm_->DropTablespace(tablespace);
+    }
+    return true;
+  }
+
+  /** Choose the tablespaces of the tables and indexes created from now on. */
+  void SetTablespacePolicy(TablespacePolicy policy) { tablespace_policy_ = policy; }
+
+  auto GetTablespacePolicy() const -> TablespacePolicy { return tablespace_policy_; }
+
   auto GetTableNames() -> std::vector<std::string> {
     std::vector<std::string> result;
     for (const auto &x : table_names_) {
@@ -342,6 +430,13 @@ class Catalog {
   }
 
  private:
+  /** @return the tablespace the index does not share with its table, DEFAULT_TABLESPACE if none */
+  auto OwnTablespaceOf(const IndexInfo *index_info, const std::string &table_name) const -> tablespace_id_t {
+    auto *table_info = GetTable(table_name);
+    auto table_tablespace = table_info->table_ != nullptr ? table_info->table_->GetTablespace() : DEFAULT_TABLESPACE;
+    return index_info->tablespace_ == table_tablespace ? DEFAULT_TABLESPACE : index_info->tablespace_;
+  }
+
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] LockManager *lock_manager_;
   [[maybe_unused]] LogManager *log_manager_;
@@ -371,6 +466,9 @@ class Catalog {
 
   /** The next index identifier to be used. */
   std::atomic<index_oid_t> next_index_oid_{0};
+
+  /** Which of the tables and indexes created from now on get a tablespace of their own. */
+  TablespacePolicy tablespace_policy_{TablespacePolicy::Shared};
 };
 
 }  // namespace bustub
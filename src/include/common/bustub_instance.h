@@ -218,7 +218,12 @@ class BustubInstance {
   auto MakeExecutorContext(Transaction *txn, bool is_modify) -> std::unique_ptr<ExecutorContext>;
 
  public:
-  explicit BustubInstance(const std::string &db_file_name);
+  /**
+   * Open or create a database file.
+   * @param db_file_name the database file
+   * @param page_size the page size of the file if it is created; an existing file keeps its own page size
+   */
+  explicit BustubInstance(const std::string &db_file_name, size_t page_size = BUSTUB_PAGE_SIZE);
 
   BustubInstance();
 
@@ -278,6 +283,7 @@ class BustubInstance {
  private:
   void CmdDisplayTables(ResultWriter &writer);
   void CmdDisplayIndices(ResultWriter &writer);
+  void CmdDisplayBufferPool(ResultWriter &writer);
   void CmdDisplayHelp(ResultWriter &writer);
   void WriteOneCell(const std::string &cell, ResultWriter &writer);
 
@@ -14,6 +14,7 @@
 
 #include <atomic>
 #include <chrono>  // NOLINT
+#include <cstddef>
 #include <cstdint>
 
 namespace bustub {
@@ -27,15 +28,34 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** The page cleaner of the buffer pool looks for dirty pages to write back every PAGE_CLEANER_INTERVAL milliseconds. */
+extern std::chrono::milliseconds page_cleaner_interval;
+
+/** Table and B+ tree leaf scans keep up to READ_AHEAD_WINDOW pages prefetched ahead of them, 0 disables read-ahead. */
+extern size_t read_ahead_window;
+
 static constexpr int INVALID_PAGE_ID = -1;                                           // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                            // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                               // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                             // the header page id
-static constexpr int BUSTUB_PAGE_SIZE = 4096;                                        // size of a data page in byte
+static constexpr int BUSTUB_PAGE_SIZE = 4096;       // default (and smallest) size of a data page in byte
+static constexpr int BUSTUB_MAX_PAGE_SIZE = 32768;  // largest page size a database file can be created with
 static constexpr int BUFFER_POOL_SIZE = 10;                                          // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
 static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr double PAGE_CLEANER_LOW_WATERMARK = 0.1;   // clean fraction of frames below which the cleaner writes
+static constexpr double PAGE_CLEANER_HIGH_WATERMARK = 0.2;  // clean fraction of frames the cleaner stops at
+static constexpr int OPTIMISTIC_READ_ATTEMPTS = 8;  // optimistic b+ tree lookups before falling back to read latches
+static constexpr size_t WARM_UP_READ_PAGES = 64;    // most pages the buffer pool warm-up reads in one I/O
+static constexpr size_t DISK_SCHEDULER_WORKERS = 4;  // background threads of the disk scheduler
+static constexpr size_t DISK_SCHEDULER_BATCH = 64;   // most requests a disk scheduler worker services at once
+static constexpr size_t READ_AHEAD_MIN_BYTES = 64 * 1024;            // first extent read ahead of a sequential scan
+static constexpr size_t READ_AHEAD_MAX_BYTES = 256 * 1024;           // largest extent the disk reads ahead
+static constexpr size_t READ_AHEAD_STAGING_BYTES = 4 * 1024 * 1024;  // memory for pages read ahead, not read yet
+static constexpr size_t DISK_EXTENT_BYTES = 1024 * 1024;             // disk space a database file grows by at a time
+static constexpr int TABLESPACE_PAGE_BITS = 24;  // low bits of a page id that number the page within its tablespace
+static constexpr int MAX_TABLESPACES = 128;      // tablespaces of a database, the database file itself included
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
@@ -43,6 +63,9 @@ using txn_id_t = int32_t;      // transaction id type
 using lsn_t = int32_t;         // log sequence number type
 using slot_offset_t = size_t;  // slot offset type
 using oid_t = uint16_t;
+using tablespace_id_t = int32_t;  // tablespace id type
+
+static constexpr tablespace_id_t DEFAULT_TABLESPACE = 0;  // the tablespace of the database file itself
 
 static constexpr int VARCHAR_DEFAULT_LENGTH = 128;  // default length for varchar when constructing the column
 
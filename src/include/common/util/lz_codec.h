@@ -0,0 +1,61 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz_codec.h
+//
+// Identification: src/include/common/util/lz_codec.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+namespace bustub {
+
+/**
+ * LzCodec is a small LZ77 compressor in the spirit of LZ4, fast enough to run on every page the buffer pool evicts.
+ * It finds matches through a hash table of 4-byte sequences and makes no effort to find the longest one.
+ *
+ * The compressed data is a series of sequences. Each starts with a token byte whose high nibble is the number of
+ * literals and whose low nibble is the match length minus MIN_MATCH; a nibble of 15 is continued by bytes that are
+ * added to it until one is below 255. The literals follow, then a 2-byte little-endian offset back to the match, then
+ * the continuation of the match length. The last sequence has literals only.
+ *
+ * Inputs are at most 64 KiB, which covers every page size.
+ */
+class LzCodec {
+ public:
+  /** The shortest match that is encoded. */
+  static constexpr size_t MIN_MATCH = 4;
+  /** The longest input. */
+  static constexpr size_t MAX_INPUT_SIZE = 64 * 1024;
+
+  /** @return the most bytes Compress can produce for size bytes of input */
+  static auto MaxCompressedSize(size_t size) -> size_t { return size + size / 255 + 16; }
+
+  /**
+   * @brief Compress a buffer.
+   * @param src the data to compress, at most MAX_INPUT_SIZE bytes
+   * @param size the number of bytes in src
+   * @param[out] dst where the compressed data goes
+   * @param capacity the size of dst; compression gives up once the output would not fit
+   * @return the size of the compressed data, or 0 if it does not fit in capacity
+   */
+  static auto Compress(const char *src, size_t size, char *dst, size_t capacity) -> size_t;
+
+  /**
+   * @brief Decompress data produced by Compress. Damaged input is detected rather than read or written out of bounds.
+   * @param src the compressed data
+   * @param size the number of bytes in src
+   * @param[out] dst where the data goes
+   * @param dst_size the size the data had before compression
+   * @return false if src is damaged or does not decompress to exactly dst_size bytes
+   */
+  static auto Decompress(const char *src, size_t size, char *dst, size_t dst_size) -> bool;
+};
+
+}  // namespace bustub
@@ -12,52 +12,204 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <cstdint>
 #include <fstream>
 #include <future>  // NOLINT
-#include <mutex>   // NOLINT
+#include <limits>
+#include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
+#include "storage/disk/disk_read_ahead.h"
 
 namespace bustub {
 
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * The page size is chosen when a database file is created and recorded in a superblock, which takes up the first page
+ * of the file. Files written before page sizes were configurable have no superblock and use BUSTUB_PAGE_SIZE.
+ *
+ * Pages are read and written with positional pread/pwrite calls on one file descriptor, without any latch, so any
+ * number of threads can do page I/O at once. Writes go to the operating system right away but are only durable after
+ * Sync, or a WritePages that asks for it.
+ *
+ * Pages are allocated and freed through the disk manager, which hands freed pages out again before the file grows. A
+ * free-space map, one bit per page, records which pages are allocated. It lives in the database file: a map page
+ * precedes every run of page_size * 8 data pages, and the maps are written back on Sync. Files written before the
+ * free-space map have none; their pages are allocated past the end of the file. As pages are allocated past the end,
+ * the file reserves disk space DISK_EXTENT_BYTES at a time with fallocate on Linux, so that it is laid out in large
+ * extents.
+ *
+ * With direct I/O the database file is opened with O_DIRECT, or F_NOCACHE on macOS, so pages are not cached a second
+ * time by the operating system and the buffer pool is the only cache. Direct I/O needs buffers aligned to
+ * DIRECT_IO_ALIGNMENT, which buffer pool frames are; other buffers are copied through an aligned one.
+ *
+ * A file opened read-only is never written to, nor is its log; every call that would write throws instead.
+ *
+ * With read-ahead enabled, ReadPage notices the sequential reads of a thread and reads the pages that follow along with
+ * them, in 64-256 KB extents, see DiskReadAhead.
+ *
+ * A plain disk manager keeps every page in the one database file, tablespace DEFAULT_TABLESPACE;
+ * DiskManagerTablespaces adds files of their own for other tablespaces.
  */
 class DiskManager {
+  // Opens the files of its tablespaces without a log of their own.
+  friend class DiskManagerTablespaces;
+
  public:
+  /** A page to write and its data, see WritePages. */
+  using PageWrite = std::pair<page_id_t, const char *>;
+  /** A page to read and the buffer to read it into, see ReadPages. */
+  using PageRead = std::pair<page_id_t, char *>;
+
+  /** How the allocated pages are spread over the file, see GetFreeSpaceStats. */
+  struct FreeSpaceStats {
+    /** One past the highest page id ever allocated. */
+    page_id_t num_pages_;
+    size_t allocated_pages_;
+    /** Pages below num_pages_ that are free. */
+    size_t free_pages_;
+    /** Runs of consecutive free pages below num_pages_, and the longest of them. */
+    size_t free_runs_;
+    size_t largest_free_run_;
+  };
+
+  /** The alignment of buffers, file offsets and sizes that direct I/O asks for. */
+  static constexpr size_t DIRECT_IO_ALIGNMENT = 4096;
+
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param page_size the page size of the file if it is created, ignored for an existing file
+   * @param direct_io whether to bypass the operating system page cache; ignored if the file system does not allow it
+   * @param read_only whether to open an existing file without ever writing to it; every write then throws
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, size_t page_size = BUSTUB_PAGE_SIZE, bool direct_io = false,
+                       bool read_only = false);
 
   /** FOR TEST / LEADERBOARD ONLY, used by DiskManagerMemory */
-  DiskManager() = default;
+  explicit DiskManager(size_t page_size = BUSTUB_PAGE_SIZE) : page_size_(page_size) { CheckPageSize(page_size); }
 
-  virtual ~DiskManager() = default;
+  virtual ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
    */
-  void ShutDown();
+  virtual void ShutDown();
 
   /**
-   * Write a page to the database file.
+   * Write a page to the database file. The page is not durable until the next Sync.
    * @param page_id id of the page
    * @param page_data raw page data
    */
   virtual void WritePage(page_id_t page_id, const char *page_data);
 
   /**
-   * Read a page from the database file.
+   * Write many pages at once. The pages are written in page id order and runs of consecutive page ids go to disk in a
+   * single vectored write, instead of a seek, a write and a flush per page.
+   * @param pages the pages to write, each page id at most once
+   * @param sync whether to wait until the pages are durable before returning, with one sync for all of them
+   */
+  virtual void WritePages(std::vector<PageWrite> pages, bool sync = true);
+
+  /**
+   * Read a page from the database file. A page past the end of the file reads as zeros.
    * @param page_id id of the page
    * @param[out] page_data output buffer
    */
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Read many pages at once. Like WritePages, runs of consecutive page ids are read with a single vectored read. Pages
+   * past the end of the file read as zeros.
+   * @param pages the pages to read, each page id at most once
+   */
+  virtual void ReadPages(std::vector<PageRead> pages);
+
+  /** Wait until every page written so far, and the free-space map, is durable. */
+  virtual void Sync();
+
+  /**
+   * Allocate a page, reusing a freed one if there is any. Page ids are striped, so that every buffer pool instance is
+   * handed the page ids it is responsible for.
+   * @param stripe the stripe to allocate in: the page id modulo num_stripes is stripe
+   * @param num_stripes the number of stripes, the same for every call
+   * @param[out] reused if not null, set to whether the page was freed before, so the file may hold old data for it
+   * @param tablespace the tablespace to allocate in
+   * @return the id of the page
+   * @throws Exception if there is no such tablespace
+   */
+  virtual auto AllocatePage(size_t stripe = 0, size_t num_stripes = 1, bool *reused = nullptr,
+                            tablespace_id_t tablespace = DEFAULT_TABLESPACE) -> page_id_t;
+
+  /**
+   * Free a page, for AllocatePage to hand out again.
+   * @return false if the page is not allocated
+   */
+  virtual auto DeallocatePage(page_id_t page_id) -> bool;
+
+  /** @return whether the page is allocated */
+  virtual auto IsAllocated(page_id_t page_id) -> bool;
+
+  /**
+   * Make AllocatePage hand out page ids below page_limit only; there is no limit but that of page_id_t by default.
+   * @return false, and the limit unchanged, if a page id at or past page_limit was allocated already
+   */
+  auto LimitPages(page_id_t page_limit) -> bool;
+
+  /** @return how many pages of the database file are allocated and how the free ones are spread */
+  auto GetFreeSpaceStats() -> FreeSpaceStats;
+
+  /**
+   * Create a tablespace for AllocatePage to allocate pages in.
+   * @return the new tablespace; DEFAULT_TABLESPACE if the disk manager keeps every page in the database file
+   * @throws Exception if there is no room for another tablespace
+   */
+  virtual auto CreateTablespace() -> tablespace_id_t;
+
+  /**
+   * Drop a tablespace and every page in it at once. Nothing may be cached of it anymore.
+   * @return false if there is no such tablespace, or it is DEFAULT_TABLESPACE, which cannot be dropped
+   */
+  virtual auto DropTablespace(tablespace_id_t tablespace) -> bool;
+
+  /** @return whether the tablespace exists; a plain DiskManager only has DEFAULT_TABLESPACE */
+  virtual auto HasTablespace(tablespace_id_t tablespace) -> bool { return tablespace == DEFAULT_TABLESPACE; }
+
+  /** @return the tablespace a page id belongs to */
+  static auto TablespaceOf(page_id_t page_id) -> tablespace_id_t {
+    return static_cast<tablespace_id_t>(page_id >> TABLESPACE_PAGE_BITS);
+  }
+
+  /** @return the lowest page id of a tablespace; the page ids of the tablespace are TablespaceSize() from there */
+  static auto FirstPageOf(tablespace_id_t tablespace) -> page_id_t {
+    return static_cast<page_id_t>(tablespace) << TABLESPACE_PAGE_BITS;
+  }
+
+  /** @return the number of page ids of a tablespace */
+  static constexpr auto TablespaceSize() -> page_id_t { return static_cast<page_id_t>(1) << TABLESPACE_PAGE_BITS; }
+
+  /**
+   * Read extents of pages ahead of sequential ReadPage calls. Call before the disk manager is shared between threads.
+   * @param staging_bytes the memory for pages read ahead and not asked for yet
+   */
+  virtual void EnableReadAhead(size_t staging_bytes = READ_AHEAD_STAGING_BYTES);
+
+  /** @return what the read-ahead did so far, all zeros if it is not enabled */
+  auto GetReadAheadStats() -> DiskReadAhead::Stats {
+    return read_ahead_ != nullptr ? read_ahead_->GetStats() : DiskReadAhead::Stats{};
+  }
+
+  /** @return whether the allocated pages are recorded in the file, and so survive a restart */
+  auto HasFreeSpaceMap() const -> bool { return has_free_space_map_; }
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -74,6 +226,15 @@ class DiskManager {
    */
   auto ReadLog(char *log_data, int size, int offset) -> bool;
 
+  /** @return the size of a page in the database file */
+  auto GetPageSize() const -> size_t { return page_size_; }
+
+  /** @return whether the database file is read and written with direct I/O */
+  auto IsDirectIo() const -> bool { return direct_io_; }
+
+  /** @return whether the database file is open read-only */
+  auto IsReadOnly() const -> bool { return read_only_; }
+
   /** @return the number of disk flushes */
   auto GetNumFlushes() const -> int;
 
@@ -93,19 +254,146 @@ class DiskManager {
   inline auto HasFlushLogFuture() -> bool { return flush_log_f_ != nullptr; }
 
  protected:
+  /**
+   * Opens a database file like the public constructor, with or without its log.
+   * @param with_log whether to open the log; the files of DiskManagerTablespaces share the log of the database file
+   */
+  DiskManager(const std::string &db_file, size_t page_size, bool direct_io, bool read_only, bool with_log);
+
+  /** @throws Exception unless page_size is a power of two between BUSTUB_PAGE_SIZE and BUSTUB_MAX_PAGE_SIZE */
+  static void CheckPageSize(size_t page_size);
+
+  /** @throws Exception if the database file is open read-only */
+  void EnsureWritable() const;
+
+  /** @return one past the highest page id ever allocated */
+  auto GetNumPages() -> page_id_t;
+
+  /**
+   * Append a log buffer to the log file and flush it, for WriteLog.
+   * @return false on an I/O error
+   */
+  virtual auto AppendLog(const char *log_data, int size) -> bool;
+
+  /** @return the offset of a page in the database file */
+  auto PageOffset(page_id_t page_id) const -> off_t {
+    auto index = static_cast<size_t>(page_id);
+    if (has_free_space_map_) {
+      // skip the superblock and the map pages up to and including the one of the page
+      index += index / PagesPerMap() + 1;
+    }
+    return static_cast<off_t>(data_offset_ + index * page_size_);
+  }
+
+  /** @return whether next directly follows prev in the database file, so both go in one vectored I/O */
+  auto IsNextOnDisk(page_id_t prev, page_id_t next) const -> bool {
+    return next == prev + 1 && !(has_free_space_map_ && static_cast<size_t>(next) % PagesPerMap() == 0);
+  }
+
+  /** @brief Drop a page that was just written from the read-ahead, which may hold its old data. */
+  void ForgetReadAhead(page_id_t page_id) {
+    if (read_ahead_ != nullptr) {
+      read_ahead_->Invalidate(page_id);
+    }
+  }
+
+  /** @brief Write the parts of the free-space map changed since the last call to the database file. */
+  void WriteFreeSpaceMap();
+
+  /** @return whether data can be handed to the database file as it is, false if direct I/O needs it copied first */
+  auto IsAligned(const char *data) const -> bool {
+    return !direct_io_ || reinterpret_cast<uintptr_t>(data) % DIRECT_IO_ALIGNMENT == 0;
+  }
+
+  /** @return whether every buffer of a batch of PageRead or PageWrite IsAligned */
+  template <typename PageT>
+  auto AllAligned(const std::vector<PageT> &pages) const -> bool {
+    return std::all_of(pages.begin(), pages.end(), [this](const PageT &page) { return IsAligned(page.second); });
+  }
+
   auto GetFileSize(const std::string &file_name) -> int;
+  /** Size of every page, in bytes. */
+  size_t page_size_{BUSTUB_PAGE_SIZE};
+  /** Offset of page 0 in the database file, past the superblock. */
+  size_t data_offset_{0};
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // the db file, -1 without a file
+  int db_fd_{-1};
+  // whether db_fd_ is opened with O_DIRECT
+  bool direct_io_{false};
+  // whether db_fd_ is opened with O_RDONLY, see EnsureWritable
+  bool read_only_{false};
+  // whether the file holds a free-space map, see PageOffset
+  bool has_free_space_map_{false};
   std::string file_name_;
   int num_flushes_{0};
-  int num_writes_{0};
+  std::atomic<int> num_writes_{0};
   bool flush_log_{false};
   std::future<void> *flush_log_f_{nullptr};
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
+
+ private:
+  /** The pages of one stripe that AllocatePage can hand out. */
+  struct Stripe {
+    /** The lowest page id of the stripe above every allocated one. */
+    page_id_t next_;
+    /** Freed page ids of the stripe below next_, the lowest on top. */
+    std::vector<page_id_t> free_;
+  };
+
+  /** @return the number of pages a map page covers */
+  auto PagesPerMap() const -> size_t { return page_size_ * 8; }
+
+  /** @return the offset of a map page in the database file */
+  auto MapOffset(size_t map) const -> off_t {
+    return static_cast<off_t>(data_offset_ + map * (PagesPerMap() + 1) * page_size_);
+  }
+
+  /** Write a page-sized block at offset, through an aligned copy if direct I/O needs one. */
+  void WriteBlock(const char *data, off_t offset);
+
+  /**
+   * Read a page along with the extent the read-ahead plans after it, in one I/O.
+   * @return false if the read-ahead plans none, and nothing was read
+   */
+  auto ReadWithExtent(page_id_t page_id, char *page_data) -> bool;
+
+  /** Read the free-space map of the file, or make one up for a file without. */
+  void LoadFreeSpaceMap();
+
+  /** Whether a page is allocated. Caller should hold free_space_latch_. */
+  auto TestPage(page_id_t page_id) const -> bool;
+
+  /** Mark a page allocated or free. Caller should hold free_space_latch_. */
+  void SetPage(page_id_t page_id, bool allocated);
+
+  /** Sort the free pages into num_stripes stripes. Caller should hold free_space_latch_. */
+  void BuildStripes(size_t num_stripes);
+
+  /**
+   * Reserve disk space for the file up to end, whole DISK_EXTENT_BYTES extents at a time, without changing the size of
+   * the file. Does nothing but on Linux. Caller should hold free_space_latch_.
+   */
+  void ReserveSpace(off_t end);
+
+  /** Protects everything below. */
+  std::mutex free_space_latch_;
+  /** The free-space map, one page-sized bitmap per map page. */
+  std::vector<std::vector<char>> maps_;
+  /** Which of maps_ changed since they were last written. */
+  std::vector<bool> dirty_maps_;
+  /** One past the highest page id ever allocated. */
+  page_id_t num_pages_{0};
+  /** The page id AllocatePage stops at, see LimitPages. */
+  page_id_t page_limit_{std::numeric_limits<page_id_t>::max()};
+  /** The stripes of the last AllocatePage, built on first use. */
+  std::vector<Stripe> stripes_;
+  /** The end of the disk space reserved for the file, -1 once the file system turned out not to reserve any. */
+  off_t reserved_end_{0};
+
+  /** The read-ahead of ReadPage, nullptr unless enabled. */
+  std::unique_ptr<DiskReadAhead> read_ahead_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap.h
+//
+// Identification: src/include/storage/disk/disk_manager_mmap.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * DiskManagerMmap opens an existing database file read-only and maps all of it into memory, e.g. for a reporting copy
+ * of a database. A BufferPoolManager on top of it hands out read guards that point straight into the mapping, so
+ * reading a page copies nothing and takes no frame; see BufferPoolManager::FetchPageRead.
+ *
+ * The operating system pages the mapping in and out. The mapping is advised as randomly accessed, so that an index
+ * lookup faults in only the page it reads, and scans ask for the pages ahead of them to be read in instead.
+ */
+class DiskManagerMmap : public DiskManager {
+ public:
+  /**
+   * Maps an existing database file.
+   * @param db_file the file name of the database file to read
+   * @throws Exception if the file does not exist, is empty or cannot be mapped
+   */
+  explicit DiskManagerMmap(const std::string &db_file);
+
+  ~DiskManagerMmap() override;
+
+  /** Copies the page out of the mapping. A page past the end of the file reads as zeros. */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  void ReadPages(std::vector<PageRead> pages) override;
+
+  /**
+   * @brief Find a page in the mapping. It stays valid as long as the disk manager.
+   * @param page_id the page to find
+   * @param scan whether a scan reads the page, so that the pages after it are read in ahead of the scan
+   * @return the data of the page, nullptr if the page lies past the end of the file
+   */
+  auto GetMappedPage(page_id_t page_id, bool scan = false) -> const char *;
+
+  /** @return the number of times a scan asked for the pages ahead of it to be read in */
+  auto GetNumScanHints() const -> size_t { return num_scan_hints_; }
+
+ private:
+  /** Pages a scan asks for at a time, READ_AHEAD_MAX_BYTES worth. */
+  size_t scan_extent_pages_;
+  char *mapping_{nullptr};
+  size_t mapping_size_{0};
+  std::atomic<size_t> num_scan_hints_{0};
+};
+
+}  // namespace bustub
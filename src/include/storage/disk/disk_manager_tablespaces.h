@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_tablespaces.h
+//
+// Identification: src/include/storage/disk/disk_manager_tablespaces.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * DiskManagerTablespaces keeps every tablespace but DEFAULT_TABLESPACE in a file of its own, next to the database
+ * file: tablespace 3 of "test.db" is "test.db.3". The catalog puts a table, or an index, in a tablespace of its own,
+ * so that dropping it unlinks the file instead of leaving its pages behind.
+ *
+ * A page id names its tablespace in the bits above TABLESPACE_PAGE_BITS and the page in the file of the tablespace in
+ * the bits below, so the file of a tablespace holds TablespaceSize() pages at most. DEFAULT_TABLESPACE is the database
+ * file as a plain DiskManager lays it out, and is not held to that: it grows into the page ids of tablespaces that do
+ * not exist, and a new tablespace gets the lowest id the database file has not grown into. Every file is a database
+ * file of its own, with its superblock and free-space map, and reserves its disk space in extents. The files share the
+ * log of the database file.
+ *
+ * Page I/O takes a shared latch to find the file of the page, so I/O to different tablespaces, and allocations in
+ * them, go on in parallel. Only creating and dropping a tablespace takes the latch exclusively. The tablespaces are
+ * found again by their files when the database is opened.
+ */
+class DiskManagerTablespaces : public DiskManager {
+ public:
+  /**
+   * Opens the database file and the files of its tablespaces.
+   * @param db_file the file name of the database file to write to
+   * @param page_size the page size of the file if it is created, ignored for an existing file
+   * @param direct_io whether to bypass the operating system page cache, see DiskManager
+   */
+  explicit DiskManagerTablespaces(const std::string &db_file, size_t page_size = BUSTUB_PAGE_SIZE,
+                                  bool direct_io = false);
+
+  void ShutDown() override;
+
+  /** @throws Exception if the page is in a tablespace that does not exist, e.g. one just dropped */
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /** @throws Exception, writing none of the pages, if one is in a tablespace that does not exist */
+  void WritePages(std::vector<PageWrite> pages, bool sync = true) override;
+
+  /** @throws Exception if the page is in a tablespace that does not exist */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  void ReadPages(std::vector<PageRead> pages) override;
+
+  void Sync() override;
+
+  auto AllocatePage(size_t stripe = 0, size_t num_stripes = 1, bool *reused = nullptr,
+                    tablespace_id_t tablespace = DEFAULT_TABLESPACE) -> page_id_t override;
+
+  auto DeallocatePage(page_id_t page_id) -> bool override;
+
+  auto IsAllocated(page_id_t page_id) -> bool override;
+
+  /** Creates the file of the lowest unused tablespace. */
+  auto CreateTablespace() -> tablespace_id_t override;
+
+  /** Closes and unlinks the file of the tablespace. */
+  auto DropTablespace(tablespace_id_t tablespace) -> bool override;
+
+  void EnableReadAhead(size_t staging_bytes = READ_AHEAD_STAGING_BYTES) override;
+
+  auto HasTablespace(tablespace_id_t tablespace) -> bool override;
+
+  /** @return the name of the file a tablespace other than DEFAULT_TABLESPACE is kept in */
+  auto GetTablespaceFile(tablespace_id_t tablespace) const -> std::string;
+
+ private:
+  /** @return the file of a tablespace other than DEFAULT_TABLESPACE, nullptr if none. Caller holds spaces_latch_. */
+  auto SpaceOf(tablespace_id_t tablespace) const -> DiskManager *;
+
+  /**
+   * @return the tablespace of the file a page is in: that of its page id, or DEFAULT_TABLESPACE for a page id of a
+   * tablespace that does not exist, as far as the database file has grown. Caller holds spaces_latch_.
+   */
+  auto FileTablespaceOf(page_id_t page_id) -> tablespace_id_t;
+
+  /**
+   * @brief Keep the database file below the page ids of the lowest tablespace. Caller holds spaces_latch_ exclusively.
+   * @return false if it has grown past them already
+   */
+  auto LimitDatabaseFile() -> bool;
+
+  /** @brief Open, or create, the file of a tablespace. */
+  auto OpenSpace(tablespace_id_t tablespace) -> std::unique_ptr<DiskManager>;
+
+  /**
+   * @brief Split a batch by the file of each page, the page ids of the tablespaces made into pages of their files.
+   * Caller holds spaces_latch_.
+   * @tparam PageT PageRead or PageWrite
+   * @throws Exception if a page is in a tablespace that does not exist
+   */
+  template <typename PageT>
+  auto SplitByTablespace(std::vector<PageT> pages) -> std::map<tablespace_id_t, std::vector<PageT>>;
+
+  /** The staging memory of the read-ahead of every file, 0 for none. */
+  size_t read_ahead_bytes_{0};
+
+  /** Protects spaces_ itself, not the files in it. */
+  mutable std::shared_mutex spaces_latch_;
+  /** The file of every tablespace, MAX_TABLESPACES of them, nullptr for none; DEFAULT_TABLESPACE is this one. */
+  std::vector<std::unique_ptr<DiskManager>> spaces_;
+};
+
+}  // namespace bustub
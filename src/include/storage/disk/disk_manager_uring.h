@@ -0,0 +1,109 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_uring.h
+//
+// Identification: src/include/storage/disk/disk_manager_uring.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <atomic>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/io_uring.h"
+
+namespace bustub {
+
+/**
+ * DiskManagerUring is a DiskManager that sends batches of I/O to the kernel through io_uring. WritePages and ReadPages
+ * submit the vectored write or read of every run of consecutive pages, plus the sync, in one system call, so the
+ * device sees all of them at once instead of one after the other. Log appends go out as a write linked to an
+ * fdatasync, also in one system call.
+ *
+ * A single ReadPage or WritePage gains nothing from a ring and stays on pread/pwrite. Where io_uring is not available
+ * (an old kernel, or a sandbox that filters it) every call falls back to the DiskManager code, and the DiskScheduler
+ * thread pool is what keeps several requests in flight.
+ */
+class DiskManagerUring : public DiskManager {
+ public:
+  /** The submission queue size of a ring. A batch with more runs than this is submitted in parts. */
+  static constexpr unsigned RING_ENTRIES = 64;
+
+  /**
+   * Creates a disk manager for the given database file.
+   * @param db_file the file name of the database file to write to
+   * @param page_size the page size of the file if it is created, ignored for an existing file
+   * @param use_uring false to always use the DiskManager code, e.g. to compare the two
+   * @param direct_io whether to bypass the operating system page cache, see DiskManager
+   */
+  explicit DiskManagerUring(const std::string &db_file, size_t page_size = BUSTUB_PAGE_SIZE, bool use_uring = true,
+                            bool direct_io = false);
+
+  ~DiskManagerUring() override;
+
+  void WritePages(std::vector<PageWrite> pages, bool sync = true) override;
+
+  void ReadPages(std::vector<PageRead> pages) override;
+
+  /** @return whether I/O goes through io_uring, false if it fell back to the DiskManager code */
+  auto IsUringEnabled() const -> bool { return uring_enabled_; }
+
+  /** @return the number of times requests were handed to the kernel through a ring */
+  auto GetNumSubmits() const -> size_t { return num_submits_; }
+
+ protected:
+  auto AppendLog(const char *log_data, int size) -> bool override;
+
+ private:
+  /** A run of consecutive pages, done with one vectored read or write. */
+  struct Run {
+    /** The pages of the run are [begin_, end_) of the sorted batch, and so of the iovec array. */
+    size_t begin_;
+    size_t end_;
+    off_t offset_;
+  };
+
+  /**
+   * @brief Sort a batch by page id and split it into runs, with one iovec per page.
+   * @tparam PageT PageRead or PageWrite
+   */
+  template <typename PageT>
+  auto SplitRuns(std::vector<PageT> *pages, std::vector<iovec> *iov) const -> std::vector<Run>;
+
+  /**
+   * @brief Submit the runs, as many at a time as a ring holds, and wait for all of them.
+   * @param is_write whether to write the runs or read them
+   * @param sync whether to sync the file once all runs are written
+   * @return the runs that did not transfer in full, e.g. reads past the end of the file, for the caller to redo
+   */
+  auto SubmitRuns(bool is_write, const std::vector<Run> &runs, std::vector<iovec> *iov, bool sync) -> std::vector<Run>;
+
+  /** @brief Take a ring from the pool, or set up a new one. @return nullptr if that fails */
+  auto AcquireRing() -> std::unique_ptr<IoUring>;
+
+  /** @brief Put a ring back into the pool. */
+  void ReleaseRing(std::unique_ptr<IoUring> ring);
+
+  bool uring_enabled_{false};
+  /** Rings not in use, so that concurrent batches each have their own. */
+  std::mutex rings_latch_;
+  std::vector<std::unique_ptr<IoUring>> rings_;
+  std::atomic<size_t> num_submits_{0};
+  /** The log file, written at log_offset_, its end. */
+  int log_fd_{-1};
+  off_t log_offset_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,168 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_read_ahead.h
+//
+// Identification: src/include/storage/disk/disk_read_ahead.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+#include <list>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * DiskReadAhead turns the single-page reads of a sequential scan into large reads, for DiskManager::ReadPage.
+ *
+ * Every thread is a stream of its own. Once a thread reads TRIGGER_PAGES consecutive pages, the disk manager reads an
+ * extent of the pages that follow along with the last one, in one I/O, and parks them in a staging area where the next
+ * reads of the thread find them. The extent starts at READ_AHEAD_MIN_BYTES and doubles with every extent the stream
+ * goes on into, up to READ_AHEAD_MAX_BYTES. It halves instead when the stream finds that its last extent left the
+ * staging area before it got there, so that concurrent streams share the staging area; a read elsewhere ends the
+ * stream.
+ *
+ * The staging area is a fixed number of page buffers, so its memory is bounded. A staged page leaves it when it is
+ * read, a hit, or when it is wasted: its buffer is taken for a newer extent, or the page is written. The buffers are
+ * aligned for direct I/O.
+ */
+class DiskReadAhead {
+ public:
+  /** What the read-ahead did so far, see GetStats. */
+  struct Stats {
+    /** Extents read, and the pages read ahead in them. */
+    size_t extents_;
+    size_t pages_read_ahead_;
+    /** Reads served from the staging area. */
+    size_t hits_;
+    /** Pages read ahead that left the staging area without being read. */
+    size_t wasted_;
+  };
+
+  /** The consecutive pages a thread reads before it is read ahead of; fewer would read ahead of random reads. */
+  static constexpr size_t TRIGGER_PAGES = 3;
+
+  /** The number of threads whose streams are tracked at once; the one idle the longest makes room for a new one. */
+  static constexpr size_t MAX_STREAMS = 16;
+
+  /**
+   * @param page_size the size of a page
+   * @param alignment the alignment of the staging buffers
+   * @param staging_bytes the memory of the staging area, at least a page
+   * @param min_extent_bytes the size of the first extent of a stream
+   * @param max_extent_bytes the size an extent grows to
+   */
+  DiskReadAhead(size_t page_size, size_t alignment, size_t staging_bytes = READ_AHEAD_STAGING_BYTES,
+                size_t min_extent_bytes = READ_AHEAD_MIN_BYTES, size_t max_extent_bytes = READ_AHEAD_MAX_BYTES);
+
+  /**
+   * @brief Copy a page out of the staging area, if it is there, for a read of the calling thread.
+   * @return whether page_data holds the page
+   */
+  auto Take(page_id_t page_id, char *page_data) -> bool;
+
+  /**
+   * @brief Record a read of the calling thread that missed the staging area, and plan the extent to read along.
+   * @param page_id the page read from disk
+   * @param max_pages the most pages after page_id the disk can read in the same I/O
+   * @return the buffers to read page_id + 1, page_id + 2, ... into, empty for no read-ahead; hand them to Fill
+   */
+  auto Plan(page_id_t page_id, size_t max_pages) -> std::vector<char *>;
+
+  /**
+   * @brief Stage the pages of an extent that Plan returned, once read.
+   * @param first the first page of the extent, page_id + 1 of Plan
+   * @param buffers the buffers Plan returned
+   * @param num_read the number of buffers read in full; the others lie past the end of the file
+   */
+  void Fill(page_id_t first, const std::vector<char *> &buffers, size_t num_read);
+
+  /** @brief Drop a page that was just written from the staging area, or from an extent in flight. */
+  void Invalidate(page_id_t page_id);
+
+  /** @return what the read-ahead did so far */
+  auto GetStats() -> Stats;
+
+ private:
+  /** The reads of one thread. */
+  struct Stream {
+    std::thread::id thread_;
+    /** The page a sequential read of the stream reads next. */
+    page_id_t next_;
+    /** One past the last page the stream read ahead. */
+    page_id_t ahead_end_;
+    /** The consecutive pages the stream read so far. */
+    size_t run_;
+    /** The size of the next extent, in pages. */
+    size_t extent_pages_;
+    /** When the stream was last read from, in calls to StreamOf. */
+    size_t last_used_;
+  };
+
+  /** A page in the staging area. */
+  struct Staged {
+    size_t slot_;
+    /** Its place in order_. */
+    std::list<page_id_t>::iterator order_;
+  };
+
+  /** An extent Plan handed out and Fill did not get back yet. */
+  struct InFlight {
+    page_id_t first_;
+    size_t num_pages_;
+    /** The slot of its first buffer, which tells extents apart. */
+    size_t first_slot_;
+    /** Pages of the extent written meanwhile, whose data read may be old. */
+    std::vector<page_id_t> written_;
+
+    auto Contains(page_id_t page_id) const -> bool {
+      return page_id >= first_ && page_id < first_ + static_cast<page_id_t>(num_pages_);
+    }
+  };
+
+  /** The stream of the calling thread, replacing the one idle the longest if it has none. Caller holds latch_. */
+  auto StreamOf() -> Stream &;
+
+  /** @return whether a page is staged or in flight. Caller holds latch_. */
+  auto IsAhead(page_id_t page_id) const -> bool;
+
+  /** Take a staged page out of the staging area. Caller holds latch_. */
+  void Unstage(std::unordered_map<page_id_t, Staged>::iterator it);
+
+  auto SlotData(size_t slot) -> char * { return buffers_.get() + slot * page_size_; }
+
+  size_t page_size_;
+  size_t num_slots_;
+  size_t min_extent_pages_;
+  size_t max_extent_pages_;
+  /** num_slots_ page buffers. */
+  std::unique_ptr<char, decltype(&std::free)> buffers_;
+  /** The number of pages staged or in flight, so that writes skip the latch when there are none. */
+  std::atomic<size_t> num_tracked_{0};
+
+  /** Protects everything below. */
+  std::mutex latch_;
+  std::vector<size_t> free_slots_;
+  std::unordered_map<page_id_t, Staged> staged_;
+  /** The staged pages, oldest first, in the order their buffers are taken back. */
+  std::list<page_id_t> order_;
+  std::list<InFlight> in_flight_;
+  std::vector<Stream> streams_;
+  size_t clock_{0};
+  Stats stats_{};
+};
+
+}  // namespace bustub
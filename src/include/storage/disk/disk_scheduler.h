@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.h
+//
+// Identification: src/include/storage/disk/disk_scheduler.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <future>              // NOLINT
+#include <list>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_set>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/** A read or a write of one page, see DiskScheduler. */
+struct DiskRequest {
+  /** Whether the request is a write. */
+  bool is_write_;
+  /** The data to write, or the buffer to read into, one page long. Must stay valid until the request completes. */
+  char *data_;
+  /** The page to read or write. */
+  page_id_t page_id_;
+  /** Set to true once the request is complete, or to the exception the disk manager threw. */
+  std::promise<bool> callback_;
+};
+
+/**
+ * DiskScheduler puts a queue and a pool of worker threads in front of a DiskManager. Callers schedule reads and
+ * writes and get a future back, so that one thread can have many pages in flight at once.
+ *
+ * A worker takes its share of the queued requests, up to DISK_SCHEDULER_BATCH, and hands them to
+ * DiskManager::WritePages and DiskManager::ReadPages, which sort them by page id and merge neighbouring pages into one
+ * vectored I/O; a DiskManagerUring then submits all of those together. Requests for the same page complete in the order
+ * they were scheduled: a request waits in the queue while an earlier one for its page is queued or in flight.
+ */
+class DiskScheduler {
+ public:
+  /**
+   * @brief Create a scheduler and start its workers.
+   * @param disk_manager the disk manager doing the I/O (not owned)
+   * @param num_workers the number of worker threads, at least one
+   */
+  explicit DiskScheduler(DiskManager *disk_manager, size_t num_workers = DISK_SCHEDULER_WORKERS);
+
+  DISALLOW_COPY_AND_MOVE(DiskScheduler);
+
+  /** @brief Finish the requests that are still queued, then stop the workers. */
+  ~DiskScheduler();
+
+  /**
+   * @brief Queue a request. Returns right away.
+   * @param request the request; keep a future of its callback to learn when it completes
+   */
+  void Schedule(DiskRequest request);
+
+  /** @brief Queue a read of page_id into data. @return a future that is ready once data holds the page */
+  auto ScheduleRead(page_id_t page_id, char *data) -> std::future<bool>;
+
+  /** @brief Queue a write of data to page_id. @return a future that is ready once the page is written */
+  auto ScheduleWrite(page_id_t page_id, const char *data) -> std::future<bool>;
+
+  /** @brief Return a promise for the callback of a DiskRequest. */
+  auto CreatePromise() -> std::promise<bool> { return {}; }
+
+  /** @return the disk manager the requests go to */
+  auto GetDiskManager() -> DiskManager * { return disk_manager_; }
+
+  /** @return the number of batches serviced so far; requests merged into one batch count once */
+  auto GetNumBatches() -> size_t;
+
+ private:
+  /** The loop of every worker. */
+  void RunWorker();
+
+  /**
+   * @brief Take the oldest requests off the queue that may run now, at most one per page and at most a share of the
+   * queue per worker, and mark their pages in flight. Caller should hold the latch.
+   */
+  auto TakeBatch() -> std::vector<DiskRequest>;
+
+  /** @brief Do the I/O of a batch and complete its requests. */
+  void ServiceBatch(std::vector<DiskRequest> *batch);
+
+  DiskManager *disk_manager_;
+  const size_t num_workers_;
+  /** Protects queue_, in_flight_, stop_ and num_batches_. */
+  std::mutex latch_;
+  /** Signalled when a request is queued, a batch completes, or the scheduler stops. */
+  std::condition_variable cv_;
+  /** Requests not taken by a worker yet, oldest first. */
+  std::list<DiskRequest> queue_;
+  /** Pages of the batches the workers are servicing. */
+  std::unordered_set<page_id_t> in_flight_;
+  bool stop_{false};
+  size_t num_batches_{0};
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace bustub
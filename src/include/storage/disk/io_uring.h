@@ -0,0 +1,112 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_uring.h
+//
+// Identification: src/include/storage/disk/io_uring.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "common/macros.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace bustub {
+
+/**
+ * IoUring is a minimal io_uring instance, set up with raw system calls so that no library is needed. Requests are
+ * prepared into the submission queue, sent to the kernel in one io_uring_enter by Submit, and their results popped off
+ * the completion queue.
+ *
+ * An IoUring is not thread-safe; use one per thread at a time.
+ */
+class IoUring {
+ public:
+  /**
+   * @brief Set up a ring.
+   * @param entries the size of the submission queue, rounded up to a power of two by the kernel
+   * @return the ring, or nullptr if the kernel does not support io_uring or does not let us use it
+   */
+  static auto Create(unsigned entries) -> std::unique_ptr<IoUring>;
+
+  DISALLOW_COPY_AND_MOVE(IoUring);
+
+  ~IoUring();
+
+  /** @return how many requests fit in the submission queue */
+  auto GetNumEntries() const -> unsigned { return sq_entries_; }
+
+  /** @return how many more requests can be prepared before the next Submit */
+  auto GetNumFree() const -> unsigned { return sq_entries_ - num_prepared_; }
+
+  /** @brief Queue a vectored read of count buffers at offset. The buffers must stay valid until it completes. */
+  void PrepareReadv(int fd, const iovec *iov, unsigned count, off_t offset, uint64_t user_data);
+
+  /** @brief Queue a vectored write of count buffers at offset. The buffers must stay valid until it completes. */
+  void PrepareWritev(int fd, const iovec *iov, unsigned count, off_t offset, uint64_t user_data);
+
+  /**
+   * @brief Queue an fdatasync of fd.
+   * @param after_all whether it only starts once every request queued before it has completed
+   */
+  void PrepareFdatasync(int fd, bool after_all, uint64_t user_data);
+
+  /** @brief Make the last request queued only start once the one before it succeeded. */
+  void LinkToPrevious();
+
+  /**
+   * @brief Hand the queued requests to the kernel, in one system call, and wait until at least min_complete requests
+   * completed. PopCompletion with wait covers any completion this did not wait for.
+   * @return false if the kernel refused them
+   */
+  auto Submit(unsigned min_complete) -> bool;
+
+  /**
+   * @brief Take a completed request off the completion queue.
+   * @param[out] user_data the user_data of the request
+   * @param[out] result what the system call would have returned, or -errno
+   * @param wait whether to wait for a request to complete if none has yet
+   * @return false if no request has completed, or waiting failed
+   */
+  auto PopCompletion(uint64_t *user_data, int32_t *result, bool wait = false) -> bool;
+
+ private:
+  IoUring() = default;
+
+  /** Clear the next submission queue entry and return it. */
+  auto NextSqe() -> io_uring_sqe *;
+
+  int ring_fd_{-1};
+  unsigned sq_entries_{0};
+  /** Requests prepared since the last Submit. */
+  unsigned num_prepared_{0};
+  /** The mmaped rings and submission queue entries, with their sizes. */
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+  /** Pointers into the rings, shared with the kernel. */
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  io_uring_cqe *cqes_{nullptr};
+};
+
+}  // namespace bustub
@@ -69,7 +69,7 @@ class BPlusTree {
  public:
   explicit BPlusTree(std::string name, page_id_t header_page_id, BufferPoolManager *buffer_pool_manager,
                      const KeyComparator &comparator, int leaf_max_size = LEAF_PAGE_SIZE,
-                     int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int internal_max_size = INTERNAL_PAGE_SIZE, tablespace_id_t tablespace = DEFAULT_TABLESPACE);
 
   // Returns true if this B+ tree has no keys and values.
   auto IsEmpty() const -> bool;
@@ -144,6 +144,8 @@ class BPlusTree {
   void PrintTree(page_id_t page_id, const BPlusTreePage *page);
 
   auto GetKeyAt(const KeyType &key, const KeyComparator &comparator, Context &ctx) -> page_id_t;
+
+  auto OptimisticGetValue(const KeyType &key, std::vector<ValueType> *result) -> std::optional<bool>;
   /**
    * @brief Convert A B+ tree into a Printable B+ tree
    *
@@ -160,6 +162,8 @@ class BPlusTree {
   int leaf_max_size_;
   int internal_max_size_;
   page_id_t header_page_id_;
+  // the tablespace new pages of the tree are created in
+  tablespace_id_t tablespace_;
 };
 
 /**
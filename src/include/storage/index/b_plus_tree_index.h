@@ -27,7 +27,8 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager);
+  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                 tablespace_id_t tablespace = DEFAULT_TABLESPACE);
 
   auto InsertEntry(const Tuple &key, RID rid, Transaction *transaction) -> bool override;
 
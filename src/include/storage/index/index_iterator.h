@@ -13,6 +13,7 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include "buffer/read_ahead_window.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
@@ -43,6 +44,8 @@ class IndexIterator {
   const B_PLUS_TREE_LEAF_PAGE_TYPE *page_{nullptr};
   int index_{INVALID_PAGE_ID};
   BufferPoolManager *bpm_{nullptr};
+  /** Keeps the next leaves prefetched, see read_ahead_window. */
+  ReadAheadWindow read_ahead_;
 };
 
 }  // namespace bustub
@@ -48,6 +48,11 @@ class BPlusTreeInternalPage : public BPlusTreePage {
    */
   void Init(int max_size = INTERNAL_PAGE_SIZE);
 
+  /** @return how many entries fit in an internal page of page_size bytes, INTERNAL_PAGE_SIZE for the default size */
+  static constexpr auto Capacity(size_t page_size) -> int {
+    return static_cast<int>((page_size - INTERNAL_PAGE_HEADER_SIZE) / sizeof(MappingType));
+  }
+
   void SetValueAt(int index, const ValueType &value);
   void InsertFirstOf(const page_id_t &value);
   /**
@@ -54,6 +54,11 @@ class BPlusTreeLeafPage : public BPlusTreePage {
    */
   void Init(int max_size = LEAF_PAGE_SIZE);
 
+  /** @return how many entries fit in a leaf page of page_size bytes, LEAF_PAGE_SIZE for the default size */
+  static constexpr auto Capacity(size_t page_size) -> int {
+    return static_cast<int>((page_size - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType));
+  }
+
   // helper methods
   auto GetNextPageId() const -> page_id_t;
   void SetNextPageId(page_id_t next_page_id);
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 
@@ -27,17 +28,18 @@ namespace bustub {
  */
 class Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
+  friend class BufferPoolManagerInstance;
+  // The buffer pool points every frame at its slice of the frame arena.
   friend class BufferPoolManager;
+  // Write guards move the version that optimistic readers validate against.
+  friend class WritePageGuard;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() {
-    data_ = new char[BUSTUB_PAGE_SIZE];
-    ResetMemory();
-  }
+  /** Constructor. The page has no data until the buffer pool assigns it a frame. */
+  Page() = default;
 
-  /** Default destructor. */
-  ~Page() { delete[] data_; }
+  /** Default destructor. The data belongs to the buffer pool. */
+  ~Page() = default;
 
   /** @return the actual data contained within this page */
   inline auto GetData() -> char * { return data_; }
@@ -63,6 +65,12 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * @return the version of the page. It is odd while a WritePageGuard holds the page and changes every time one is
+   * dropped, so a reader that sees the same even version before and after reading saw no writer in between.
+   */
+  inline auto GetVersion() -> uint64_t { return version_.load(std::memory_order_acquire); }
+
   /** @return the page LSN. */
   inline auto GetLSN() -> lsn_t { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -78,13 +86,30 @@ class Page {
   static constexpr size_t OFFSET_LSN = 4;
 
  private:
+  /** Marks the page as being written, called with the write latch held. */
+  inline void BeginWrite() {
+    version_.fetch_add(1, std::memory_order_relaxed);
+    // the version must be visible before any of the writes to the data
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  /** Publishes the writes to the data, called before the write latch is released. */
+  inline void EndWrite() { version_.fetch_add(1, std::memory_order_release); }
+
+  /** Makes the version even again should a writer never have ended, called when the frame gets another page. */
+  inline void AlignVersion() {
+    if ((version_.load(std::memory_order_relaxed) & 1) != 0) {
+      version_.fetch_add(1, std::memory_order_release);
+    }
+  }
+
   /** Zeroes out the data that is held within the page. */
-  inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, BUSTUB_PAGE_SIZE); }
+  inline void ResetMemory(size_t page_size) { memset(data_, OFFSET_PAGE_START, page_size); }
 
   /** The actual data that is stored within a page. */
-  // Usually this should be stored as `char data_[BUSTUB_PAGE_SIZE]{};`. But to enable ASAN to detect page overflow,
-  // we store it as a ptr.
-  char *data_;
+  // The data lives in the frame arena of the buffer pool rather than inline, so that all frames are contiguous and
+  // page-aligned. The arena leaves poisoned gaps between frames so that ASAN still detects page overflow.
+  char *data_{nullptr};
   /** The ID of this page. */
   page_id_t page_id_ = INVALID_PAGE_ID;
   /** The pin count of this page. */
@@ -93,6 +118,8 @@ class Page {
   bool is_dirty_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Version for optimistic readers, see GetVersion. */
+  std::atomic<uint64_t> version_{0};
 };
 
 }  // namespace bustub
@@ -12,6 +12,9 @@ class BasicPageGuard {
 
   BasicPageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
 
+  /** A guard on a page of a read-only file mapping, see DiskManagerMmap. There is no frame to unpin or latch. */
+  BasicPageGuard(page_id_t page_id, const char *mapped_data) : mapped_page_id_(page_id), mapped_data_(mapped_data) {}
+
   BasicPageGuard(const BasicPageGuard &) = delete;
   auto operator=(const BasicPageGuard &) -> BasicPageGuard & = delete;
 
@@ -59,9 +62,9 @@ class BasicPageGuard {
    */
   ~BasicPageGuard();
 
-  auto PageId() -> page_id_t { return page_->GetPageId(); }
+  auto PageId() -> page_id_t { return page_ != nullptr ? page_->GetPageId() : mapped_page_id_; }
 
-  auto GetData() -> const char * { return page_->GetData(); }
+  auto GetData() -> const char * { return page_ != nullptr ? page_->GetData() : mapped_data_; }
 
   template <class T>
   auto As() -> const T * {
@@ -81,16 +84,23 @@ class BasicPageGuard {
  private:
   friend class ReadPageGuard;
   friend class WritePageGuard;
+  friend class OptimisticPageGuard;
 
   [[maybe_unused]] BufferPoolManager *bpm_{nullptr};
   Page *page_{nullptr};
   bool is_dirty_{false};
+  /** The page of a guard into a file mapping, which has no page_. */
+  page_id_t mapped_page_id_{INVALID_PAGE_ID};
+  const char *mapped_data_{nullptr};
 };
 
 class ReadPageGuard {
  public:
   ReadPageGuard() = default;
   ReadPageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {}
+
+  /** A guard on a page of a read-only file mapping, which needs no latch since nobody writes the page. */
+  ReadPageGuard(page_id_t page_id, const char *mapped_data) : guard_(page_id, mapped_data) {}
   ReadPageGuard(const ReadPageGuard &) = delete;
   auto operator=(const ReadPageGuard &) -> ReadPageGuard & = delete;
 
@@ -150,7 +160,8 @@ class ReadPageGuard {
 class WritePageGuard {
  public:
   WritePageGuard() = default;
-  WritePageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {}
+  /** Takes over a page the caller holds the write latch of, and marks it as being written for optimistic readers. */
+  WritePageGuard(BufferPoolManager *bpm, Page *page);
   WritePageGuard(const WritePageGuard &) = delete;
   auto operator=(const WritePageGuard &) -> WritePageGuard & = delete;
 
@@ -214,4 +225,47 @@ class WritePageGuard {
   BasicPageGuard guard_;
 };
 
+/**
+ * OptimisticPageGuard pins a page but does not latch it. It remembers the version of the page when it is created, the
+ * reader copies what it needs out of the page and then calls Validate(), which fails if a WritePageGuard held the page
+ * at any point in between. Nothing read from the page may be acted upon before Validate() succeeded: the data can be
+ * half-way through an update, so e.g. a page id read from it may not be fetched yet.
+ */
+class OptimisticPageGuard {
+ public:
+  OptimisticPageGuard() = default;
+  OptimisticPageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page), version_(page->GetVersion()) {}
+
+  /** A guard on a page of a read-only file mapping, which always validates. */
+  OptimisticPageGuard(page_id_t page_id, const char *mapped_data) : guard_(page_id, mapped_data) {}
+  OptimisticPageGuard(const OptimisticPageGuard &) = delete;
+  auto operator=(const OptimisticPageGuard &) -> OptimisticPageGuard & = delete;
+
+  OptimisticPageGuard(OptimisticPageGuard &&that) noexcept;
+
+  auto operator=(OptimisticPageGuard &&that) noexcept -> OptimisticPageGuard &;
+
+  /** Unpins the page. There is no latch to release. */
+  void Drop();
+
+  ~OptimisticPageGuard();
+
+  auto PageId() -> page_id_t { return guard_.PageId(); }
+
+  auto GetData() -> const char * { return guard_.GetData(); }
+
+  template <class T>
+  auto As() -> const T * {
+    return guard_.As<T>();
+  }
+
+  /** @return true if no writer held the page since the guard was created, i.e. everything read so far is consistent */
+  auto Validate() -> bool;
+
+ private:
+  BasicPageGuard guard_;
+  /** The version of the page when the guard was created, odd if a writer held it already. */
+  uint64_t version_{0};
+};
+
 }  // namespace bustub
@@ -40,9 +40,9 @@ class TableHeap {
   /**
    * Create a table heap without a transaction. (open table)
    * @param buffer_pool_manager the buffer pool manager
-   * @param first_page_id the id of the first page
+   * @param tablespace the tablespace every page of the table is created in
    */
-  explicit TableHeap(BufferPoolManager *bpm);
+  explicit TableHeap(BufferPoolManager *bpm, tablespace_id_t tablespace = DEFAULT_TABLESPACE);
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return std::nullopt.
@@ -63,9 +63,10 @@ class TableHeap {
   /**
    * Read a tuple from the table.
    * @param rid rid of the tuple to read
+   * @param access_type how the page is being accessed, AccessType::Scan for sequential scans
    * @return the meta and tuple
    */
-  auto GetTuple(RID rid) -> std::pair<TupleMeta, Tuple>;
+  auto GetTuple(RID rid, AccessType access_type = AccessType::Unknown) -> std::pair<TupleMeta, Tuple>;
 
   /**
    * Read a tuple meta from the table. Note: if you want to get tuple and meta together, use `GetTuple` insead
@@ -84,6 +85,9 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
+  /** @return the tablespace the pages of this table are in */
+  inline auto GetTablespace() const -> tablespace_id_t { return tablespace_; }
+
   /**
    * Update a tuple in place. SHOULD NOT BE USED UNLESS YOU WANT TO OPTIMIZE FOR PROJECT 4.
    * @param meta new tuple meta
@@ -94,6 +98,7 @@ class TableHeap {
 
  private:
   BufferPoolManager *bpm_;
+  tablespace_id_t tablespace_;
   page_id_t first_page_id_{INVALID_PAGE_ID};
 
   std::mutex latch_;
@@ -10,66 +10,238 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <mutex>  // NOLINT
 #include <string>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/macros.h"
+#include "fmt/format.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+/** Identifies a database file with a superblock. */
+static constexpr char SUPERBLOCK_MAGIC[8] = {'B', 'U', 'S', 'T', 'U', 'B', 'D', 'B'};
+
+/** The superblock version of files with a free-space map. Files written before have version 0. */
+static constexpr uint32_t FREE_SPACE_MAP_VERSION = 1;
+
+/** The start of the first page of a database file. The rest of that page is unused. */
+struct Superblock {
+  char magic_[sizeof(SUPERBLOCK_MAGIC)];
+  uint32_t page_size_;
+  uint32_t version_;
+};
+
+/** Read up to size bytes at offset, retrying short reads. @return the number of bytes read, less at the end of file */
+static auto ReadAt(int fd, char *data, size_t size, off_t offset) -> size_t {
+  size_t done = 0;
+  while (done < size) {
+    auto n = pread(fd, data + done, size - done, offset + static_cast<off_t>(done));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      if (n < 0) {
+        LOG_DEBUG("I/O error while reading");
+      }
+      break;
+    }
+    done += n;
+  }
+  return done;
+}
+
+/** Write size bytes at offset, retrying short writes. */
+static void WriteAt(int fd, const char *data, size_t size, off_t offset) {
+  size_t done = 0;
+  while (done < size) {
+    auto n = pwrite(fd, data + done, size - done, offset + static_cast<off_t>(done));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      LOG_DEBUG("I/O error while writing");
+      return;
+    }
+    done += n;
+  }
+}
+
+/** Read into the buffers of iov at offset, retrying short reads. @return the number of bytes read, less at the end */
+static auto ReadVecAt(int fd, std::vector<iovec> iov, off_t offset) -> size_t {
+  size_t done = 0;
+  auto *next = iov.data();
+  auto count = static_cast<int>(iov.size());
+  while (count > 0) {
+    auto n = preadv(fd, next, count, offset + static_cast<off_t>(done));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      if (n < 0) {
+        LOG_DEBUG("I/O error while reading");
+      }
+      break;
+    }
+    done += n;
+    while (count > 0 && static_cast<size_t>(n) >= next->iov_len) {
+      n -= static_cast<ssize_t>(next->iov_len);
+      next++;
+      count--;
+    }
+    if (count > 0) {
+      next->iov_base = static_cast<char *>(next->iov_base) + n;
+      next->iov_len -= n;
+    }
+  }
+  return done;
+}
+
+/** Allocate a buffer that direct I/O can use. */
+static auto AllocateAligned(size_t size) -> std::unique_ptr<char, decltype(&std::free)> {
+  return {static_cast<char *>(std::aligned_alloc(DiskManager::DIRECT_IO_ALIGNMENT, size)), &std::free};
+}
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
+ * @input page_size: page size of a newly created database file
+ * @input direct_io: whether to open the database file with O_DIRECT
+ * @input read_only: whether to open an existing database file without writing to it or its log
  */
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
-  std::string::size_type n = file_name_.rfind('.');
-  if (n == std::string::npos) {
-    LOG_DEBUG("wrong file format");
-    return;
+DiskManager::DiskManager(const std::string &db_file, size_t page_size, bool direct_io, bool read_only)
+    : DiskManager(db_file, page_size, direct_io, read_only, true) {}
+
+DiskManager::DiskManager(const std::string &db_file, size_t page_size, bool direct_io, bool read_only, bool with_log)
+    : page_size_(page_size), read_only_(read_only), file_name_(db_file) {
+  CheckPageSize(page_size);
+  if (with_log) {
+    std::string::size_type n = file_name_.rfind('.');
+    if (n == std::string::npos) {
+      LOG_DEBUG("wrong file format");
+      return;
+    }
+    log_name_ = file_name_.substr(0, n) + ".log";
+
+    if (read_only) {
+      // the log can still be read if there is one
+      log_io_.open(log_name_, std::ios::binary | std::ios::in);
+    } else {
+      log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
+    }
+    // directory or file does not exist
+    if (!log_io_.is_open() && !read_only) {
+      log_io_.clear();
+      // create a new file
+      log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
+      if (!log_io_.is_open()) {
+        throw Exception("can't open dblog file");
+      }
+    }
   }
-  log_name_ = file_name_.substr(0, n) + ".log";
 
-  log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-  // directory or file does not exist
-  if (!log_io_.is_open()) {
-    log_io_.clear();
-    // create a new file
-    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!log_io_.is_open()) {
-      throw Exception("can't open dblog file");
+  // create the file if it does not exist
+  db_fd_ = read_only ? open(db_file.c_str(), O_RDONLY) : open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+
+  Superblock superblock{};
+  struct stat stat_buf;
+  if (fstat(db_fd_, &stat_buf) != 0 || stat_buf.st_size == 0) {
+    if (read_only) {
+      close(db_fd_);
+      db_fd_ = -1;
+      throw Exception("can't open an empty db file read-only");
+    }
+    // a new database file records its page size in its first page
+    std::vector<char> first_page(page_size_, 0);
+    memcpy(superblock.magic_, SUPERBLOCK_MAGIC, sizeof(SUPERBLOCK_MAGIC));
+    superblock.page_size_ = page_size_;
+    superblock.version_ = FREE_SPACE_MAP_VERSION;
+    memcpy(first_page.data(), &superblock, sizeof(superblock));
+    WriteAt(db_fd_, first_page.data(), page_size_, 0);
+    data_offset_ = page_size_;
+    has_free_space_map_ = true;
+  } else {
+    ReadAt(db_fd_, reinterpret_cast<char *>(&superblock), sizeof(superblock), 0);
+    if (memcmp(superblock.magic_, SUPERBLOCK_MAGIC, sizeof(SUPERBLOCK_MAGIC)) == 0) {
+      CheckPageSize(superblock.page_size_);
+      page_size_ = superblock.page_size_;
+      data_offset_ = page_size_;
+      has_free_space_map_ = superblock.version_ >= FREE_SPACE_MAP_VERSION;
+    } else {
+      // written before page sizes were configurable
+      page_size_ = BUSTUB_PAGE_SIZE;
+      data_offset_ = 0;
     }
   }
+  LoadFreeSpaceMap();
+  // the file has the disk space it needs so far, AllocatePage reserves more
+  reserved_end_ = lseek(db_fd_, 0, SEEK_END);
 
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+  // only now, the superblock is read and written with smaller, unaligned buffers
+  if (direct_io) {
+#if defined(__linux__)
+    int flags = fcntl(db_fd_, F_GETFL);
+    direct_io_ = flags >= 0 && fcntl(db_fd_, F_SETFL, flags | O_DIRECT) == 0;
+#elif defined(F_NOCACHE)
+    // macOS has no O_DIRECT, but can keep the pages of a file out of its cache
+    direct_io_ = fcntl(db_fd_, F_NOCACHE, 1) == 0;
+#endif
+    if (!direct_io_) {
+      LOG_INFO("the file system does not support direct I/O, falling back to buffered I/O");
     }
   }
   buffer_used = nullptr;
 }
 
+DiskManager::~DiskManager() {
+  if (db_fd_ >= 0) {
+    WriteFreeSpaceMap();
+    close(db_fd_);
+  }
+}
+
+void DiskManager::EnsureWritable() const {
+  if (read_only_) {
+    throw Exception(fmt::format("{} is open read-only", file_name_));
+  }
+}
+
+void DiskManager::CheckPageSize(size_t page_size) {
+  if (page_size < BUSTUB_PAGE_SIZE || page_size > BUSTUB_MAX_PAGE_SIZE || (page_size & (page_size - 1)) != 0) {
+    throw Exception(fmt::format("page size must be a power of two between {} and {}, got {}", BUSTUB_PAGE_SIZE,
+                                BUSTUB_MAX_PAGE_SIZE, page_size));
+  }
+}
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
-  {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+  if (db_fd_ >= 0) {
+    WriteFreeSpaceMap();
+    close(db_fd_);
+    db_fd_ = -1;
   }
   log_io_.close();
 }
@@ -78,46 +250,412 @@ void DiskManager::ShutDown() {
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
-  // set write cursor to offset
+  EnsureWritable();
+  if (db_fd_ < 0) {
+    LOG_DEBUG("no db file to write to");
+    return;
+  }
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, BUSTUB_PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG_DEBUG("I/O error while writing");
+  WriteBlock(page_data, PageOffset(page_id));
+  ForgetReadAhead(page_id);
+}
+
+void DiskManager::WriteBlock(const char *data, off_t offset) {
+  if (!IsAligned(data)) {
+    auto buffer = AllocateAligned(page_size_);
+    memcpy(buffer.get(), data, page_size_);
+    WriteAt(db_fd_, buffer.get(), page_size_, offset);
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  WriteAt(db_fd_, data, page_size_, offset);
+}
+
+/**
+ * Write the given pages, coalescing runs of consecutive page ids into one pwritev each
+ */
+void DiskManager::WritePages(std::vector<PageWrite> pages, bool sync) {
+  if (!pages.empty()) {
+    EnsureWritable();
+  }
+  std::sort(pages.begin(), pages.end(), [](const PageWrite &a, const PageWrite &b) { return a.first < b.first; });
+  if (db_fd_ < 0 || !AllAligned(pages)) {
+    // no file to write to, e.g. a disk manager in memory, or buffers that WritePage has to copy for direct I/O
+    for (const auto &[page_id, page_data] : pages) {
+      WritePage(page_id, page_data);
+    }
+    if (sync) {
+      Sync();
+    }
+    return;
+  }
+
+  std::vector<iovec> iov;
+  for (size_t begin = 0; begin < pages.size();) {
+    size_t end = begin + 1;
+    while (end < pages.size() && end - begin < IOV_MAX && IsNextOnDisk(pages[end - 1].first, pages[end].first)) {
+      end++;
+    }
+    iov.clear();
+    for (size_t i = begin; i < end; i++) {
+      iov.push_back({const_cast<char *>(pages[i].second), page_size_});
+    }
+    num_writes_ += static_cast<int>(end - begin);
+
+    auto offset = PageOffset(pages[begin].first);
+    auto *next = iov.data();
+    auto count = static_cast<int>(iov.size());
+    while (count > 0) {
+      auto written = pwritev(db_fd_, next, count, offset);
+      if (written < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        LOG_DEBUG("I/O error while writing");
+        return;
+      }
+      offset += written;
+      // skip what was written, the kernel may stop in the middle of a page
+      while (count > 0 && static_cast<size_t>(written) >= next->iov_len) {
+        written -= static_cast<ssize_t>(next->iov_len);
+        next++;
+        count--;
+      }
+      if (count > 0) {
+        next->iov_base = static_cast<char *>(next->iov_base) + written;
+        next->iov_len -= written;
+      }
+    }
+    for (size_t i = begin; i < end; i++) {
+      ForgetReadAhead(pages[i].first);
+    }
+    begin = end;
+  }
+  if (sync) {
+    Sync();
+  }
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * BUSTUB_PAGE_SIZE;
-  // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
-    LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, BUSTUB_PAGE_SIZE);
-    if (db_io_.bad()) {
-      LOG_DEBUG("I/O error while reading");
+  if (db_fd_ < 0) {
+    LOG_DEBUG("no db file to read from");
+    return;
+  }
+  if (read_ahead_ != nullptr) {
+    if (read_ahead_->Take(page_id, page_data) || (IsAligned(page_data) && ReadWithExtent(page_id, page_data))) {
       return;
     }
-    // if file ends before reading BUSTUB_PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < BUSTUB_PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+  }
+  auto offset = PageOffset(page_id);
+  size_t read_count;
+  if (IsAligned(page_data)) {
+    read_count = ReadAt(db_fd_, page_data, page_size_, offset);
+  } else {
+    auto buffer = AllocateAligned(page_size_);
+    read_count = ReadAt(db_fd_, buffer.get(), page_size_, offset);
+    memcpy(page_data, buffer.get(), read_count);
+  }
+  // the page is past the end of the file, or the file ends in the middle of it
+  memset(page_data + read_count, 0, page_size_ - read_count);
+}
+
+auto DiskManager::ReadWithExtent(page_id_t page_id, char *page_data) -> bool {
+  size_t max_pages = IOV_MAX - 1;
+  if (has_free_space_map_) {
+    // an extent stops short of the next map page
+    max_pages = std::min(max_pages, PagesPerMap() - 1 - static_cast<size_t>(page_id) % PagesPerMap());
+  }
+  auto buffers = read_ahead_->Plan(page_id, max_pages);
+  if (buffers.empty()) {
+    return false;
+  }
+  std::vector<iovec> iov{{page_data, page_size_}};
+  for (auto *buffer : buffers) {
+    iov.push_back({buffer, page_size_});
+  }
+  auto read_count = ReadVecAt(db_fd_, std::move(iov), PageOffset(page_id));
+  if (read_count < page_size_) {
+    memset(page_data + read_count, 0, page_size_ - read_count);
+  }
+  // pages of the extent past the end of the file are not staged, they read as zeros anyway
+  read_ahead_->Fill(page_id + 1, buffers, read_count / page_size_ > 0 ? read_count / page_size_ - 1 : 0);
+  return true;
+}
+
+/**
+ * Read the given pages, coalescing runs of consecutive page ids into one preadv each
+ */
+void DiskManager::ReadPages(std::vector<PageRead> pages) {
+  std::sort(pages.begin(), pages.end(), [](const PageRead &a, const PageRead &b) { return a.first < b.first; });
+  if (db_fd_ < 0 || !AllAligned(pages)) {
+    for (const auto &[page_id, page_data] : pages) {
+      ReadPage(page_id, page_data);
+    }
+    return;
+  }
+
+  std::vector<iovec> iov;
+  for (size_t begin = 0; begin < pages.size();) {
+    size_t end = begin + 1;
+    while (end < pages.size() && end - begin < IOV_MAX && IsNextOnDisk(pages[end - 1].first, pages[end].first)) {
+      end++;
+    }
+    iov.clear();
+    for (size_t i = begin; i < end; i++) {
+      iov.push_back({pages[i].second, page_size_});
+    }
+
+    auto offset = PageOffset(pages[begin].first);
+    auto *next = iov.data();
+    auto count = static_cast<int>(iov.size());
+    while (count > 0) {
+      auto read = preadv(db_fd_, next, count, offset);
+      if (read < 0 && errno == EINTR) {
+        continue;
+      }
+      if (read <= 0) {
+        if (read < 0) {
+          LOG_DEBUG("I/O error while reading");
+        }
+        // the rest of the run is past the end of the file
+        for (; count > 0; next++, count--) {
+          memset(next->iov_base, 0, next->iov_len);
+        }
+        break;
+      }
+      offset += read;
+      while (count > 0 && static_cast<size_t>(read) >= next->iov_len) {
+        read -= static_cast<ssize_t>(next->iov_len);
+        next++;
+        count--;
+      }
+      if (count > 0) {
+        next->iov_base = static_cast<char *>(next->iov_base) + read;
+        next->iov_len -= read;
+      }
+    }
+    begin = end;
+  }
+}
+
+/**
+ * Make the writes so far durable
+ */
+void DiskManager::Sync() {
+  if (db_fd_ < 0 || read_only_) {
+    return;
+  }
+  WriteFreeSpaceMap();
+#ifdef __linux__
+  int synced = fdatasync(db_fd_);
+#else
+  int synced = fsync(db_fd_);
+#endif
+  if (synced != 0) {
+    LOG_DEBUG("I/O error while syncing");
+  }
+}
+
+void DiskManager::EnableReadAhead(size_t staging_bytes) {
+  read_ahead_ = std::make_unique<DiskReadAhead>(page_size_, DIRECT_IO_ALIGNMENT, staging_bytes);
+}
+
+/**
+ * Hand out the lowest freed page of the stripe, or else the next page past the allocated ones
+ */
+auto DiskManager::AllocatePage(size_t stripe, size_t num_stripes, bool *reused, tablespace_id_t tablespace)
+    -> page_id_t {
+  BUSTUB_ENSURE(stripe < num_stripes, "stripe out of range");
+  BUSTUB_ENSURE(tablespace == DEFAULT_TABLESPACE, "no such tablespace");
+  EnsureWritable();
+  std::lock_guard<std::mutex> guard(free_space_latch_);
+  if (stripes_.size() != num_stripes) {
+    BuildStripes(num_stripes);
+  }
+  auto &free_pages = stripes_[stripe];
+  bool from_free = !free_pages.free_.empty();
+  page_id_t page_id;
+  if (from_free) {
+    page_id = free_pages.free_.back();
+    free_pages.free_.pop_back();
+  } else {
+    BUSTUB_ENSURE(free_pages.next_ < page_limit_, "the database file is full");
+    page_id = free_pages.next_;
+    free_pages.next_ += static_cast<page_id_t>(num_stripes);
+  }
+  SetPage(page_id, true);
+  num_pages_ = std::max(num_pages_, page_id + 1);
+  ReserveSpace(PageOffset(page_id) + static_cast<off_t>(page_size_));
+  if (reused != nullptr) {
+    *reused = from_free;
+  }
+  return page_id;
+}
+
+auto DiskManager::DeallocatePage(page_id_t page_id) -> bool {
+  EnsureWritable();
+  std::lock_guard<std::mutex> guard(free_space_latch_);
+  if (page_id < 0 || page_id >= num_pages_ || !TestPage(page_id)) {
+    return false;
+  }
+  SetPage(page_id, false);
+  if (!stripes_.empty()) {
+    // on top, it is not the lowest but was likely cached last
+    stripes_[page_id % stripes_.size()].free_.push_back(page_id);
+  }
+  return true;
+}
+
+auto DiskManager::IsAllocated(page_id_t page_id) -> bool {
+  std::lock_guard<std::mutex> guard(free_space_latch_);
+  return page_id >= 0 && page_id < num_pages_ && TestPage(page_id);
+}
+
+auto DiskManager::LimitPages(page_id_t page_limit) -> bool {
+  std::lock_guard<std::mutex> guard(free_space_latch_);
+  if (num_pages_ > page_limit) {
+    return false;
+  }
+  page_limit_ = page_limit;
+  return true;
+}
+
+auto DiskManager::GetNumPages() -> page_id_t {
+  std::lock_guard<std::mutex> guard(free_space_latch_);
+  return num_pages_;
+}
+
+auto DiskManager::GetFreeSpaceStats() -> FreeSpaceStats {
+  std::lock_guard<std::mutex> guard(free_space_latch_);
+  FreeSpaceStats stats{num_pages_, 0, 0, 0, 0};
+  size_t run = 0;
+  for (page_id_t page_id = 0; page_id < num_pages_; page_id++) {
+    if (TestPage(page_id)) {
+      stats.allocated_pages_++;
+      run = 0;
+      continue;
+    }
+    stats.free_pages_++;
+    if (run++ == 0) {
+      stats.free_runs_++;
+    }
+    stats.largest_free_run_ = std::max(stats.largest_free_run_, run);
+  }
+  return stats;
+}
+
+auto DiskManager::CreateTablespace() -> tablespace_id_t {
+  EnsureWritable();
+  return DEFAULT_TABLESPACE;
+}
+
+auto DiskManager::DropTablespace(tablespace_id_t tablespace) -> bool {
+  EnsureWritable();
+  return false;
+}
+
+auto DiskManager::TestPage(page_id_t page_id) const -> bool {
+  auto index = static_cast<size_t>(page_id);
+  auto map = index / PagesPerMap();
+  auto bit = index % PagesPerMap();
+  return map < maps_.size() && (maps_[map][bit / 8] & (1 << (bit % 8))) != 0;
+}
+
+void DiskManager::SetPage(page_id_t page_id, bool allocated) {
+  auto index = static_cast<size_t>(page_id);
+  auto map = index / PagesPerMap();
+  auto bit = index % PagesPerMap();
+  if (map >= maps_.size()) {
+    maps_.resize(map + 1, std::vector<char>(page_size_, 0));
+    dirty_maps_.resize(map + 1, false);
+  }
+  auto &byte = maps_[map][bit / 8];
+  if (allocated) {
+    byte = static_cast<char>(byte | (1 << (bit % 8)));
+  } else {
+    byte = static_cast<char>(byte & ~(1 << (bit % 8)));
+  }
+  dirty_maps_[map] = true;
+}
+
+void DiskManager::BuildStripes(size_t num_stripes) {
+  auto stride = static_cast<page_id_t>(num_stripes);
+  stripes_.assign(num_stripes, {});
+  for (size_t stripe = 0; stripe < num_stripes; stripe++) {
+    stripes_[stripe].next_ = static_cast<page_id_t>(stripe);
+  }
+  for (page_id_t page_id = 0; page_id < num_pages_; page_id++) {
+    if (TestPage(page_id)) {
+      stripes_[page_id % stride].next_ = page_id + stride;
+    }
+  }
+  // highest first, so that the lowest free page is on top
+  for (page_id_t page_id = num_pages_ - 1; page_id >= 0; page_id--) {
+    auto &stripe = stripes_[page_id % stride];
+    if (page_id < stripe.next_ && !TestPage(page_id)) {
+      stripe.free_.push_back(page_id);
+    }
+  }
+}
+
+void DiskManager::ReserveSpace(off_t end) {
+#ifdef __linux__
+  if (db_fd_ < 0 || reserved_end_ < 0 || end <= reserved_end_) {
+    return;
+  }
+  // whole extents, so that the file system hands out large runs of blocks and appends skip allocating them one by one
+  auto extent = static_cast<off_t>(DISK_EXTENT_BYTES);
+  auto length = (end - reserved_end_ + extent - 1) / extent * extent;
+  if (fallocate(db_fd_, FALLOC_FL_KEEP_SIZE, reserved_end_, length) != 0) {
+    LOG_DEBUG("the file system does not reserve disk space, the file grows a page at a time");
+    reserved_end_ = -1;
+    return;
+  }
+  reserved_end_ += length;
+#else
+  // only Linux reserves disk space without growing the file, and a longer file would read as more allocated pages
+#endif
+}
+
+void DiskManager::LoadFreeSpaceMap() {
+  struct stat stat_buf;
+  if (db_fd_ < 0 || fstat(db_fd_, &stat_buf) != 0 || static_cast<size_t>(stat_buf.st_size) <= data_offset_) {
+    return;
+  }
+  auto file_pages = (static_cast<size_t>(stat_buf.st_size) - data_offset_ + page_size_ - 1) / page_size_;
+  if (!has_free_space_map_) {
+    // every page in the file may be in use
+    for (size_t page = 0; page < file_pages; page++) {
+      SetPage(static_cast<page_id_t>(page), true);
+    }
+    num_pages_ = static_cast<page_id_t>(file_pages);
+    return;
+  }
+  auto num_maps = (file_pages + PagesPerMap()) / (PagesPerMap() + 1);
+  maps_.assign(num_maps, std::vector<char>(page_size_, 0));
+  dirty_maps_.assign(num_maps, false);
+  for (size_t map = 0; map < num_maps; map++) {
+    ReadAt(db_fd_, maps_[map].data(), page_size_, MapOffset(map));
+  }
+  for (auto page = static_cast<page_id_t>(num_maps * PagesPerMap()) - 1; page >= 0; page--) {
+    if (TestPage(page)) {
+      num_pages_ = page + 1;
+      break;
+    }
+  }
+}
+
+void DiskManager::WriteFreeSpaceMap() {
+  if (db_fd_ < 0 || !has_free_space_map_) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(free_space_latch_);
+  for (size_t map = 0; map < maps_.size(); map++) {
+    if (dirty_maps_[map]) {
+      WriteBlock(maps_[map].data(), MapOffset(map));
+      dirty_maps_[map] = false;
     }
   }
 }
@@ -127,6 +665,7 @@ void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
  * Only return when sync is done, and only perform sequence write
  */
 void DiskManager::WriteLog(char *log_data, int size) {
+  EnsureWritable();
   // enforce swap log buffer
   assert(log_data != buffer_used);
   buffer_used = log_data;
@@ -143,17 +682,25 @@ void DiskManager::WriteLog(char *log_data, int size) {
   }
 
   num_flushes_ += 1;
-  // sequence write
-  log_io_.write(log_data, size);
+  if (!AppendLog(log_data, size)) {
+    LOG_DEBUG("I/O error while writing log");
+    return;
+  }
+  flush_log_ = false;
+}
 
+/**
+ * Append to the log file and flush it, sequence write
+ */
+auto DiskManager::AppendLog(const char *log_data, int size) -> bool {
+  log_io_.write(log_data, size);
   // check for I/O error
   if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while writing log");
-    return;
+    return false;
   }
   // needs to flush to keep disk file in sync
   log_io_.flush();
-  flush_log_ = false;
+  return true;
 }
 
 /**
@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap.cpp
+//
+// Identification: src/storage/disk/disk_manager_mmap.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_mmap.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+DiskManagerMmap::DiskManagerMmap(const std::string &db_file)
+    : DiskManager(db_file, BUSTUB_PAGE_SIZE, false, true),
+      scan_extent_pages_(std::max<size_t>(READ_AHEAD_MAX_BYTES / page_size_, 1)) {
+  struct stat stat_buf;
+  if (db_fd_ < 0 || fstat(db_fd_, &stat_buf) != 0) {
+    throw Exception("can't open db file");
+  }
+  mapping_size_ = stat_buf.st_size;
+  void *mapping = mmap(nullptr, mapping_size_, PROT_READ, MAP_SHARED, db_fd_, 0);
+  if (mapping == MAP_FAILED) {
+    throw Exception("can't map db file");
+  }
+  mapping_ = static_cast<char *>(mapping);
+  // index lookups should fault in the page they read and nothing around it, scans ask for more themselves
+  if (madvise(mapping_, mapping_size_, MADV_RANDOM) != 0) {
+    LOG_DEBUG("madvise failed");
+  }
+}
+
+DiskManagerMmap::~DiskManagerMmap() {
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+  }
+}
+
+auto DiskManagerMmap::GetMappedPage(page_id_t page_id, bool scan) -> const char * {
+  auto offset = static_cast<size_t>(PageOffset(page_id));
+  if (page_id < 0 || offset + page_size_ > mapping_size_) {
+    return nullptr;
+  }
+  if (scan && static_cast<size_t>(page_id) % scan_extent_pages_ == 0) {
+    // at the start of every extent, ask for this one and the next, so the next is in memory once the scan gets there
+    auto length = std::min(2 * scan_extent_pages_ * page_size_, mapping_size_ - offset);
+    if (madvise(mapping_ + offset, length, MADV_WILLNEED) != 0) {
+      LOG_DEBUG("madvise failed");
+    }
+    num_scan_hints_++;
+  }
+  return mapping_ + offset;
+}
+
+void DiskManagerMmap::ReadPage(page_id_t page_id, char *page_data) {
+  const auto *data = GetMappedPage(page_id);
+  if (data == nullptr) {
+    memset(page_data, 0, page_size_);
+    return;
+  }
+  memcpy(page_data, data, page_size_);
+}
+
+void DiskManagerMmap::ReadPages(std::vector<PageRead> pages) {
+  for (const auto &[page_id, page_data] : pages) {
+    ReadPage(page_id, page_data);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,293 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_tablespaces.cpp
+//
+// Identification: src/storage/disk/disk_manager_tablespaces.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_tablespaces.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include <limits>
+#include <mutex>  // NOLINT
+#include <utility>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/macros.h"
+#include "fmt/format.h"
+
+namespace bustub {
+
+DiskManagerTablespaces::DiskManagerTablespaces(const std::string &db_file, size_t page_size, bool direct_io)
+    : DiskManager(db_file, page_size, direct_io), spaces_(MAX_TABLESPACES) {
+  for (tablespace_id_t tablespace = 1; tablespace < MAX_TABLESPACES; tablespace++) {
+    struct stat stat_buf;
+    if (stat(GetTablespaceFile(tablespace).c_str(), &stat_buf) == 0) {
+      spaces_[tablespace] = OpenSpace(tablespace);
+    }
+  }
+  if (!LimitDatabaseFile()) {
+    throw Exception(fmt::format("{} has grown into the page ids of its tablespaces", file_name_));
+  }
+}
+
+void DiskManagerTablespaces::ShutDown() {
+  {
+    std::unique_lock<std::shared_mutex> lock(spaces_latch_);
+    for (auto &space : spaces_) {
+      if (space != nullptr) {
+        space->ShutDown();
+      }
+    }
+  }
+  DiskManager::ShutDown();
+}
+
+auto DiskManagerTablespaces::GetTablespaceFile(tablespace_id_t tablespace) const -> std::string {
+  return fmt::format("{}.{}", file_name_, tablespace);
+}
+
+auto DiskManagerTablespaces::OpenSpace(tablespace_id_t tablespace) -> std::unique_ptr<DiskManager> {
+  // every file has the page size of the database file, which page ids and frames are sized for
+  auto space = std::unique_ptr<DiskManager>(
+      new DiskManager(GetTablespaceFile(tablespace), page_size_, direct_io_, read_only_, false));
+  if (space->GetPageSize() != page_size_) {
+    throw Exception(fmt::format("{} has another page size than {}", GetTablespaceFile(tablespace), file_name_));
+  }
+  // the page in the file is what is left of a page id below the tablespace
+  if (!space->LimitPages(TablespaceSize())) {
+    throw Exception(fmt::format("{} has more pages than a tablespace holds", GetTablespaceFile(tablespace)));
+  }
+  if (read_ahead_bytes_ > 0) {
+    space->EnableReadAhead(read_ahead_bytes_);
+  }
+  return space;
+}
+
+auto DiskManagerTablespaces::SpaceOf(tablespace_id_t tablespace) const -> DiskManager * {
+  if (tablespace <= DEFAULT_TABLESPACE || tablespace >= MAX_TABLESPACES) {
+    return nullptr;
+  }
+  return spaces_[tablespace].get();
+}
+
+auto DiskManagerTablespaces::FileTablespaceOf(page_id_t page_id) -> tablespace_id_t {
+  auto tablespace = TablespaceOf(page_id);
+  if (tablespace > DEFAULT_TABLESPACE && SpaceOf(tablespace) == nullptr && page_id < GetNumPages()) {
+    return DEFAULT_TABLESPACE;
+  }
+  return tablespace;
+}
+
+auto DiskManagerTablespaces::LimitDatabaseFile() -> bool {
+  for (tablespace_id_t tablespace = 1; tablespace < MAX_TABLESPACES; tablespace++) {
+    if (spaces_[tablespace] != nullptr) {
+      return LimitPages(FirstPageOf(tablespace));
+    }
+  }
+  return LimitPages(std::numeric_limits<page_id_t>::max());
+}
+
+auto DiskManagerTablespaces::HasTablespace(tablespace_id_t tablespace) -> bool {
+  std::shared_lock<std::shared_mutex> lock(spaces_latch_);
+  return tablespace == DEFAULT_TABLESPACE || SpaceOf(tablespace) != nullptr;
+}
+
+template <typename PageT>
+auto DiskManagerTablespaces::SplitByTablespace(std::vector<PageT> pages)
+    -> std::map<tablespace_id_t, std::vector<PageT>> {
+  std::map<tablespace_id_t, std::vector<PageT>> split;
+  for (auto &[page_id, page_data] : pages) {
+    auto tablespace = FileTablespaceOf(page_id);
+    // before any I/O, so that a batch is not done in part
+    BUSTUB_ENSURE(tablespace == DEFAULT_TABLESPACE || SpaceOf(tablespace) != nullptr, "no such tablespace");
+    split[tablespace].emplace_back(page_id - FirstPageOf(tablespace), page_data);
+  }
+  return split;
+}
+
+void DiskManagerTablespaces::WritePage(page_id_t page_id, const char *page_data) {
+  auto tablespace = TablespaceOf(page_id);
+  std::shared_lock<std::shared_mutex> lock(spaces_latch_, std::defer_lock);
+  if (tablespace != DEFAULT_TABLESPACE) {
+    lock.lock();
+    tablespace = FileTablespaceOf(page_id);
+  }
+  if (tablespace == DEFAULT_TABLESPACE) {
+    DiskManager::WritePage(page_id, page_data);
+    return;
+  }
+  auto *space = SpaceOf(tablespace);
+  BUSTUB_ENSURE(space != nullptr, "no such tablespace");
+  space->WritePage(page_id - FirstPageOf(tablespace), page_data);
+}
+
+void DiskManagerTablespaces::WritePages(std::vector<PageWrite> pages, bool sync) {
+  if (!pages.empty()) {
+    EnsureWritable();
+  }
+  std::shared_lock<std::shared_mutex> lock(spaces_latch_);
+  std::vector<DiskManager *> written;
+  for (auto &[tablespace, space_pages] : SplitByTablespace(std::move(pages))) {
+    if (tablespace == DEFAULT_TABLESPACE) {
+      // page ids of the database file are its own, as the split left them
+      DiskManager::WritePages(std::move(space_pages), false);
+      written.push_back(this);
+      continue;
+    }
+    auto *space = SpaceOf(tablespace);
+    space->WritePages(std::move(space_pages), false);
+    written.push_back(space);
+  }
+  if (!sync) {
+    return;
+  }
+  // only the files written to, one after the other
+  for (auto *space : written) {
+    if (space == this) {
+      DiskManager::Sync();
+    } else {
+      space->Sync();
+    }
+  }
+}
+
+void DiskManagerTablespaces::ReadPage(page_id_t page_id, char *page_data) {
+  auto tablespace = TablespaceOf(page_id);
+  std::shared_lock<std::shared_mutex> lock(spaces_latch_, std::defer_lock);
+  if (tablespace != DEFAULT_TABLESPACE) {
+    lock.lock();
+    tablespace = FileTablespaceOf(page_id);
+  }
+  if (tablespace == DEFAULT_TABLESPACE) {
+    DiskManager::ReadPage(page_id, page_data);
+    return;
+  }
+  auto *space = SpaceOf(tablespace);
+  BUSTUB_ENSURE(space != nullptr, "no such tablespace");
+  space->ReadPage(page_id - FirstPageOf(tablespace), page_data);
+}
+
+void DiskManagerTablespaces::ReadPages(std::vector<PageRead> pages) {
+  std::shared_lock<std::shared_mutex> lock(spaces_latch_);
+  for (auto &[tablespace, space_pages] : SplitByTablespace(std::move(pages))) {
+    if (tablespace == DEFAULT_TABLESPACE) {
+      DiskManager::ReadPages(std::move(space_pages));
+      continue;
+    }
+    SpaceOf(tablespace)->ReadPages(std::move(space_pages));
+  }
+}
+
+void DiskManagerTablespaces::Sync() {
+  DiskManager::Sync();
+  std::shared_lock<std::shared_mutex> lock(spaces_latch_);
+  for (auto &space : spaces_) {
+    if (space != nullptr) {
+      space->Sync();
+    }
+  }
+}
+
+auto DiskManagerTablespaces::AllocatePage(size_t stripe, size_t num_stripes, bool *reused, tablespace_id_t tablespace)
+    -> page_id_t {
+  if (tablespace == DEFAULT_TABLESPACE) {
+    return DiskManager::AllocatePage(stripe, num_stripes, reused);
+  }
+  BUSTUB_ENSURE(stripe < num_stripes, "stripe out of range");
+  std::shared_lock<std::shared_mutex> lock(spaces_latch_);
+  auto *space = SpaceOf(tablespace);
+  BUSTUB_ENSURE(space != nullptr, "no such tablespace");
+  auto first = FirstPageOf(tablespace);
+  // it is the page id that has to be in the stripe, not the page number in the file
+  auto space_stripe = (stripe + num_stripes - static_cast<size_t>(first) % num_stripes) % num_stripes;
+  // the file of the tablespace stops at TablespaceSize() pages, see OpenSpace
+  return first + space->AllocatePage(space_stripe, num_stripes, reused);
+}
+
+auto DiskManagerTablespaces::DeallocatePage(page_id_t page_id) -> bool {
+  auto tablespace = TablespaceOf(page_id);
+  std::shared_lock<std::shared_mutex> lock(spaces_latch_, std::defer_lock);
+  if (tablespace != DEFAULT_TABLESPACE) {
+    lock.lock();
+    tablespace = FileTablespaceOf(page_id);
+  }
+  if (tablespace == DEFAULT_TABLESPACE) {
+    return DiskManager::DeallocatePage(page_id);
+  }
+  auto *space = SpaceOf(tablespace);
+  return space != nullptr && space->DeallocatePage(page_id - FirstPageOf(tablespace));
+}
+
+auto DiskManagerTablespaces::IsAllocated(page_id_t page_id) -> bool {
+  auto tablespace = TablespaceOf(page_id);
+  std::shared_lock<std::shared_mutex> lock(spaces_latch_, std::defer_lock);
+  if (tablespace != DEFAULT_TABLESPACE) {
+    lock.lock();
+    tablespace = FileTablespaceOf(page_id);
+  }
+  if (tablespace == DEFAULT_TABLESPACE) {
+    return DiskManager::IsAllocated(page_id);
+  }
+  auto *space = SpaceOf(tablespace);
+  return space != nullptr && space->IsAllocated(page_id - FirstPageOf(tablespace));
+}
+
+auto DiskManagerTablespaces::CreateTablespace() -> tablespace_id_t {
+  EnsureWritable();
+  std::unique_lock<std::shared_mutex> lock(spaces_latch_);
+  bool lowest = true;
+  for (tablespace_id_t tablespace = 1; tablespace < MAX_TABLESPACES; tablespace++) {
+    if (spaces_[tablespace] != nullptr) {
+      lowest = false;
+      continue;
+    }
+    // the database file stops below the lowest tablespace, unless it has grown into its page ids already
+    if (lowest && !LimitPages(FirstPageOf(tablespace))) {
+      continue;
+    }
+    spaces_[tablespace] = OpenSpace(tablespace);
+    return tablespace;
+  }
+  throw Exception(fmt::format("{} has no room for another tablespace", file_name_));
+}
+
+auto DiskManagerTablespaces::DropTablespace(tablespace_id_t tablespace) -> bool {
+  EnsureWritable();
+  std::unique_ptr<DiskManager> space;
+  {
+    std::unique_lock<std::shared_mutex> lock(spaces_latch_);
+    if (SpaceOf(tablespace) == nullptr) {
+      return false;
+    }
+    space = std::move(spaces_[tablespace]);
+    // the database file may grow into the page ids of the tablespace from now on
+    LimitDatabaseFile();
+    // unlink before the id can be handed out again, the open file goes away with the last reference to it
+    if (unlink(GetTablespaceFile(tablespace).c_str()) != 0) {
+      LOG_DEBUG("can't unlink tablespace file");
+    }
+  }
+  space->ShutDown();
+  return true;
+}
+
+void DiskManagerTablespaces::EnableReadAhead(size_t staging_bytes) {
+  DiskManager::EnableReadAhead(staging_bytes);
+  read_ahead_bytes_ = staging_bytes;
+  std::unique_lock<std::shared_mutex> lock(spaces_latch_);
+  for (auto &space : spaces_) {
+    if (space != nullptr) {
+      space->EnableReadAhead(staging_bytes);
+    }
+  }
+}
+
+}  // namespace bustub
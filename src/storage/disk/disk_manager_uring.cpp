@@ -0,0 +1,243 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_uring.cpp
+//
+// Identification: src/storage/disk/disk_manager_uring.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_uring.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <utility>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+/** The user_data of a sync, told apart from the runs, which use their index. */
+static constexpr uint64_t SYNC_REQUEST = UINT64_MAX;
+
+DiskManagerUring::DiskManagerUring(const std::string &db_file, size_t page_size, bool use_uring, bool direct_io)
+    : DiskManager(db_file, page_size, direct_io) {
+  if (!use_uring) {
+    return;
+  }
+  auto ring = IoUring::Create(RING_ENTRIES);
+  if (ring == nullptr) {
+    LOG_INFO("io_uring is not available, falling back to pread/pwrite");
+    return;
+  }
+  rings_.push_back(std::move(ring));
+  uring_enabled_ = true;
+
+  if (!log_name_.empty()) {
+    log_fd_ = open(log_name_.c_str(), O_WRONLY);
+    struct stat stat_buf;
+    if (log_fd_ >= 0 && fstat(log_fd_, &stat_buf) == 0) {
+      log_offset_ = stat_buf.st_size;
+    }
+  }
+}
+
+DiskManagerUring::~DiskManagerUring() {
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+  }
+}
+
+template <typename PageT>
+auto DiskManagerUring::SplitRuns(std::vector<PageT> *pages, std::vector<iovec> *iov) const -> std::vector<Run> {
+  std::sort(pages->begin(), pages->end(), [](const PageT &a, const PageT &b) { return a.first < b.first; });
+  iov->clear();
+  for (const auto &[page_id, page_data] : *pages) {
+    iov->push_back({const_cast<char *>(page_data), page_size_});
+  }
+  std::vector<Run> runs;
+  for (size_t begin = 0; begin < pages->size();) {
+    size_t end = begin + 1;
+    while (end < pages->size() && end - begin < IOV_MAX && IsNextOnDisk((*pages)[end - 1].first, (*pages)[end].first)) {
+      end++;
+    }
+    runs.push_back({begin, end, PageOffset((*pages)[begin].first)});
+    begin = end;
+  }
+  return runs;
+}
+
+auto DiskManagerUring::SubmitRuns(bool is_write, const std::vector<Run> &runs, std::vector<iovec> *iov, bool sync)
+    -> std::vector<Run> {
+  auto ring = AcquireRing();
+  if (ring == nullptr) {
+    return runs;
+  }
+  std::vector<Run> incomplete;
+  for (size_t next = 0; next < runs.size();) {
+    // fill the ring, keeping an entry for the sync after the last run
+    size_t first = next;
+    while (next < runs.size() && ring->GetNumFree() > (sync ? 1 : 0)) {
+      const auto &run = runs[next];
+      auto count = static_cast<unsigned>(run.end_ - run.begin_);
+      if (is_write) {
+        ring->PrepareWritev(db_fd_, iov->data() + run.begin_, count, run.offset_, next);
+      } else {
+        ring->PrepareReadv(db_fd_, iov->data() + run.begin_, count, run.offset_, next);
+      }
+      next++;
+    }
+    bool with_sync = sync && next == runs.size();
+    if (with_sync) {
+      // runs after it in the batch that fail are redone by the caller, which syncs again
+      ring->PrepareFdatasync(db_fd_, true, SYNC_REQUEST);
+    }
+    auto num_requests = static_cast<unsigned>(next - first) + (with_sync ? 1 : 0);
+    if (!ring->Submit(num_requests)) {
+      // the ring is unusable, leave the rest to the caller
+      LOG_DEBUG("io_uring submission failed");
+      incomplete.insert(incomplete.end(), runs.begin() + first, runs.end());
+      return incomplete;
+    }
+    num_submits_++;
+    for (unsigned i = 0; i < num_requests; i++) {
+      uint64_t request;
+      int32_t result;
+      if (!ring->PopCompletion(&request, &result, true)) {
+        LOG_DEBUG("waiting for io_uring completions failed");
+        incomplete.insert(incomplete.end(), runs.begin() + first, runs.end());
+        return incomplete;
+      }
+      if (request == SYNC_REQUEST) {
+        if (result < 0) {
+          LOG_DEBUG("I/O error while syncing");
+        }
+        continue;
+      }
+      const auto &run = runs[request];
+      if (result < 0 || static_cast<size_t>(result) != (run.end_ - run.begin_) * page_size_) {
+        incomplete.push_back(run);
+      }
+    }
+  }
+  ReleaseRing(std::move(ring));
+  return incomplete;
+}
+
+void DiskManagerUring::WritePages(std::vector<PageWrite> pages, bool sync) {
+  if (!uring_enabled_ || db_fd_ < 0 || !AllAligned(pages)) {
+    DiskManager::WritePages(std::move(pages), sync);
+    return;
+  }
+  if (sync) {
+    // the sync after the pages covers the map too
+    WriteFreeSpaceMap();
+  }
+  std::vector<iovec> iov;
+  auto runs = SplitRuns(&pages, &iov);
+  num_writes_ += static_cast<int>(pages.size());
+  auto incomplete = SubmitRuns(true, runs, &iov, sync);
+  for (const auto &run : incomplete) {
+    // a short or failed write, which the DiskManager code retries
+    num_writes_ -= static_cast<int>(run.end_ - run.begin_);
+    DiskManager::WritePages({pages.begin() + run.begin_, pages.begin() + run.end_}, false);
+  }
+  for (const auto &[page_id, page_data] : pages) {
+    ForgetReadAhead(page_id);
+  }
+  if (sync && !incomplete.empty()) {
+    Sync();
+  }
+}
+
+void DiskManagerUring::ReadPages(std::vector<PageRead> pages) {
+  if (!uring_enabled_ || db_fd_ < 0 || !AllAligned(pages)) {
+    DiskManager::ReadPages(std::move(pages));
+    return;
+  }
+  std::vector<iovec> iov;
+  auto runs = SplitRuns(&pages, &iov);
+  for (const auto &run : SubmitRuns(false, runs, &iov, false)) {
+    // a run that reaches past the end of the file, which the DiskManager code zero-fills
+    DiskManager::ReadPages({pages.begin() + run.begin_, pages.begin() + run.end_});
+  }
+}
+
+auto DiskManagerUring::AppendLog(const char *log_data, int size) -> bool {
+  if (log_fd_ < 0) {
+    return DiskManager::AppendLog(log_data, size);
+  }
+  size_t done = 0;
+  bool synced = false;
+  auto ring = AcquireRing();
+  if (ring != nullptr) {
+    // the write and the sync that makes it durable, in one submission
+    iovec iov{const_cast<char *>(log_data), static_cast<size_t>(size)};
+    ring->PrepareWritev(log_fd_, &iov, 1, log_offset_, 0);
+    ring->PrepareFdatasync(log_fd_, false, SYNC_REQUEST);
+    ring->LinkToPrevious();
+    bool ok = ring->Submit(2);
+    for (int i = 0; ok && i < 2; i++) {
+      uint64_t request;
+      int32_t result;
+      ok = ring->PopCompletion(&request, &result, true);
+      if (ok && request == SYNC_REQUEST) {
+        synced = result == 0;
+      } else if (ok) {
+        done = std::max(result, 0);
+      }
+    }
+    if (ok) {
+      num_submits_++;
+      ReleaseRing(std::move(ring));
+    } else {
+      // drop the ring, and write all of the buffer by hand
+      LOG_DEBUG("io_uring submission failed");
+      done = 0;
+      synced = false;
+    }
+  }
+  // a short or failed write cancels the linked sync, finish both by hand
+  while (done < static_cast<size_t>(size)) {
+    auto n = pwrite(log_fd_, log_data + done, size - done, log_offset_ + static_cast<off_t>(done));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      return false;
+    }
+    done += n;
+  }
+  log_offset_ += size;
+#ifdef __linux__
+  return synced || fdatasync(log_fd_) == 0;
+#else
+  return synced || fsync(log_fd_) == 0;
+#endif
+}
+
+auto DiskManagerUring::AcquireRing() -> std::unique_ptr<IoUring> {
+  {
+    std::lock_guard<std::mutex> guard(rings_latch_);
+    if (!rings_.empty()) {
+      auto ring = std::move(rings_.back());
+      rings_.pop_back();
+      return ring;
+    }
+  }
+  return IoUring::Create(RING_ENTRIES);
+}
+
+void DiskManagerUring::ReleaseRing(std::unique_ptr<IoUring> ring) {
+  std::lock_guard<std::mutex> guard(rings_latch_);
+  rings_.push_back(std::move(ring));
+}
+
+}  // namespace bustub
@@ -0,0 +1,191 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_read_ahead.cpp
+//
+// Identification: src/storage/disk/disk_read_ahead.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_read_ahead.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+DiskReadAhead::DiskReadAhead(size_t page_size, size_t alignment, size_t staging_bytes, size_t min_extent_bytes,
+                             size_t max_extent_bytes)
+    : page_size_(page_size),
+      num_slots_(std::max<size_t>(staging_bytes / page_size, 1)),
+      min_extent_pages_(std::max<size_t>(min_extent_bytes / page_size, 1)),
+      max_extent_pages_(std::max(max_extent_bytes / page_size, min_extent_pages_)),
+      buffers_(static_cast<char *>(std::aligned_alloc(alignment, num_slots_ * page_size)), &std::free) {
+  BUSTUB_ENSURE(buffers_ != nullptr, "cannot allocate the read-ahead staging area");
+  for (size_t slot = num_slots_; slot-- > 0;) {
+    free_slots_.push_back(slot);
+  }
+}
+
+auto DiskReadAhead::Take(page_id_t page_id, char *page_data) -> bool {
+  if (num_tracked_ == 0) {
+    return false;
+  }
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = staged_.find(page_id);
+  if (it == staged_.end()) {
+    return false;
+  }
+  memcpy(page_data, SlotData(it->second.slot_), page_size_);
+  Unstage(it);
+  stats_.hits_++;
+  auto &stream = StreamOf();
+  stream.next_ = page_id + 1;
+  stream.run_++;
+  return true;
+}
+
+auto DiskReadAhead::Plan(page_id_t page_id, size_t max_pages) -> std::vector<char *> {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto &stream = StreamOf();
+  bool sequential = page_id == stream.next_;
+  stream.next_ = page_id + 1;
+  stream.run_ = sequential ? stream.run_ + 1 : 1;
+  if (stream.run_ < TRIGGER_PAGES) {
+    stream.extent_pages_ = min_extent_pages_;
+    stream.ahead_end_ = INVALID_PAGE_ID;
+    return {};
+  }
+  auto num_pages = stream.extent_pages_;
+  if (page_id < stream.ahead_end_) {
+    // the last extent left the staging area before the stream got to this page, read less ahead
+    num_pages = std::max(num_pages / 2, min_extent_pages_);
+    stream.extent_pages_ = num_pages;
+  } else {
+    stream.extent_pages_ = std::min(num_pages * 2, max_extent_pages_);
+  }
+  auto first = page_id + 1;
+  num_pages = std::min({num_pages, max_pages, num_slots_});
+  for (size_t i = 0; i < num_pages; i++) {
+    // stop at pages read ahead already, e.g. by another thread scanning the same pages
+    if (IsAhead(first + static_cast<page_id_t>(i))) {
+      num_pages = i;
+    }
+  }
+  if (num_pages == 0) {
+    return {};
+  }
+
+  std::vector<char *> buffers;
+  size_t first_slot = 0;
+  while (buffers.size() < num_pages) {
+    if (free_slots_.empty()) {
+      if (order_.empty()) {
+        // every buffer is in an extent in flight
+        break;
+      }
+      Unstage(staged_.find(order_.front()));
+      stats_.wasted_++;
+    }
+    auto slot = free_slots_.back();
+    free_slots_.pop_back();
+    if (buffers.empty()) {
+      first_slot = slot;
+    }
+    buffers.push_back(SlotData(slot));
+  }
+  if (buffers.empty()) {
+    return {};
+  }
+  stream.ahead_end_ = first + static_cast<page_id_t>(buffers.size());
+  in_flight_.push_back({first, buffers.size(), first_slot, {}});
+  num_tracked_ += buffers.size();
+  stats_.extents_++;
+  return buffers;
+}
+
+void DiskReadAhead::Fill(page_id_t first, const std::vector<char *> &buffers, size_t num_read) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto first_slot = static_cast<size_t>(buffers.front() - buffers_.get()) / page_size_;
+  auto extent = std::find_if(in_flight_.begin(), in_flight_.end(),
+                             [first_slot](const InFlight &e) { return e.first_slot_ == first_slot; });
+  BUSTUB_ENSURE(extent != in_flight_.end(), "the extent was not planned");
+  const auto &written = extent->written_;
+  for (size_t i = 0; i < buffers.size(); i++) {
+    auto slot = static_cast<size_t>(buffers[i] - buffers_.get()) / page_size_;
+    auto page_id = first + static_cast<page_id_t>(i);
+    bool stale = std::find(written.begin(), written.end(), page_id) != written.end();
+    if (i < num_read && !stale && staged_.count(page_id) == 0) {
+      order_.push_back(page_id);
+      staged_.emplace(page_id, Staged{slot, std::prev(order_.end())});
+      continue;
+    }
+    free_slots_.push_back(slot);
+    num_tracked_--;
+    if (i < num_read) {
+      stats_.wasted_++;
+    }
+  }
+  stats_.pages_read_ahead_ += num_read;
+  in_flight_.erase(extent);
+}
+
+void DiskReadAhead::Invalidate(page_id_t page_id) {
+  if (num_tracked_ == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(latch_);
+  if (auto it = staged_.find(page_id); it != staged_.end()) {
+    Unstage(it);
+    stats_.wasted_++;
+  }
+  for (auto &extent : in_flight_) {
+    if (extent.Contains(page_id)) {
+      extent.written_.push_back(page_id);
+    }
+  }
+}
+
+auto DiskReadAhead::GetStats() -> Stats {
+  std::lock_guard<std::mutex> guard(latch_);
+  return stats_;
+}
+
+auto DiskReadAhead::StreamOf() -> Stream & {
+  auto thread = std::this_thread::get_id();
+  clock_++;
+  for (auto &stream : streams_) {
+    if (stream.thread_ == thread) {
+      stream.last_used_ = clock_;
+      return stream;
+    }
+  }
+  Stream stream{thread, INVALID_PAGE_ID, INVALID_PAGE_ID, 0, min_extent_pages_, clock_};
+  if (streams_.size() < MAX_STREAMS) {
+    streams_.push_back(stream);
+    return streams_.back();
+  }
+  auto &idle = *std::min_element(streams_.begin(), streams_.end(),
+                                 [](const Stream &a, const Stream &b) { return a.last_used_ < b.last_used_; });
+  idle = stream;
+  return idle;
+}
+
+auto DiskReadAhead::IsAhead(page_id_t page_id) const -> bool {
+  return staged_.count(page_id) > 0 ||
+         std::any_of(in_flight_.begin(), in_flight_.end(), [page_id](const auto &e) { return e.Contains(page_id); });
+}
+
+void DiskReadAhead::Unstage(std::unordered_map<page_id_t, Staged>::iterator it) {
+  free_slots_.push_back(it->second.slot_);
+  order_.erase(it->second.order_);
+  staged_.erase(it);
+  num_tracked_--;
+}
+
+}  // namespace bustub
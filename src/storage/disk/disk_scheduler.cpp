@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.cpp
+//
+// Identification: src/storage/disk/disk_scheduler.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_scheduler.h"
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+namespace bustub {
+
+DiskScheduler::DiskScheduler(DiskManager *disk_manager, size_t num_workers)
+    : disk_manager_(disk_manager), num_workers_(num_workers) {
+  BUSTUB_ENSURE(num_workers > 0, "a disk scheduler needs at least one worker");
+  for (size_t i = 0; i < num_workers; i++) {
+    workers_.emplace_back(&DiskScheduler::RunWorker, this);
+  }
+}
+
+DiskScheduler::~DiskScheduler() {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void DiskScheduler::Schedule(DiskRequest request) {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    BUSTUB_ENSURE(!stop_, "the disk scheduler is shutting down");
+    queue_.push_back(std::move(request));
+  }
+  cv_.notify_one();
+}
+
+auto DiskScheduler::ScheduleRead(page_id_t page_id, char *data) -> std::future<bool> {
+  auto promise = CreatePromise();
+  auto future = promise.get_future();
+  Schedule({false, data, page_id, std::move(promise)});
+  return future;
+}
+
+auto DiskScheduler::ScheduleWrite(page_id_t page_id, const char *data) -> std::future<bool> {
+  auto promise = CreatePromise();
+  auto future = promise.get_future();
+  // the data is only read from, DiskRequest just has one buffer for both directions
+  Schedule({true, const_cast<char *>(data), page_id, std::move(promise)});
+  return future;
+}
+
+auto DiskScheduler::GetNumBatches() -> size_t {
+  std::lock_guard<std::mutex> guard(latch_);
+  return num_batches_;
+}
+
+void DiskScheduler::RunWorker() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    auto batch = TakeBatch();
+    if (batch.empty()) {
+      if (stop_ && queue_.empty()) {
+        return;
+      }
+      // nothing queued, or only requests waiting for a page in flight
+      cv_.wait(lock);
+      continue;
+    }
+    num_batches_++;
+    lock.unlock();
+    ServiceBatch(&batch);
+    lock.lock();
+    for (const auto &request : batch) {
+      in_flight_.erase(request.page_id_);
+    }
+    // requests held back by these pages may run now
+    cv_.notify_all();
+  }
+}
+
+auto DiskScheduler::TakeBatch() -> std::vector<DiskRequest> {
+  std::vector<DiskRequest> batch;
+  // leave a share of the queue to the other workers, so that requests that cannot be merged still run in parallel
+  auto max_batch = std::min(DISK_SCHEDULER_BATCH, (queue_.size() + num_workers_ - 1) / num_workers_);
+  // pages of requests left in the queue, which later requests for the same page must not overtake
+  std::unordered_set<page_id_t> held_back;
+  for (auto it = queue_.begin(); it != queue_.end() && batch.size() < max_batch;) {
+    auto page_id = it->page_id_;
+    if (in_flight_.count(page_id) > 0 || held_back.count(page_id) > 0) {
+      held_back.insert(page_id);
+      ++it;
+      continue;
+    }
+    in_flight_.insert(page_id);
+    batch.push_back(std::move(*it));
+    it = queue_.erase(it);
+  }
+  return batch;
+}
+
+void DiskScheduler::ServiceBatch(std::vector<DiskRequest> *batch) {
+  std::vector<DiskManager::PageWrite> writes;
+  std::vector<DiskManager::PageRead> reads;
+  for (const auto &request : *batch) {
+    if (request.is_write_) {
+      writes.emplace_back(request.page_id_, request.data_);
+    } else {
+      reads.emplace_back(request.page_id_, request.data_);
+    }
+  }
+  try {
+    // the batch has at most one request per page, so the order between them does not matter
+    if (!writes.empty()) {
+      disk_manager_->WritePages(std::move(writes), false);
+    }
+    if (!reads.empty()) {
+      disk_manager_->ReadPages(std::move(reads));
+    }
+  } catch (...) {
+    for (auto &request : *batch) {
+      request.callback_.set_exception(std::current_exception());
+    }
+    return;
+  }
+  for (auto &request : *batch) {
+    request.callback_.set_value(true);
+  }
+}
+
+}  // namespace bustub
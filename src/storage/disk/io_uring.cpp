@@ -0,0 +1,189 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_uring.cpp
+//
+// Identification: src/storage/disk/io_uring.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#ifdef __linux__
+
+#include "storage/disk/io_uring.h"
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace bustub {
+
+static auto SysSetup(unsigned entries, io_uring_params *params) -> int {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static auto SysEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) -> int {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+/** Points at offset bytes into a mmaped ring. */
+template <typename T>
+static auto RingField(void *ring, uint32_t offset) -> T * {
+  return reinterpret_cast<T *>(static_cast<char *>(ring) + offset);
+}
+
+auto IoUring::Create(unsigned entries) -> std::unique_ptr<IoUring> {
+  io_uring_params params{};
+  int ring_fd = SysSetup(entries, &params);
+  if (ring_fd < 0) {
+    // ENOSYS before Linux 5.1, EPERM where io_uring is disabled or filtered
+    return nullptr;
+  }
+  std::unique_ptr<IoUring> ring(new IoUring());
+  ring->ring_fd_ = ring_fd;
+  ring->sq_entries_ = params.sq_entries;
+
+  ring->sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring->cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    // both rings share one mapping
+    ring->sq_ring_size_ = ring->cq_ring_size_ = std::max(ring->sq_ring_size_, ring->cq_ring_size_);
+  }
+  ring->sq_ring_ = mmap(nullptr, ring->sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                        IORING_OFF_SQ_RING);
+  if (ring->sq_ring_ == MAP_FAILED) {
+    ring->sq_ring_ = nullptr;
+    return nullptr;
+  }
+  if (single_mmap) {
+    ring->cq_ring_ = ring->sq_ring_;
+  } else {
+    ring->cq_ring_ = mmap(nullptr, ring->cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                          IORING_OFF_CQ_RING);
+    if (ring->cq_ring_ == MAP_FAILED) {
+      ring->cq_ring_ = nullptr;
+      return nullptr;
+    }
+  }
+  ring->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void *sqes =
+      mmap(nullptr, ring->sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    return nullptr;
+  }
+  ring->sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+  ring->sq_tail_ = RingField<unsigned>(ring->sq_ring_, params.sq_off.tail);
+  ring->sq_mask_ = RingField<unsigned>(ring->sq_ring_, params.sq_off.ring_mask);
+  ring->sq_array_ = RingField<unsigned>(ring->sq_ring_, params.sq_off.array);
+  ring->cq_head_ = RingField<unsigned>(ring->cq_ring_, params.cq_off.head);
+  ring->cq_tail_ = RingField<unsigned>(ring->cq_ring_, params.cq_off.tail);
+  ring->cq_mask_ = RingField<unsigned>(ring->cq_ring_, params.cq_off.ring_mask);
+  ring->cqes_ = RingField<io_uring_cqe>(ring->cq_ring_, params.cq_off.cqes);
+  return ring;
+}
+
+IoUring::~IoUring() {
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+  }
+}
+
+auto IoUring::NextSqe() -> io_uring_sqe * {
+  BUSTUB_ENSURE(num_prepared_ < sq_entries_, "the submission queue is full");
+  // only this thread moves the tail, the kernel only moves the head
+  unsigned index = (*sq_tail_ + num_prepared_) & *sq_mask_;
+  num_prepared_++;
+  auto *sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sq_array_[index] = index;
+  return sqe;
+}
+
+void IoUring::PrepareReadv(int fd, const iovec *iov, unsigned count, off_t offset, uint64_t user_data) {
+  auto *sqe = NextSqe();
+  sqe->opcode = IORING_OP_READV;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(iov);
+  sqe->len = count;
+  sqe->off = offset;
+  sqe->user_data = user_data;
+}
+
+void IoUring::PrepareWritev(int fd, const iovec *iov, unsigned count, off_t offset, uint64_t user_data) {
+  auto *sqe = NextSqe();
+  sqe->opcode = IORING_OP_WRITEV;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(iov);
+  sqe->len = count;
+  sqe->off = offset;
+  sqe->user_data = user_data;
+}
+
+void IoUring::PrepareFdatasync(int fd, bool after_all, uint64_t user_data) {
+  auto *sqe = NextSqe();
+  sqe->opcode = IORING_OP_FSYNC;
+  sqe->fd = fd;
+  sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+  sqe->flags = after_all ? IOSQE_IO_DRAIN : 0;
+  sqe->user_data = user_data;
+}
+
+void IoUring::LinkToPrevious() {
+  BUSTUB_ENSURE(num_prepared_ >= 2, "nothing to link to");
+  unsigned previous = (*sq_tail_ + num_prepared_ - 2) & *sq_mask_;
+  sqes_[previous].flags |= IOSQE_IO_LINK;
+}
+
+auto IoUring::Submit(unsigned min_complete) -> bool {
+  // publish the prepared entries before the kernel can look at the new tail
+  __atomic_store_n(sq_tail_, *sq_tail_ + num_prepared_, __ATOMIC_RELEASE);
+  unsigned to_submit = num_prepared_;
+  num_prepared_ = 0;
+  while (to_submit > 0) {
+    int submitted = SysEnter(ring_fd_, to_submit, min_complete, min_complete > 0 ? IORING_ENTER_GETEVENTS : 0);
+    if (submitted < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    to_submit -= static_cast<unsigned>(submitted);
+  }
+  return true;
+}
+
+auto IoUring::PopCompletion(uint64_t *user_data, int32_t *result, bool wait) -> bool {
+  // only this thread moves the head, the kernel only moves the tail
+  unsigned head = *cq_head_;
+  while (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+    if (!wait || (SysEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)) {
+      return false;
+    }
+  }
+  const auto &cqe = cqes_[head & *cq_mask_];
+  *user_data = cqe.user_data;
+  *result = cqe.res;
+  __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+}  // namespace bustub
+
+#endif  // __linux__
@@ -0,0 +1,43 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_uring_unsupported.cpp
+//
+// Identification: src/storage/disk/io_uring_unsupported.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/io_uring.h"
+
+namespace bustub {
+
+// io_uring is Linux only. No ring is ever set up elsewhere, so DiskManagerUring always uses the DiskManager code.
+
+auto IoUring::Create(unsigned entries) -> std::unique_ptr<IoUring> { return nullptr; }
+
+IoUring::~IoUring() = default;
+
+auto IoUring::NextSqe() -> io_uring_sqe * { UNREACHABLE("io_uring is not supported"); }
+
+void IoUring::PrepareReadv(int fd, const iovec *iov, unsigned count, off_t offset, uint64_t user_data) {
+  UNREACHABLE("io_uring is not supported");
+}
+
+void IoUring::PrepareWritev(int fd, const iovec *iov, unsigned count, off_t offset, uint64_t user_data) {
+  UNREACHABLE("io_uring is not supported");
+}
+
+void IoUring::PrepareFdatasync(int fd, bool after_all, uint64_t user_data) { UNREACHABLE("io_uring is not supported"); }
+
+void IoUring::LinkToPrevious() { UNREACHABLE("io_uring is not supported"); }
+
+auto IoUring::Submit(unsigned min_complete) -> bool { UNREACHABLE("io_uring is not supported"); }
+
+auto IoUring::PopCompletion(uint64_t *user_data, int32_t *result, bool wait) -> bool {
+  UNREACHABLE("io_uring is not supported");
+}
+
+}  // namespace bustub
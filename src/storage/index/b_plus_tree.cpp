@@ -1,5 +1,7 @@
+#include <optional>
 #include <sstream>
 #include <string>
+#include <thread>  // NOLINT
 
 #include "common/config.h"
 #include "common/exception.h"
@@ -16,13 +18,15 @@ namespace bustub {
 
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, page_id_t header_page_id, BufferPoolManager *buffer_pool_manager,
-                          const KeyComparator &comparator, int leaf_max_size, int internal_max_size)
+                          const KeyComparator &comparator, int leaf_max_size, int internal_max_size,
+                          tablespace_id_t tablespace)
     : index_name_(std::move(name)),
       bpm_(buffer_pool_manager),
       comparator_(std::move(comparator)),
       leaf_max_size_(leaf_max_size),
       internal_max_size_(internal_max_size),
-      header_page_id_(header_page_id) {
+      header_page_id_(header_page_id),
+      tablespace_(tablespace) {
   WritePageGuard guard = bpm_->FetchPageWrite(header_page_id_);
   auto root_page = guard.AsMut<BPlusTreeHeaderPage>();
   root_page->root_page_id_ = INVALID_PAGE_ID;
@@ -55,6 +59,15 @@ auto BPLUSTREE_TYPE::IsEmpty() const -> bool {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *txn) -> bool {
+  for (int attempt = 0; attempt < OPTIMISTIC_READ_ATTEMPTS; attempt++) {
+    auto is_success = OptimisticGetValue(key, result);
+    if (is_success.has_value()) {
+      return *is_success;
+    }
+    std::this_thread::yield();
+  }
+
+  // Writers kept changing the path, take the read latches so they have to wait for us instead.
   // Declaration of context instance.
   Context ctx;
   (void)ctx;
@@ -77,6 +90,67 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
   return is_success;
 }
 
+/*
+ * Lookup without latches: every page on the path is read optimistically and validated before anything read from it is
+ * used. A child is only fetched once its parent validated, and the parent validates again after the child is pinned,
+ * so the version recorded for the child predates any split or merge that could move the key elsewhere.
+ * @return : whether the key exists, or nullopt if a writer got in the way and the lookup has to restart
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::OptimisticGetValue(const KeyType &key, std::vector<ValueType> *result) -> std::optional<bool> {
+  auto parent_guard = bpm_->FetchPageOptimistic(header_page_id_);
+  if (parent_guard.GetData() == nullptr) {
+    // every frame is pinned
+    return std::nullopt;
+  }
+  page_id_t page_id = parent_guard.As<BPlusTreeHeaderPage>()->root_page_id_;
+  if (!parent_guard.Validate()) {
+    return std::nullopt;
+  }
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+
+  while (true) {
+    auto page_guard = bpm_->FetchPageOptimistic(page_id);
+    if (page_guard.GetData() == nullptr || !parent_guard.Validate()) {
+      return std::nullopt;
+    }
+    parent_guard = std::move(page_guard);
+    // Writers only ever store sizes that fit the page, so a page read half-way through an update gives a wrong answer
+    // but never reads past the page. The answer is only used after validation.
+    if (parent_guard.As<BPlusTreePage>()->IsLeafPage()) {
+      break;
+    }
+    auto *internal_page = parent_guard.As<InternalPage>();
+    int i = internal_page->Lookup(key, comparator_);
+    if (i != internal_page->GetSize() && comparator_(key, internal_page->KeyAt(i)) == 0) {
+      page_id = internal_page->GetValue(i);
+    } else {
+      page_id = internal_page->GetValue(i - 1);
+    }
+    if (!parent_guard.Validate()) {
+      return std::nullopt;
+    }
+  }
+
+  auto *leaf_page = parent_guard.As<LeafPage>();
+  int i = leaf_page->Lookup(key, comparator_);
+  bool is_success = i >= 0 && i < leaf_page->GetSize() && comparator_(leaf_page->KeyAt(i), key) == 0;
+  ValueType value{};
+  if (is_success) {
+    value = leaf_page->ValueAt(i);
+  }
+  if (!parent_guard.Validate()) {
+    return std::nullopt;
+  }
+  if (is_success) {
+    BUSTUB_ASSERT(result != nullptr, "result not nullptr");
+    result->push_back(value);
+  }
+  return is_success;
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
@@ -130,7 +204,7 @@ auto BPLUSTREE_TYPE::InsertGetKeyAt(const KeyType &key, const KeyComparator &com
   ctx.header_page_ = std::move(header_page_guard);
   page_id_t root_page_id = header_page->root_page_id_;
   if (root_page_id == INVALID_PAGE_ID) {
-    bpm_->NewPageGuarded(&root_page_id);
+    bpm_->NewPageGuarded(&root_page_id, tablespace_);
     auto write_guard = bpm_->FetchPageWrite(root_page_id);
     auto *p_leaf_page = write_guard.AsMut<BPlusTree::LeafPage>();
     p_leaf_page->SetPageType(IndexPageType::LEAF_PAGE);
@@ -197,7 +271,7 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
     } else {
       // If there is not enough space in the leaf page, create a new leaf page and redistribute the keys.
       page_id_t leaf_page_id_new;
-      bpm_->NewPageGuarded(&leaf_page_id_new);
+      bpm_->NewPageGuarded(&leaf_page_id_new, tablespace_);
       // 加读锁获取页面
       auto leaf_page_new_guard = bpm_->FetchPageWrite(leaf_page_id_new);
       auto *leaf_page_new = leaf_page_new_guard.template AsMut<B_PLUS_TREE_LEAF_PAGE_TYPE>();
@@ -244,7 +318,7 @@ void BPLUSTREE_TYPE::InsertIntoParent(page_id_t leaf_page_left_id, KeyType key,
   if (root_page_id == leaf_page_left_id) {
     // leafPage is root page
     page_id_t root_page_new_id;
-    bpm_->NewPageGuarded(&root_page_new_id);
+    bpm_->NewPageGuarded(&root_page_new_id, tablespace_);
 
     // Find the leaf page where the key-value pair should be inserted.
     auto root_page_new_guard = bpm_->FetchPageWrite(root_page_new_id);
@@ -269,7 +343,7 @@ void BPLUSTREE_TYPE::InsertIntoParent(page_id_t leaf_page_left_id, KeyType key,
       // 内部节点split
       int index = parent_page->Lookup(key, comparator_);
       page_id_t parent_page_new_id;
-      bpm_->NewPageGuarded(&parent_page_new_id);
+      bpm_->NewPageGuarded(&parent_page_new_id, tablespace_);
       auto parent_page_new_guard = bpm_->FetchPageWrite(parent_page_new_id);
       //      auto parent_page_new_guard = ctx.GetWritePageGuardAt(bpm_,parent_page_new_id);
       auto *parent_page_new = parent_page_new_guard.AsMut<InternalPage>();
@@ -421,11 +495,14 @@ void BPLUSTREE_TYPE::RemoveEntry(page_id_t basic_page_id, const KeyType &key, Co
   int root_page_id = ctx.root_page_id_;
   if (basic_page_id == root_page_id && basic_page->GetSize() == 0) {
     SetTreeEmpty(ctx);
+    // a pinned page is not deleted
+    basic_page_guard.Drop();
     bpm_->DeletePage(root_page_id);
   } else if (basic_page_id == root_page_id && basic_page->GetSize() == 1 && !basic_page->IsLeafPage()) {
     // Set new root
     auto *root_page = basic_page_guard.AsMut<BPlusTree::InternalPage>();
     SetRootPageId(root_page->ValueAt(0), ctx);
+    basic_page_guard.Drop();
     bpm_->DeletePage(root_page_id);
   } else if (basic_page_id != root_page_id && basic_page->GetSize() < basic_page->GetMinSize()) {
     // 考虑时需要借还是需要合并
@@ -475,6 +552,7 @@ void BPLUSTREE_TYPE::RemoveEntry(page_id_t basic_page_id, const KeyType &key, Co
       }
       ctx.write_set_.push_back(std::move(parent_page_guard));
       RemoveEntry(parent_page_id, mid_key, ctx);
+      basic_page_guard.Drop();
       bpm_->DeletePage(basic_page_id);
     } else {
       // borrow an entry from sibling_page
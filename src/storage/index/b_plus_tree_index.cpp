@@ -16,12 +16,18 @@ namespace bustub {
  * Constructor
  */
 INDEX_TEMPLATE_ARGUMENTS
-BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager)
+BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                                     tablespace_id_t tablespace)
     : Index(std::move(metadata)), comparator_(GetMetadata()->GetKeySchema()) {
   page_id_t header_page_id;
-  buffer_pool_manager->NewPage(&header_page_id);
-  container_ = std::make_shared<BPlusTree<KeyType, ValueType, KeyComparator>>(GetMetadata()->GetName(), header_page_id,
-                                                                              buffer_pool_manager, comparator_);
+  // unpinned right away, so that nothing of the index stays pinned when its tablespace is dropped
+  buffer_pool_manager->NewPageGuarded(&header_page_id, tablespace);
+  // fill pages of whatever size the database file uses
+  auto page_size = buffer_pool_manager->GetPageSize();
+  container_ = std::make_shared<BPlusTree<KeyType, ValueType, KeyComparator>>(
+      GetMetadata()->GetName(), header_page_id, buffer_pool_manager, comparator_,
+      BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>::Capacity(page_size),
+      BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>::Capacity(page_size), tablespace);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
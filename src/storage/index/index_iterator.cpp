@@ -20,6 +20,12 @@ INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *bpm, const B_PLUS_TREE_LEAF
   page_ = page;
   index_ = index;
   page_guard_ = std::move(page_guard);
+  read_ahead_ = ReadAheadWindow(bpm, read_ahead_window, [](const char *data) {
+    return reinterpret_cast<const B_PLUS_TREE_LEAF_PAGE_TYPE *>(data)->GetNextPageId();
+  });
+  if (page_ != nullptr) {
+    read_ahead_.Advance(page_guard_.PageId(), page_->GetNextPageId());
+  }
 }
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::~IndexIterator() = default;  // NOLINT
@@ -44,6 +50,7 @@ auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
       page_guard_ = bpm_->FetchPageRead(next_page_id);
       page_ = page_guard_.As<B_PLUS_TREE_LEAF_PAGE_TYPE>();
       index_ = 0;
+      read_ahead_.Advance(next_page_id, page_->GetNextPageId());
     } else {
       page_ = nullptr;
       index_ = -1;
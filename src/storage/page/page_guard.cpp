@@ -11,12 +11,16 @@ BasicPageGuard::BasicPageGuard(BasicPageGuard &&that) noexcept {
   this->bpm_ = that.bpm_;
   this->page_ = that.page_;
   this->is_dirty_ = that.is_dirty_;
+  this->mapped_page_id_ = that.mapped_page_id_;
+  this->mapped_data_ = that.mapped_data_;
   that.is_dirty_ = false;
   that.bpm_ = nullptr;
   that.page_ = nullptr;
+  that.mapped_data_ = nullptr;
 }
 
 void BasicPageGuard::Drop() {
+  mapped_data_ = nullptr;
   if (bpm_ != nullptr && page_ != nullptr) {
     bpm_->UnpinPage(page_->GetPageId(), is_dirty_);
     is_dirty_ = false;
@@ -31,9 +35,12 @@ auto BasicPageGuard::operator=(BasicPageGuard &&that) noexcept -> BasicPageGuard
     this->bpm_ = that.bpm_;
     this->page_ = that.page_;
     this->is_dirty_ = that.is_dirty_;
+    this->mapped_page_id_ = that.mapped_page_id_;
+    this->mapped_data_ = that.mapped_data_;
     that.is_dirty_ = false;
     that.bpm_ = nullptr;
     that.page_ = nullptr;
+    that.mapped_data_ = nullptr;
   }
   return *this;
 }
@@ -53,6 +60,8 @@ auto ReadPageGuard::operator=(ReadPageGuard &&that) noexcept -> ReadPageGuard &
 
 void ReadPageGuard::Drop() {
   if (guard_.page_ == nullptr) {
+    // nothing, or a page of a file mapping
+    guard_.Drop();
     return;
   }
   guard_.page_->RUnlatch();
@@ -61,6 +70,13 @@ void ReadPageGuard::Drop() {
 
 ReadPageGuard::~ReadPageGuard() { Drop(); }  // NOLINT
 
+WritePageGuard::WritePageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {
+  if (page != nullptr) {
+    // Drop ends the write, whoever latched the page
+    page->BeginWrite();
+  }
+}
+
 WritePageGuard::WritePageGuard(WritePageGuard &&that) noexcept {
   Drop();
   guard_ = BasicPageGuard(std::move(that.guard_));
@@ -76,10 +92,34 @@ void WritePageGuard::Drop() {
   if (guard_.page_ == nullptr) {
     return;
   }
+  guard_.page_->EndWrite();
   guard_.page_->WUnlatch();
   guard_.Drop();
 }
 
 WritePageGuard::~WritePageGuard() { Drop(); }  // NOLINT
 
+OptimisticPageGuard::OptimisticPageGuard(OptimisticPageGuard &&that) noexcept
+    : guard_(std::move(that.guard_)), version_(that.version_) {}
+
+auto OptimisticPageGuard::operator=(OptimisticPageGuard &&that) noexcept -> OptimisticPageGuard & {
+  guard_ = std::move(that.guard_);
+  version_ = that.version_;
+  return *this;
+}
+
+void OptimisticPageGuard::Drop() { guard_.Drop(); }
+
+auto OptimisticPageGuard::Validate() -> bool {
+  // the reads of the data must not move past the second look at the version
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (guard_.page_ == nullptr) {
+    // a page of a read-only file mapping never changes
+    return guard_.mapped_data_ != nullptr;
+  }
+  return (version_ & 1) == 0 && guard_.page_->GetVersion() == version_;
+}
+
+OptimisticPageGuard::~OptimisticPageGuard() { Drop(); }  // NOLINT
+
 }  // namespace bustub
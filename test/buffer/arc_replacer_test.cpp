@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer_test.cpp
+//
+// Identification: test/buffer/arc_replacer_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "buffer/arc_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/** Load a page into a frame the way the buffer pool does, and unpin it. */
+static void LoadPage(Replacer *replacer, frame_id_t frame_id, page_id_t page_id,
+                     AccessType access_type = AccessType::Get) {
+  replacer->SetPage(frame_id, page_id);
+  replacer->RecordAccess(frame_id, access_type);
+  replacer->SetEvictable(frame_id, true);
+}
+
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer replacer(4);
+  frame_id_t frame_id;
+
+  // Scenario: four pages enter T1, two of them are used again and move to T2. With a target of 0 for T1, T1 is
+  // evicted from first.
+  for (frame_id_t i = 0; i < 4; ++i) {
+    LoadPage(&replacer, i, i);
+  }
+  replacer.RecordAccess(0);
+  replacer.RecordAccess(1);
+  EXPECT_EQ(4, replacer.Size());
+  EXPECT_EQ((std::vector<frame_id_t>{2, 3, 0, 1}), replacer.EvictionCandidates(4));
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(2, frame_id);
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(3, frame_id);
+
+  // Scenario: page 2 comes back while B1 remembers it. T1 was too small, so its target grows, and page 2 goes to T2.
+  LoadPage(&replacer, 2, 2);
+  EXPECT_EQ(1, replacer.GetTarget());
+  LoadPage(&replacer, 3, 9);
+  // T1 is within its target now, so T2 goes first
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(0, frame_id);
+
+  // Scenario: page 0 comes back while B2 remembers it, and the target shrinks again.
+  LoadPage(&replacer, 0, 0);
+  EXPECT_EQ(0, replacer.GetTarget());
+  EXPECT_EQ((std::vector<frame_id_t>{3, 1, 2, 0}), replacer.EvictionCandidates(4));
+}
+
+TEST(ARCReplacerTest, ScanTest) {
+  ARCReplacer replacer(4);
+  frame_id_t frame_id;
+
+  // Scenario: page 0 is used, page 1 only scanned. Only the used page is remembered in B1 once evicted.
+  LoadPage(&replacer, 0, 0);
+  LoadPage(&replacer, 1, 1, AccessType::Scan);
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(0, frame_id);
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(1, frame_id);
+  LoadPage(&replacer, 0, 1);
+  EXPECT_EQ(0, replacer.GetTarget());
+  LoadPage(&replacer, 1, 0);
+  EXPECT_EQ(1, replacer.GetTarget());
+
+  // Scenario: a scan hit does not count as a use. The first use of a scanned page keeps it in T1, the second one
+  // moves it to T2.
+  LoadPage(&replacer, 2, 2, AccessType::Scan);
+  replacer.RecordAccess(2, AccessType::Scan);
+  replacer.RecordAccess(2, AccessType::Get);
+  EXPECT_EQ((std::vector<frame_id_t>{0, 1, 2}), replacer.EvictionCandidates(4));
+  replacer.RecordAccess(2, AccessType::Get);
+  EXPECT_EQ((std::vector<frame_id_t>{1, 2, 0}), replacer.EvictionCandidates(4));
+}
+
+TEST(ARCReplacerTest, PinTest) {
+  ARCReplacer replacer(4);
+  frame_id_t frame_id;
+
+  // Scenario: pinned frames keep their place in the list but are skipped.
+  for (frame_id_t i = 0; i < 3; ++i) {
+    LoadPage(&replacer, i, i);
+  }
+  replacer.SetEvictable(0, false);
+  EXPECT_EQ(2, replacer.Size());
+  ASSERT_ANY_THROW(replacer.Remove(0));
+  EXPECT_EQ((std::vector<frame_id_t>{1, 2}), replacer.EvictionCandidates(4));
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(1, frame_id);
+  replacer.Remove(2);
+  EXPECT_FALSE(replacer.Evict(&frame_id));
+
+  // Scenario: a frame that is still tracked cannot be dropped by a shrink.
+  ASSERT_ANY_THROW(replacer.Resize(0));
+  replacer.SetEvictable(0, true);
+  replacer.Remove(0);
+  replacer.Resize(1);
+  ASSERT_ANY_THROW(replacer.RecordAccess(1));
+}
+
+}  // namespace bustub
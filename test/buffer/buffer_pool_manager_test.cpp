@@ -13,8 +13,18 @@
 #include "buffer/buffer_pool_manager.h"
 
 #include <cstdio>
+#include <memory>
 #include <random>
+#include <set>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/exception.h"
+#include "fmt/format.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_manager_mmap.h"
+#include "storage/disk/disk_manager_tablespaces.h"
 
 #include "gtest/gtest.h"
 
@@ -144,4 +154,1203 @@ TEST(BufferPoolManagerTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+// Pages are spread over the instances and each one is routed back to the instance that owns it
+TEST(BufferPoolManagerTest, MultipleInstancesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t num_instances = 3;
+  const size_t k = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, k, nullptr, num_instances);
+  EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+  EXPECT_EQ(num_instances, bpm->GetNumInstances());
+
+  // Scenario: every frame of every instance can hold a new page, and all page ids are distinct.
+  std::set<page_id_t> page_ids;
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+    page_ids.insert(page_id_temp);
+  }
+  EXPECT_EQ(buffer_pool_size, page_ids.size());
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: after unpinning everything, new pages evict old ones, which can be fetched back from disk.
+  for (auto page_id : page_ids) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(0, page_ids.count(page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  for (auto page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), fmt::format("page {}", page_id).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    EXPECT_EQ(true, bpm->DeletePage(page_id));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Frames are carved out of one page-aligned arena and start out zeroed
+TEST(BufferPoolManagerTest, FrameArenaTest) {
+  const size_t buffer_pool_size = 16;
+
+  for (auto huge_pages : {HugePagePolicy::None, HugePagePolicy::Transparent, HugePagePolicy::Explicit}) {
+    auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), LRUK_REPLACER_K, nullptr, 2,
+                                                   ReplacerPolicy::LRUK, huge_pages);
+    if (huge_pages == HugePagePolicy::None) {
+      EXPECT_EQ(HugePagePolicy::None, bpm->GetHugePagePolicy());
+    }
+
+    std::set<char *> frames;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      auto *data = bpm->GetPages()[i].GetData();
+      EXPECT_EQ(0, reinterpret_cast<uintptr_t>(data) % BUSTUB_PAGE_SIZE);
+      EXPECT_EQ(0, data[0]);
+      EXPECT_EQ(0, data[BUSTUB_PAGE_SIZE - 1]);
+      frames.insert(data);
+    }
+    EXPECT_EQ(buffer_pool_size, frames.size());
+
+    // every frame holds a full page of its own
+    std::vector<page_id_t> page_ids;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      memset(page->GetData(), static_cast<int>(page_id), BUSTUB_PAGE_SIZE);
+      page_ids.push_back(page_id);
+    }
+    for (auto page_id : page_ids) {
+      auto *page = bpm->FetchPage(page_id);
+      EXPECT_EQ(static_cast<char>(page_id), page->GetData()[0]);
+      EXPECT_EQ(static_cast<char>(page_id), page->GetData()[BUSTUB_PAGE_SIZE - 1]);
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+// Frames are as large as the pages of the disk manager
+TEST(BufferPoolManagerTest, PageSizeTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t page_size = 4 * BUSTUB_PAGE_SIZE;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>(page_size);
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+  EXPECT_EQ(page_size, bpm->GetPageSize());
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, page->GetData()[page_size - 1]);
+    memset(page->GetData(), static_cast<int>('a' + i), page_size);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  // the first pages went to disk and come back whole
+  for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+    auto *page = bpm->FetchPage(page_ids[i]);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(static_cast<char>('a' + i), page->GetData()[0]);
+    EXPECT_EQ(static_cast<char>('a' + i), page->GetData()[page_size - 1]);
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], false));
+  }
+}
+
+// NOLINTNEXTLINE
+// FlushAllPages writes the dirty pages of every instance in one batch, pinned or not
+TEST(BufferPoolManagerTest, FlushAllPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t num_instances = 3;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, LRUK_REPLACER_K, nullptr, num_instances);
+
+  std::vector<page_id_t> page_ids;
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+    page_ids.push_back(page_id_temp);
+  }
+  // half of the pages stay pinned, one page stays clean
+  for (size_t i = 0; i < buffer_pool_size / 2; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], i != 0));
+  }
+  for (size_t i = buffer_pool_size / 2; i < buffer_pool_size; ++i) {
+    auto *page = bpm->FetchPage(page_ids[i]);
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], true));
+    EXPECT_TRUE(page->IsDirty());
+  }
+
+  auto writes = disk_manager->GetNumWrites();
+  bpm->FlushAllPages();
+  EXPECT_EQ(writes + buffer_pool_size - 1, disk_manager->GetNumWrites());
+  char data[BUSTUB_PAGE_SIZE];
+  for (size_t i = 1; i < buffer_pool_size; ++i) {
+    disk_manager->ReadPage(page_ids[i], data);
+    EXPECT_EQ(0, strcmp(data, fmt::format("page {}", page_ids[i]).c_str()));
+  }
+  // nothing is dirty any more
+  bpm->FlushAllPages();
+  EXPECT_EQ(writes + buffer_pool_size - 1, disk_manager->GetNumWrites());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// The counters follow every hit, miss, eviction and page allocation
+TEST(BufferPoolManagerTest, StatsTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(1, disk_manager.get());
+
+  // Scenario: the only page is pinned three times at once and comes back dirty.
+  page_id_t page_id_0;
+  page_id_t page_id_1;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_0));
+  ASSERT_NE(nullptr, bpm->FetchPage(page_id_0, AccessType::Get));
+  ASSERT_NE(nullptr, bpm->FetchPage(page_id_0, AccessType::Get));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_0, false));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_0, false));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_0, true));
+
+  // Scenario: a new page evicts the dirty page, reading that page back evicts the clean one.
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_1));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_1, false));
+  ASSERT_NE(nullptr, bpm->FetchPage(page_id_0, AccessType::Scan));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_0, false));
+  EXPECT_EQ(true, bpm->DeletePage(page_id_0));
+
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(2, stats.hits_[static_cast<size_t>(AccessType::Get)]);
+  EXPECT_EQ(1, stats.misses_[static_cast<size_t>(AccessType::Scan)]);
+  EXPECT_EQ(2, stats.Hits());
+  EXPECT_EQ(1, stats.Misses());
+  EXPECT_DOUBLE_EQ(2.0 / 3.0, stats.HitRatio());
+  EXPECT_EQ(2, stats.evictions_);
+  EXPECT_EQ(1, stats.foreground_write_backs_);
+  EXPECT_EQ(2, stats.new_pages_);
+  EXPECT_EQ(1, stats.deleted_pages_);
+  EXPECT_EQ(3, stats.max_pin_count_);
+
+  // Scenario: a later snapshot only shows what happened in between. The deleted page left a free frame.
+  ASSERT_NE(nullptr, bpm->FetchPage(page_id_1));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_1, false));
+  auto delta = bpm->GetStats().Since(stats);
+  EXPECT_EQ(1, delta.misses_[static_cast<size_t>(AccessType::Unknown)]);
+  EXPECT_EQ(0, delta.Hits());
+  EXPECT_EQ(0, delta.evictions_);
+  EXPECT_EQ(0, delta.new_pages_);
+  EXPECT_EQ(3, delta.max_pin_count_);
+}
+
+// NOLINTNEXTLINE
+// Threads missing on the same page wait for a single load instead of reading it into several frames
+TEST(BufferPoolManagerTest, ConcurrentFetchSamePageTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t num_threads = 8;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  // the first pages have been evicted (and written back) by now
+  disk_manager->SetLatency(10);
+
+  std::vector<Page *> fetched(num_threads);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&, i] { fetched[i] = bpm->FetchPage(page_ids[0]); });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (size_t i = 0; i < num_threads; ++i) {
+    ASSERT_EQ(fetched[0], fetched[i]);
+  }
+  EXPECT_EQ(num_threads, fetched[0]->GetPinCount());
+  EXPECT_EQ(0, strcmp(fetched[0]->GetData(), fmt::format("page {}", page_ids[0]).c_str()));
+  for (size_t i = 0; i < num_threads; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[0], false));
+  }
+}
+
+// NOLINTNEXTLINE
+// Cached pages are pinned without the instance latch while other threads evict them; every fetch must see its page
+TEST(BufferPoolManagerTest, ConcurrentFetchEvictTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t num_pages = 24;
+  const size_t num_threads = 4;
+  const size_t k = 2;
+
+  for (auto policy : {ReplacerPolicy::LRUK, ReplacerPolicy::Clock, ReplacerPolicy::TwoQ, ReplacerPolicy::ARC}) {
+    auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k, nullptr, 1, policy);
+
+    std::vector<page_id_t> page_ids;
+    for (size_t i = 0; i < num_pages; ++i) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+      page_ids.push_back(page_id);
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < num_threads; ++i) {
+      threads.emplace_back([&, i] {
+        std::mt19937 gen(i);
+        // a few hot pages keep hitting the cache while the rest force evictions
+        std::uniform_int_distribution<size_t> pick(0, num_pages - 1);
+        for (size_t n = 0; n < 2000; ++n) {
+          auto page_id = page_ids[n % 2 == 0 ? n % 3 : pick(gen)];
+          auto *page = bpm->FetchPage(page_id);
+          if (page == nullptr) {
+            // every frame is pinned by the other threads
+            continue;
+          }
+          page->RLatch();
+          ASSERT_EQ(page_id, page->GetPageId());
+          ASSERT_EQ(0, strcmp(page->GetData(), fmt::format("page {}", page_id).c_str()));
+          page->RUnlatch();
+          ASSERT_EQ(true, bpm->UnpinPage(page_id, n % 5 == 0));
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      EXPECT_EQ(0, bpm->GetPages()[i].GetPinCount());
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+// Cache hits pin frames while another thread evicts them; afterwards every frame can still be evicted
+TEST(BufferPoolManagerTest, ConcurrentHitEvictTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t num_pages = 16;
+  const size_t num_threads = 4;
+  const size_t k = 2;
+
+  for (auto policy : {ReplacerPolicy::LRUK, ReplacerPolicy::Clock, ReplacerPolicy::TwoQ, ReplacerPolicy::ARC}) {
+    auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k, nullptr, 1, policy);
+
+    std::vector<page_id_t> page_ids;
+    for (size_t i = 0; i < num_pages; ++i) {
+      page_id_t page_id;
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+      page_ids.push_back(page_id);
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < num_threads; ++i) {
+      threads.emplace_back([&, i] {
+        // thread 0 keeps evicting, the others keep hitting whatever it left in the pool
+        for (size_t n = 0; n < 20000; ++n) {
+          auto page_id = i == 0 ? page_ids[n % num_pages] : page_ids[(n + i) % buffer_pool_size];
+          if (bpm->FetchPage(page_id) != nullptr) {
+            ASSERT_EQ(true, bpm->UnpinPage(page_id, false));
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    // a frame the replacer lost track of is never evicted again, and one of these would find no frame
+    std::vector<page_id_t> new_page_ids(buffer_pool_size);
+    for (auto &page_id : new_page_ids) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id)) << "policy " << static_cast<int>(policy);
+    }
+    for (auto page_id : new_page_ids) {
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+// A scan over many more pages than the pool holds does not push out the pages used by point lookups
+TEST(BufferPoolManagerTest, ScanResistanceTest) {
+  const size_t buffer_pool_size = 10;
+  const size_t num_hot_pages = 4;
+  const size_t num_pages = 50;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+
+  // Scenario: the hot pages are looked up a few times, then the whole table is scanned.
+  for (size_t round = 0; round < 2; ++round) {
+    for (size_t i = 0; i < num_hot_pages; ++i) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i], AccessType::Get));
+      EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], false, AccessType::Get));
+    }
+  }
+  for (auto page_id : page_ids) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id, AccessType::Scan));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false, AccessType::Scan));
+  }
+
+  std::set<page_id_t> resident;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    resident.insert(bpm->GetPages()[i].GetPageId());
+  }
+  for (size_t i = 0; i < num_hot_pages; ++i) {
+    EXPECT_EQ(1, resident.count(page_ids[i]));
+  }
+}
+
+// NOLINTNEXTLINE
+// The page cleaner writes back dirty pages ahead of eviction, so that eviction does not have to
+TEST(BufferPoolManagerTest, PageCleanerTest) {
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+
+  // Scenario: every frame is dirty, which is below the low watermark, so the cleaner writes back up to the high one.
+  bpm->StartPageCleaner(0.5, 1.0);
+  for (int i = 0; i < 500 && bpm->GetStats().background_write_backs_ < buffer_pool_size; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  bpm->StopPageCleaner();
+  EXPECT_EQ(buffer_pool_size, bpm->GetStats().background_write_backs_);
+
+  // Scenario: new pages now only evict clean frames, and the evicted pages can be read back.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(0, bpm->GetStats().foreground_write_backs_);
+  for (auto page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), fmt::format("page {}", page_id).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+}
+
+// NOLINTNEXTLINE
+// Prefetched pages are loaded in the background without being pinned
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+
+  /** Counts the pages read from disk. */
+  class CountingDiskManager : public DiskManagerUnlimitedMemory {
+   public:
+    void ReadPage(page_id_t page_id, char *page_data) override {
+      DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+      num_reads_++;
+    }
+    std::atomic<size_t> num_reads_{0};
+  };
+  auto disk_manager = std::make_unique<CountingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  // the first half of the pages have been evicted (and written back) by now
+  std::vector<page_id_t> evicted(page_ids.begin(), page_ids.begin() + buffer_pool_size / 2);
+
+  // Scenario: the pages are read in the background, and fetching them afterwards does not go to disk again.
+  bpm->Prefetch(evicted);
+  for (int i = 0; i < 500 && disk_manager->num_reads_ < evicted.size(); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_EQ(evicted.size(), disk_manager->num_reads_);
+  for (auto page_id : evicted) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ(0, strcmp(page->GetData(), fmt::format("page {}", page_id).c_str()));
+  }
+  EXPECT_EQ(evicted.size(), disk_manager->num_reads_);
+
+  // Scenario: prefetching never takes a frame away from pinned pages.
+  std::vector<page_id_t> pinned;
+  for (size_t i = 0; i < buffer_pool_size - evicted.size(); ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&pinned.emplace_back()));
+  }
+  bpm->Prefetch({page_ids[buffer_pool_size / 2]});
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(evicted.size(), disk_manager->num_reads_);
+  page_id_t page_id_temp;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+}
+
+// NOLINTNEXTLINE
+// Flushing every page while the prefetcher loads pages into several instances neither deadlocks nor loses a write
+TEST(BufferPoolManagerTest, ConcurrentFlushPrefetchTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t num_instances = 4;
+  const size_t num_pages = 8 * buffer_pool_size;
+
+  /**
+   * Slow I/O: the prefetcher keeps frames loading in one instance while it writes back victims of the next, which gives
+   * a flush the time to latch an instance the prefetcher has yet to come back to.
+   */
+  class SlowDiskManager : public DiskManagerUnlimitedMemory {
+   public:
+    void WritePage(page_id_t page_id, const char *page_data) override {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      DiskManagerUnlimitedMemory::WritePage(page_id, page_data);
+    }
+    void ReadPage(page_id_t page_id, char *page_data) override {
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+      DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+    }
+    void ReadPages(std::vector<PageRead> pages) override {
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+      DiskManagerUnlimitedMemory::ReadPages(std::move(pages));
+    }
+  };
+  auto disk_manager = std::make_unique<SlowDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), LRUK_REPLACER_K, nullptr,
+                                                 num_instances);
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+
+  std::atomic<bool> done{false};
+  std::thread prefetcher([&] {
+    for (size_t n = 0; !done; ++n) {
+      // a batch across every instance, more than fits
+      std::vector<page_id_t> batch;
+      for (size_t i = 0; i < 2 * buffer_pool_size; ++i) {
+        batch.push_back(page_ids[(n * 2 * buffer_pool_size + i) % num_pages]);
+      }
+      bpm->Prefetch(batch);
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+  std::thread writer([&] {
+    for (size_t n = 0; !done; ++n) {
+      auto page_id = page_ids[(n * 7) % num_pages];
+      auto *page = bpm->FetchPage(page_id);
+      if (page != nullptr) {
+        page->WLatch();
+        snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+        page->WUnlatch();
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+      }
+    }
+  });
+  for (size_t i = 0; i < 50; ++i) {
+    bpm->FlushAllPages();
+  }
+  done = true;
+  prefetcher.join();
+  writer.join();
+
+  // every page made it to disk, and every frame can be taken again
+  bpm->FlushAllPages();
+  for (auto page_id : page_ids) {
+    std::vector<char> data(BUSTUB_PAGE_SIZE);
+    disk_manager->ReadPage(page_id, data.data());
+    EXPECT_EQ(0, strcmp(data.data(), fmt::format("page {}", page_id).c_str()));
+  }
+  std::vector<page_id_t> new_page_ids(buffer_pool_size);
+  for (auto &page_id : new_page_ids) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+}
+
+// NOLINTNEXTLINE
+// Frames are added and retired while pages are pinned, and no page is lost on the way
+TEST(BufferPoolManagerTest, ResizeTest) {
+  const size_t buffer_pool_size = 4;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    page_ids.push_back(page_id);
+  }
+
+  // Scenario: shrinking below the pinned pages takes effect for new pages right away, and the pinned pages stay.
+  bpm->Resize(2);
+  EXPECT_EQ(2, bpm->GetPoolSize());
+  page_id_t page_id_temp;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  for (auto page_id : page_ids) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: the next allocation retires the frames that are now unpinned, writing back their pages first.
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  EXPECT_EQ(2, bpm->GetStats().background_write_backs_);
+  for (auto page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), fmt::format("page {}", page_id).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: growing reuses the retired frames and adds new ones, all of which can hold pinned pages.
+  bpm->Resize(6);
+  EXPECT_EQ(6, bpm->GetPoolSize());
+  std::vector<page_id_t> pinned;
+  for (size_t i = 0; i < 6; ++i) {
+    auto *page = bpm->NewPage(&pinned.emplace_back());
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", pinned.back());
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  for (auto page_id : pinned) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  for (auto page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), fmt::format("page {}", page_id).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+}
+
+// NOLINTNEXTLINE
+// Fetches go on while the pool is resized over and over
+TEST(BufferPoolManagerTest, ConcurrentResizeTest) {
+  const size_t num_pages = 32;
+  const size_t num_threads = 4;
+
+  for (auto policy : {ReplacerPolicy::LRUK, ReplacerPolicy::Clock, ReplacerPolicy::TwoQ, ReplacerPolicy::ARC}) {
+    auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+    auto bpm = std::make_unique<BufferPoolManager>(16, disk_manager.get(), LRUK_REPLACER_K, nullptr, 2, policy);
+
+    std::vector<page_id_t> page_ids;
+    for (size_t i = 0; i < num_pages; ++i) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+      page_ids.push_back(page_id);
+    }
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < num_threads; ++i) {
+      threads.emplace_back([&, i] {
+        std::mt19937 gen(i);
+        std::uniform_int_distribution<size_t> pick(0, num_pages - 1);
+        while (!stop.load()) {
+          auto page_id = page_ids[pick(gen)];
+          auto *page = bpm->FetchPage(page_id);
+          if (page == nullptr) {
+            // every frame left is pinned by the other threads
+            continue;
+          }
+          page->RLatch();
+          ASSERT_EQ(page_id, page->GetPageId());
+          ASSERT_EQ(0, strcmp(page->GetData(), fmt::format("page {}", page_id).c_str()));
+          page->RUnlatch();
+          ASSERT_EQ(true, bpm->UnpinPage(page_id, page_id % 3 == 0));
+        }
+      });
+    }
+    for (size_t round = 0; round < 50; ++round) {
+      bpm->Resize(round % 2 == 0 ? 6 + round % 5 : 24 + round % 7);
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    stop = true;
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    bpm->Resize(num_pages);
+    for (auto page_id : page_ids) {
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(0, strcmp(page->GetData(), fmt::format("page {}", page_id).c_str()));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+// The replacement policy is switched while the pool is in use; cached and pinned pages survive every switch
+TEST(BufferPoolManagerTest, SetReplacerPolicyTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t num_pages = 24;
+  const size_t num_threads = 4;
+  const std::vector<ReplacerPolicy> policies{ReplacerPolicy::LRUK, ReplacerPolicy::Clock, ReplacerPolicy::TwoQ,
+                                             ReplacerPolicy::ARC};
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), LRUK_REPLACER_K, nullptr, 2);
+  EXPECT_EQ(ReplacerPolicy::LRUK, bpm->GetReplacerPolicy());
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+
+  // Scenario: pin one page and cache three more, then switch. The cached pages are still hits afterwards.
+  auto *pinned = bpm->FetchPage(page_ids[0]);
+  ASSERT_NE(nullptr, pinned);
+  for (size_t i = 1; i < 4; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], false));
+  }
+  auto before = bpm->GetStats();
+  bpm->SetReplacerPolicy(ReplacerPolicy::ARC);
+  EXPECT_EQ(ReplacerPolicy::ARC, bpm->GetReplacerPolicy());
+  for (size_t i = 1; i < 4; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], false));
+  }
+  auto stats = bpm->GetStats().Since(before);
+  EXPECT_EQ(3, stats.Hits());
+  EXPECT_EQ(0, stats.Misses());
+
+  // Scenario: the new replacers evict every unpinned page in turn, but never the pinned one.
+  for (size_t i = 1; i < num_pages; ++i) {
+    auto *page = bpm->FetchPage(page_ids[i]);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), fmt::format("page {}", page_ids[i]).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], false));
+  }
+  EXPECT_EQ(1, pinned->GetPinCount());
+  EXPECT_EQ(page_ids[0], pinned->GetPageId());
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[0], false));
+
+  // Scenario: switch back and forth while other threads fetch pages.
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&, i] {
+      std::mt19937 gen(i);
+      std::uniform_int_distribution<size_t> pick(0, num_pages - 1);
+      while (!stop.load()) {
+        auto page_id = page_ids[pick(gen)];
+        auto *page = bpm->FetchPage(page_id, i % 2 == 0 ? AccessType::Get : AccessType::Scan);
+        if (page == nullptr) {
+          // every frame left is pinned by the other threads
+          continue;
+        }
+        page->RLatch();
+        ASSERT_EQ(page_id, page->GetPageId());
+        ASSERT_EQ(0, strcmp(page->GetData(), fmt::format("page {}", page_id).c_str()));
+        page->RUnlatch();
+        ASSERT_EQ(true, bpm->UnpinPage(page_id, page_id % 3 == 0));
+      }
+    });
+  }
+  for (size_t round = 0; round < 40; ++round) {
+    auto policy = policies[round % policies.size()];
+    bpm->SetReplacerPolicy(policy);
+    EXPECT_EQ(policy, bpm->GetReplacerPolicy());
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(0, bpm->GetPages()[i].GetPinCount());
+  }
+}
+
+// NOLINTNEXTLINE
+// The pages cached at shutdown are read back at startup, the hottest ones first if the pool got smaller
+TEST(BufferPoolManagerTest, WarmRestartTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t k = 2;
+  const std::string hot_page_file = "warm_restart_test.hot";
+  remove(hot_page_file.c_str());
+
+  class CountingDiskManager : public DiskManagerUnlimitedMemory {
+   public:
+    void ReadPage(page_id_t page_id, char *page_data) override {
+      DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+      num_reads_++;
+    }
+    std::atomic<size_t> num_reads_{0};
+  };
+  auto disk_manager = std::make_unique<CountingDiskManager>();
+
+  // Scenario: the first start finds no hot page file and reads nothing.
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+  bpm->EnableWarmRestart(hot_page_file);
+  bpm->WaitForWarmUp();
+  EXPECT_EQ(0, disk_manager->num_reads_);
+
+  // pages 0 to 3 get evicted, pages 4 and 5 are used twice, page 6 is still pinned at shutdown
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size + 4; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  for (size_t i : {4, 5}) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], false));
+  }
+  ASSERT_NE(nullptr, bpm->FetchPage(page_ids[6]));
+  bpm->FlushAllPages();
+  bpm.reset();
+
+  // Scenario: a smaller pool reads back the hottest pages, and fetching them does not go to disk again.
+  auto num_reads = disk_manager->num_reads_.load();
+  bpm = std::make_unique<BufferPoolManager>(4, disk_manager.get(), k);
+  bpm->EnableWarmRestart(hot_page_file);
+  bpm->WaitForWarmUp();
+  EXPECT_EQ(num_reads + 4, disk_manager->num_reads_);
+  EXPECT_EQ(4, bpm->GetStats().misses_[static_cast<size_t>(AccessType::Prefetch)]);
+  for (size_t i : {6, 5, 4, 11}) {
+    auto *page = bpm->FetchPage(page_ids[i]);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), fmt::format("page {}", page_ids[i]).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], false));
+  }
+  EXPECT_EQ(num_reads + 4, disk_manager->num_reads_);
+
+  // Scenario: the warm-up only takes free frames.
+  bpm.reset();
+  bpm = std::make_unique<BufferPoolManager>(4, disk_manager.get(), k);
+  for (size_t i = 0; i < 4; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+  }
+  EXPECT_EQ(0, bpm->LoadHotPages(hot_page_file));
+  bpm.reset();
+  remove(hot_page_file.c_str());
+}
+
+// NOLINTNEXTLINE
+// Evicted pages are kept compressed and misses are served from there before going to disk
+TEST(BufferPoolManagerTest, CompressedCacheTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t num_pages = 32;
+  const size_t k = 2;
+
+  class CountingDiskManager : public DiskManagerUnlimitedMemory {
+   public:
+    void ReadPage(page_id_t page_id, char *page_data) override {
+      DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+      num_reads_++;
+    }
+    std::atomic<size_t> num_reads_{0};
+  };
+  auto disk_manager = std::make_unique<CountingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k, nullptr, 2,
+                                                 ReplacerPolicy::LRUK, HugePagePolicy::None, 256 * 1024);
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+
+  // Scenario: every evicted page comes back from the compressed cache, without a disk read.
+  for (int round = 0; round < 2; ++round) {
+    for (auto page_id : page_ids) {
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(0, strcmp(page->GetData(), fmt::format("page {}", page_id).c_str()));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+  }
+  EXPECT_EQ(0, disk_manager->num_reads_);
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(256 * 1024, stats.compressed_capacity_);
+  EXPECT_EQ(stats.misses_[static_cast<size_t>(AccessType::Unknown)], stats.compressed_hits_);
+  EXPECT_EQ(0, stats.compressed_misses_);
+  EXPECT_EQ(num_pages - buffer_pool_size, stats.compressed_pages_);
+  EXPECT_GT(stats.CompressionRatio(), 10);
+
+  // Scenario: a page changed after it came back is not served stale from the cache.
+  auto *page = bpm->FetchPage(page_ids[0]);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "changed");
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[0], true));
+  for (size_t i = 1; i <= buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], false));
+  }
+  page = bpm->FetchPage(page_ids[0]);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "changed"));
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[0], false));
+
+  // Scenario: a deleted page is dropped from the cache too.
+  ASSERT_EQ(true, bpm->DeletePage(page_ids[num_pages - 1]));
+  auto pages_before = bpm->GetStats().compressed_pages_;
+  ASSERT_EQ(true, bpm->DeletePage(page_ids[16]));
+  EXPECT_EQ(pages_before - 1, bpm->GetStats().compressed_pages_);
+  EXPECT_EQ(0, disk_manager->num_reads_);
+
+  // Scenario: with a cache too small for the pages, the ones it dropped are read from disk again, intact, while
+  // several threads fetch and evict concurrently.
+  disk_manager = std::make_unique<CountingDiskManager>();
+  bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k, nullptr, 2, ReplacerPolicy::LRUK,
+                                            HugePagePolicy::None, 8 * CompressedPageCache::CHUNK_SIZE);
+  page_ids.clear();
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 4; ++i) {
+    threads.emplace_back([&, i] {
+      std::mt19937 gen(i);
+      std::uniform_int_distribution<size_t> pick(0, num_pages - 1);
+      for (size_t n = 0; n < 2000; ++n) {
+        auto page_id = page_ids[pick(gen)];
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        page->RLatch();
+        ASSERT_EQ(0, strcmp(page->GetData(), fmt::format("page {}", page_id).c_str()));
+        page->RUnlatch();
+        ASSERT_EQ(true, bpm->UnpinPage(page_id, n % 5 == 0));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  stats = bpm->GetStats();
+  EXPECT_GT(disk_manager->num_reads_, 0);
+  EXPECT_GT(stats.compressed_hits_, 0);
+  EXPECT_GT(stats.compressed_evictions_, 0);
+  EXPECT_LE(stats.compressed_memory_, stats.compressed_capacity_);
+}
+
+// NOLINTNEXTLINE
+// With direct I/O every read and write goes from frame to disk without a copy, and the pages survive eviction
+TEST(BufferPoolManagerTest, DirectIoTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const size_t num_pages = 4 * buffer_pool_size;
+  remove(db_name.c_str());
+
+  auto disk_manager = std::make_unique<DiskManager>(db_name, BUSTUB_PAGE_SIZE, true);
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), LRUK_REPLACER_K, nullptr, 2);
+
+  // Scenario: frames are aligned for direct I/O.
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page->GetData()) % DiskManager::DIRECT_IO_ALIGNMENT);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+
+  // Scenario: evicted pages, written back and read again with direct I/O, are intact, also after a flush.
+  for (size_t round = 0; round < 2; ++round) {
+    for (auto page_id : page_ids) {
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(0, strcmp(page->GetData(), fmt::format("page {}", page_id).c_str()));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+    bpm->FlushAllPages();
+  }
+
+  bpm.reset();
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+}
+
+// NOLINTNEXTLINE
+// Deleted pages are handed out again by NewPage, and page allocation picks up where it left off after a restart
+TEST(BufferPoolManagerTest, PageReuseTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t num_instances = 2;
+  remove(db_name.c_str());
+
+  auto disk_manager = std::make_unique<DiskManager>(db_name);
+  auto bpm =
+      std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), LRUK_REPLACER_K, nullptr, num_instances);
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < 3 * buffer_pool_size; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+
+  // Scenario: a deleted page, cached or not, is reused, and reads as a new page even after it is evicted.
+  EXPECT_EQ(true, bpm->DeletePage(page_ids[2]));
+  EXPECT_EQ(true, bpm->DeletePage(page_ids.back()));
+  std::set<page_id_t> reused;
+  for (size_t i = 0; i < 2; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    reused.insert(page_id);
+  }
+  EXPECT_EQ((std::set<page_id_t>{page_ids[2], page_ids.back()}), reused);
+  for (auto page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    if (reused.count(page_id) > 0) {
+      EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, 0), std::string(page->GetData(), BUSTUB_PAGE_SIZE));
+    } else {
+      EXPECT_EQ(0, strcmp(page->GetData(), fmt::format("page {}", page_id).c_str()));
+    }
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(true, bpm->DeletePage(page_ids[5]));
+  bpm->FlushAllPages();
+  bpm.reset();
+  disk_manager->ShutDown();
+
+  // Scenario: after a restart the freed page is reused first, then the file grows, and old pages are intact.
+  disk_manager = std::make_unique<DiskManager>(db_name);
+  bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), LRUK_REPLACER_K, nullptr, 1);
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(page_ids[5], page_id);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(static_cast<page_id_t>(page_ids.size()), page_id);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  auto *page = bpm->FetchPage(page_ids[0]);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), fmt::format("page {}", page_ids[0]).c_str()));
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[0], false));
+
+  bpm.reset();
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+}
+
+// NOLINTNEXTLINE
+// On a mapped file, read guards point into the mapping without taking frames, and nothing can be written
+TEST(BufferPoolManagerTest, MmapTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t num_pages = 4 * buffer_pool_size;
+  remove(db_name.c_str());
+
+  auto disk_manager = std::make_unique<DiskManager>(db_name);
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  bpm->FlushAllPages();
+  bpm.reset();
+  disk_manager->ShutDown();
+
+  auto mapped_disk = std::make_unique<DiskManagerMmap>(db_name);
+  bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, mapped_disk.get());
+
+  // Scenario: more pages than there are frames are held at once, and reading them does not touch the buffer pool.
+  std::vector<ReadPageGuard> guards;
+  for (auto page_id : page_ids) {
+    guards.push_back(bpm->FetchPageRead(page_id, page_id == 0 ? AccessType::Scan : AccessType::Get));
+    EXPECT_EQ(page_id, guards.back().PageId());
+    EXPECT_EQ(0, strcmp(guards.back().GetData(), fmt::format("page {}", page_id).c_str()));
+  }
+  EXPECT_EQ(guards.front().GetData(), mapped_disk->GetMappedPage(page_ids[0]));
+  auto optimistic = bpm->FetchPageOptimistic(page_ids[1]);
+  EXPECT_EQ(0, strcmp(optimistic.GetData(), fmt::format("page {}", page_ids[1]).c_str()));
+  EXPECT_TRUE(optimistic.Validate());
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(0, stats.hits_[static_cast<size_t>(AccessType::Get)] + stats.misses_[static_cast<size_t>(AccessType::Get)]);
+  EXPECT_EQ(1, mapped_disk->GetNumScanHints());
+  guards.clear();
+
+  // Scenario: FetchPage copies the page into a frame, and a page past the end of the file reads as zeros.
+  auto *page = bpm->FetchPage(page_ids[2]);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), fmt::format("page {}", page_ids[2]).c_str()));
+  EXPECT_NE(mapped_disk->GetMappedPage(page_ids[2]), page->GetData());
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[2], false));
+  {
+    auto past_end = bpm->FetchPageRead(1000);
+    EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, 0), std::string(past_end.GetData(), BUSTUB_PAGE_SIZE));
+  }
+
+  // Scenario: writes are rejected.
+  page_id_t page_id;
+  EXPECT_THROW(bpm->NewPage(&page_id), Exception);
+  EXPECT_THROW(bpm->FetchPageWrite(page_ids[0]), Exception);
+  EXPECT_THROW(bpm->DeletePage(page_ids[0]), Exception);
+
+  bpm.reset();
+  mapped_disk.reset();
+  remove(db_name.c_str());
+}
+
+// NOLINTNEXTLINE
+// Dropping a tablespace forgets its cached pages, dirty or not, and leaves the other tablespaces alone
+TEST(BufferPoolManagerTest, DropTablespaceTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const size_t num_instances = 2;
+  remove(db_name.c_str());
+
+  auto disk_manager = std::make_unique<DiskManagerTablespaces>(db_name);
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), LRUK_REPLACER_K, nullptr,
+                                                 num_instances, ReplacerPolicy::LRUK, HugePagePolicy::Transparent,
+                                                 64 * BUSTUB_PAGE_SIZE);
+  auto tablespace = bpm->CreateTablespace();
+  ASSERT_NE(DEFAULT_TABLESPACE, tablespace);
+
+  // Scenario: new pages of a tablespace are spread over the instances like any other, more of them than fit.
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < 2 * buffer_pool_size; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id, (i / 2) % 2 == 0 ? tablespace : DEFAULT_TABLESPACE);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  EXPECT_EQ(tablespace, DiskManager::TablespaceOf(page_ids[0]));
+  EXPECT_EQ(tablespace, DiskManager::TablespaceOf(page_ids[1]));
+  EXPECT_NE(page_ids[0] % num_instances, page_ids[1] % num_instances);
+
+  // Scenario: a pinned page keeps the tablespace from being dropped.
+  auto *pinned = bpm->FetchPage(page_ids[0]);
+  ASSERT_NE(nullptr, pinned);
+  EXPECT_FALSE(bpm->DropTablespace(tablespace));
+  EXPECT_TRUE(disk_manager->HasTablespace(tablespace));
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[0], false));
+  EXPECT_FALSE(bpm->DropTablespace(DEFAULT_TABLESPACE));
+
+  // Scenario: a tablespace the disk manager does not have is not dropped, and its pages cannot be read.
+  auto unknown_page_id = DiskManager::FirstPageOf(tablespace + 1);
+  EXPECT_THROW(bpm->FetchPage(unknown_page_id), std::logic_error);
+  EXPECT_FALSE(bpm->DropTablespace(tablespace + 1));
+
+  // Scenario: once dropped, its pages cannot be read, and the pages of the database file are still there.
+  EXPECT_TRUE(bpm->DropTablespace(tablespace));
+  EXPECT_FALSE(disk_manager->HasTablespace(tablespace));
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    if ((i / 2) % 2 == 0) {
+      EXPECT_THROW(bpm->FetchPageRead(page_ids[i]), std::logic_error);
+    } else {
+      auto guard = bpm->FetchPageRead(page_ids[i]);
+      EXPECT_EQ(0, strcmp(guard.GetData(), fmt::format("page {}", page_ids[i]).c_str()));
+    }
+  }
+
+  // Scenario: prefetching them is no error, and every failed read gave its frame back.
+  bpm->Prefetch({page_ids[0], page_ids[1], page_ids[4]});
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  std::vector<page_id_t> new_page_ids(buffer_pool_size);
+  for (auto &page_id : new_page_ids) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+  for (auto page_id : new_page_ids) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  bpm.reset();
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+}
+
 }  // namespace bustub
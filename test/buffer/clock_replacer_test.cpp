@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <cstdio>
+#include <set>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -19,7 +20,7 @@
 
 namespace bustub {
 
-TEST(ClockReplacerTest, DISABLED_SampleTest) {
+TEST(ClockReplacerTest, SampleTest) {
   ClockReplacer clock_replacer(7);
 
   // Scenario: unpin six elements, i.e. add them to the replacer.
@@ -59,4 +60,100 @@ TEST(ClockReplacerTest, DISABLED_SampleTest) {
   EXPECT_EQ(4, value);
 }
 
+TEST(ClockReplacerTest, ConcurrentEvictTest) {
+  const size_t num_frames = 1000;
+  const size_t num_threads = 4;
+  ClockReplacer clock_replacer(num_frames);
+  for (size_t i = 0; i < num_frames; ++i) {
+    clock_replacer.RecordAccess(i);
+    clock_replacer.SetEvictable(i, true);
+  }
+  // Frame 0 stays pinned and must never be handed out.
+  clock_replacer.SetEvictable(0, false);
+  EXPECT_EQ(num_frames - 1, clock_replacer.Size());
+
+  // Scenario: threads evicting concurrently never get the same frame twice.
+  std::vector<std::vector<frame_id_t>> victims(num_threads);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      frame_id_t frame_id;
+      while (clock_replacer.Evict(&frame_id)) {
+        victims[t].push_back(frame_id);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::set<frame_id_t> evicted;
+  size_t total = 0;
+  for (const auto &thread_victims : victims) {
+    evicted.insert(thread_victims.begin(), thread_victims.end());
+    total += thread_victims.size();
+  }
+  EXPECT_EQ(num_frames - 1, total);
+  EXPECT_EQ(num_frames - 1, evicted.size());
+  EXPECT_EQ(0, evicted.count(0));
+  EXPECT_EQ(0, clock_replacer.Size());
+}
+
+TEST(ClockReplacerTest, ScanAccessTest) {
+  ClockReplacer clock_replacer(4);
+
+  // Frames 0 and 2 were fetched by a scan, frames 1 and 3 by point lookups.
+  clock_replacer.RecordAccess(0, AccessType::Scan);
+  clock_replacer.RecordAccess(1);
+  clock_replacer.RecordAccess(2, AccessType::Scan);
+  clock_replacer.RecordAccess(3);
+  for (frame_id_t frame_id = 0; frame_id < 4; ++frame_id) {
+    clock_replacer.SetEvictable(frame_id, true);
+  }
+
+  // Scenario: scan frames have no second chance and are taken on the first turn of the hand.
+  ASSERT_EQ(std::vector<frame_id_t>({0, 2, 1, 3}), clock_replacer.EvictionCandidates(10));
+  int value;
+  ASSERT_TRUE(clock_replacer.Evict(&value));
+  EXPECT_EQ(0, value);
+  ASSERT_TRUE(clock_replacer.Evict(&value));
+  EXPECT_EQ(2, value);
+  ASSERT_TRUE(clock_replacer.Evict(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(clock_replacer.Evict(&value));
+  EXPECT_EQ(3, value);
+  EXPECT_EQ(0, clock_replacer.Size());
+}
+
+TEST(ClockReplacerTest, ResizeTest) {
+  ClockReplacer clock_replacer(2);
+  clock_replacer.RecordAccess(0);
+  clock_replacer.RecordAccess(1);
+  ASSERT_ANY_THROW(clock_replacer.RecordAccess(2));
+
+  // Scenario: growing keeps the frames there are, and the hand goes over the new ones.
+  clock_replacer.Resize(4);
+  clock_replacer.RecordAccess(3, AccessType::Scan);
+  for (frame_id_t frame_id : {0, 1, 3}) {
+    clock_replacer.SetEvictable(frame_id, true);
+  }
+  ASSERT_EQ(std::vector<frame_id_t>({3, 0, 1}), clock_replacer.EvictionCandidates(4));
+
+  // Scenario: a frame that is still tracked cannot be dropped, and a dropped frame is never evicted.
+  ASSERT_ANY_THROW(clock_replacer.Resize(3));
+  clock_replacer.Remove(3);
+  clock_replacer.Resize(3);
+  ASSERT_ANY_THROW(clock_replacer.RecordAccess(3));
+  ASSERT_EQ(2, clock_replacer.Size());
+  int value;
+  ASSERT_TRUE(clock_replacer.Evict(&value));
+  ASSERT_TRUE(clock_replacer.Evict(&value));
+  ASSERT_FALSE(clock_replacer.Evict(&value));
+
+  // Scenario: growing back over a dropped frame starts it out untracked.
+  clock_replacer.Resize(4);
+  clock_replacer.SetEvictable(3, true);
+  EXPECT_EQ(0, clock_replacer.Size());
+}
+
 }  // namespace bustub
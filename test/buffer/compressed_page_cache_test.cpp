@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache_test.cpp
+//
+// Identification: test/buffer/compressed_page_cache_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/compressed_page_cache.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/** A page that compresses to a few hundred bytes, different for every page id. */
+auto MakePage(page_id_t page_id) -> std::vector<char> {
+  std::vector<char> page(BUSTUB_PAGE_SIZE, 0);
+  for (int i = 0; i < 64; i++) {
+    snprintf(page.data() + i * 32, 32, "page %d tuple %d", page_id, i);
+  }
+  return page;
+}
+
+// NOLINTNEXTLINE
+TEST(CompressedPageCacheTest, SampleTest) {
+  CompressedPageCache cache(64 * 1024, BUSTUB_PAGE_SIZE);
+  std::vector<char> out(BUSTUB_PAGE_SIZE);
+
+  // Scenario: a page that was put can be taken out exactly once.
+  ASSERT_TRUE(cache.Put(1, MakePage(1).data()));
+  ASSERT_TRUE(cache.Put(2, MakePage(2).data()));
+  ASSERT_TRUE(cache.Take(1, out.data()));
+  EXPECT_EQ(MakePage(1), out);
+  EXPECT_FALSE(cache.Take(1, out.data()));
+  EXPECT_FALSE(cache.Take(3, out.data()));
+
+  // Scenario: putting a page again replaces the old copy, and an erased page is gone.
+  auto changed = MakePage(2);
+  changed[0] = 'P';
+  ASSERT_TRUE(cache.Put(2, changed.data()));
+  ASSERT_TRUE(cache.Take(2, out.data()));
+  EXPECT_EQ(changed, out);
+  ASSERT_TRUE(cache.Put(2, changed.data()));
+  cache.Erase(2);
+  cache.Erase(4);
+  EXPECT_FALSE(cache.Take(2, out.data()));
+
+  BufferPoolStats stats;
+  cache.AddStats(&stats);
+  EXPECT_EQ(64 * 1024, stats.compressed_capacity_);
+  EXPECT_EQ(2, stats.compressed_hits_);
+  EXPECT_EQ(3, stats.compressed_misses_);
+  EXPECT_EQ(4, stats.compressed_stores_);
+  EXPECT_EQ(0, stats.compressed_pages_);
+  EXPECT_EQ(0, stats.compressed_memory_);
+  EXPECT_GT(stats.CompressionRatio(), 4);
+}
+
+// NOLINTNEXTLINE
+TEST(CompressedPageCacheTest, FullTest) {
+  const size_t capacity = 16 * 1024;
+  CompressedPageCache cache(capacity, BUSTUB_PAGE_SIZE);
+  std::vector<char> out(BUSTUB_PAGE_SIZE);
+
+  // Scenario: once the region is full, the least recently put pages are dropped.
+  const page_id_t num_pages = 200;
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    ASSERT_TRUE(cache.Put(page_id, MakePage(page_id).data()));
+  }
+  BufferPoolStats stats;
+  cache.AddStats(&stats);
+  EXPECT_LE(stats.compressed_memory_, capacity);
+  EXPECT_GT(stats.compressed_evictions_, 0);
+  EXPECT_EQ(num_pages, stats.compressed_pages_ + stats.compressed_evictions_);
+  EXPECT_FALSE(cache.Take(0, out.data()));
+  ASSERT_TRUE(cache.Take(num_pages - 1, out.data()));
+  EXPECT_EQ(MakePage(num_pages - 1), out);
+
+  // Scenario: a page that does not compress is rejected and drops its old copy.
+  std::mt19937 gen(42);
+  std::vector<char> random(BUSTUB_PAGE_SIZE);
+  for (auto &c : random) {
+    c = static_cast<char>(gen());
+  }
+  EXPECT_FALSE(cache.Put(num_pages - 2, random.data()));
+  EXPECT_FALSE(cache.Take(num_pages - 2, out.data()));
+
+  // Scenario: a cache too small for any page keeps nothing.
+  CompressedPageCache tiny(CompressedPageCache::CHUNK_SIZE, BUSTUB_PAGE_SIZE);
+  EXPECT_FALSE(tiny.Put(0, MakePage(0).data()));
+  BufferPoolStats tiny_stats;
+  tiny.AddStats(&tiny_stats);
+  EXPECT_EQ(1, tiny_stats.compressed_rejects_);
+}
+
+}  // namespace bustub
@@ -95,4 +95,129 @@ TEST(LRUKReplacerTest, SampleTest) {
   ASSERT_EQ(false, lru_replacer.Evict(&value));
   ASSERT_EQ(0, lru_replacer.Size());
 }
+TEST(LRUKReplacerTest, KDistanceTest) {
+  LRUKReplacer lru_replacer(4, 2);
+
+  // Frame 0 is accessed at t0 and t3, frame 1 at t1 and t2. Frame 0 was used most recently, but its 2nd most recent
+  // access is older, so it has the larger backward k-distance and goes first.
+  lru_replacer.RecordAccess(0);
+  lru_replacer.RecordAccess(1);
+  lru_replacer.RecordAccess(1);
+  lru_replacer.RecordAccess(0);
+  // Frame 2 has a single access and therefore +inf backward k-distance.
+  lru_replacer.RecordAccess(2);
+  for (frame_id_t frame_id = 0; frame_id < 3; ++frame_id) {
+    lru_replacer.SetEvictable(frame_id, true);
+  }
+
+  // Scenario: pinning and unpinning a frame does not change its priority.
+  lru_replacer.SetEvictable(2, false);
+  ASSERT_EQ(2, lru_replacer.Size());
+  lru_replacer.SetEvictable(2, true);
+  ASSERT_EQ(3, lru_replacer.Size());
+
+  int value;
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+  ASSERT_EQ(false, lru_replacer.Evict(&value));
+
+  // Scenario: evicted frames start over with an empty history.
+  lru_replacer.RecordAccess(1);
+  lru_replacer.RecordAccess(3);
+  lru_replacer.RecordAccess(3);
+  lru_replacer.SetEvictable(3, true);
+  lru_replacer.SetEvictable(1, true);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+
+  // Scenario: invalid frame ids and removing a pinned frame are rejected.
+  ASSERT_ANY_THROW(lru_replacer.RecordAccess(4));
+  lru_replacer.RecordAccess(0);
+  ASSERT_ANY_THROW(lru_replacer.Remove(0));
+  lru_replacer.Remove(3);
+  ASSERT_EQ(0, lru_replacer.Size());
+}
+TEST(LRUKReplacerTest, ScanAccessTest) {
+  LRUKReplacer lru_replacer(5, 2);
+
+  // Frames 0 and 1 are hot, frames 2, 3 and 4 are only ever touched by a scan.
+  lru_replacer.RecordAccess(0);
+  lru_replacer.RecordAccess(0);
+  lru_replacer.RecordAccess(1);
+  lru_replacer.RecordAccess(2, AccessType::Scan);
+  lru_replacer.RecordAccess(3, AccessType::Scan);
+  lru_replacer.RecordAccess(4, AccessType::Scan);
+  // Scenario: a scan passing over a hot frame does not refresh it, and repeated scans do not promote a scan frame.
+  lru_replacer.RecordAccess(1, AccessType::Scan);
+  lru_replacer.RecordAccess(2, AccessType::Scan);
+  // Scenario: a point lookup turns a scan frame into an ordinary one with a single access.
+  lru_replacer.RecordAccess(4, AccessType::Get);
+  for (frame_id_t frame_id = 0; frame_id < 5; ++frame_id) {
+    lru_replacer.SetEvictable(frame_id, true);
+  }
+
+  // Scan-only frames go first, oldest first, then +inf k-distance frames by first access, then the rest.
+  ASSERT_EQ(std::vector<frame_id_t>({2, 3, 1}), lru_replacer.EvictionCandidates(3));
+  ASSERT_EQ(5, lru_replacer.Size());
+  int value;
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(3, value);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(4, value);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_EQ(false, lru_replacer.Evict(&value));
+}
+TEST(LRUKReplacerTest, PrefetchAccessTest) {
+  LRUKReplacer lru_replacer(4, 2);
+
+  // Frame 0 was fetched once, frames 1 and 2 were prefetched afterwards, frame 3 was only scanned.
+  lru_replacer.RecordAccess(0);
+  lru_replacer.RecordAccess(1, AccessType::Prefetch);
+  lru_replacer.RecordAccess(2, AccessType::Prefetch);
+  lru_replacer.RecordAccess(3, AccessType::Scan);
+  // Scenario: looking at a frame for prefetching is not an access, and using a prefetched frame replaces the prefetch.
+  lru_replacer.RecordAccess(0, AccessType::Prefetch);
+  lru_replacer.RecordAccess(1);
+  for (frame_id_t frame_id = 0; frame_id < 4; ++frame_id) {
+    lru_replacer.SetEvictable(frame_id, true);
+  }
+
+  // Prefetched frames rank like frames with a single access instead of going first like scanned ones.
+  ASSERT_EQ(std::vector<frame_id_t>({3, 0, 2, 1}), lru_replacer.EvictionCandidates(4));
+}
+
+TEST(LRUKReplacerTest, ResizeTest) {
+  LRUKReplacer lru_replacer(2, 2);
+  lru_replacer.RecordAccess(0);
+  lru_replacer.RecordAccess(1);
+  ASSERT_ANY_THROW(lru_replacer.RecordAccess(2));
+
+  // Scenario: growing keeps the history of the frames there are, and new frames can be used right away.
+  lru_replacer.Resize(4);
+  lru_replacer.RecordAccess(3);
+  lru_replacer.RecordAccess(0);
+  for (frame_id_t frame_id : {0, 1, 3}) {
+    lru_replacer.SetEvictable(frame_id, true);
+  }
+  ASSERT_EQ(std::vector<frame_id_t>({1, 3, 0}), lru_replacer.EvictionCandidates(4));
+
+  // Scenario: a frame that is still tracked cannot be dropped.
+  ASSERT_ANY_THROW(lru_replacer.Resize(3));
+  lru_replacer.Remove(3);
+  lru_replacer.Resize(3);
+  ASSERT_ANY_THROW(lru_replacer.RecordAccess(3));
+  ASSERT_EQ(2, lru_replacer.Size());
+  int value;
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+}
 }  // namespace bustub
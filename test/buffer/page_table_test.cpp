@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/page_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(PageTableTest, SampleTest) {
+  PageTable page_table(16);
+  frame_id_t frame_id = -1;
+  EXPECT_FALSE(page_table.Find(0, &frame_id));
+
+  // page ids that are multiples of the table size hash to nearby slots more often than random ones would
+  for (page_id_t page_id = 0; page_id < 16; page_id++) {
+    page_table.Insert(page_id * 64, page_id);
+  }
+  EXPECT_EQ(16, page_table.Size());
+  for (page_id_t page_id = 0; page_id < 16; page_id++) {
+    ASSERT_TRUE(page_table.Find(page_id * 64, &frame_id));
+    EXPECT_EQ(page_id, frame_id);
+  }
+  EXPECT_FALSE(page_table.Find(1, &frame_id));
+
+  // inserting an existing page replaces its frame
+  page_table.Insert(64, 7);
+  EXPECT_EQ(16, page_table.Size());
+  ASSERT_TRUE(page_table.Find(64, &frame_id));
+  EXPECT_EQ(7, frame_id);
+
+  // erasing must not cut the probe sequence of the pages that are left
+  for (page_id_t page_id = 0; page_id < 16; page_id += 2) {
+    page_table.Erase(page_id * 64);
+  }
+  page_table.Erase(1);
+  EXPECT_EQ(8, page_table.Size());
+  for (page_id_t page_id = 0; page_id < 16; page_id++) {
+    EXPECT_EQ(page_id % 2 == 1, page_table.Find(page_id * 64, &frame_id));
+  }
+}
+
+TEST(PageTableTest, GrowTest) {
+  PageTable page_table(16);
+  frame_id_t frame_id = -1;
+  for (page_id_t page_id = 0; page_id < 16; page_id++) {
+    page_table.Insert(page_id, page_id);
+  }
+  EXPECT_EQ(16, page_table.Capacity());
+
+  // Scenario: growing keeps every entry, and shrinking is not a thing.
+  page_table.Grow(64);
+  EXPECT_EQ(64, page_table.Capacity());
+  page_table.Grow(8);
+  EXPECT_EQ(64, page_table.Capacity());
+  EXPECT_EQ(16, page_table.Size());
+  for (page_id_t page_id = 16; page_id < 64; page_id++) {
+    page_table.Insert(page_id, page_id);
+  }
+  page_table.Erase(0);
+  EXPECT_EQ(63, page_table.Size());
+  EXPECT_FALSE(page_table.Find(0, &frame_id));
+  for (page_id_t page_id = 1; page_id < 64; page_id++) {
+    ASSERT_TRUE(page_table.Find(page_id, &frame_id));
+    EXPECT_EQ(page_id, frame_id);
+  }
+}
+
+TEST(PageTableTest, ConcurrentFindTest) {
+  const size_t num_pages = 64;
+  PageTable page_table(num_pages);
+  // odd pages never leave the table, even pages come and go
+  for (page_id_t page_id = 1; page_id < static_cast<page_id_t>(num_pages); page_id += 2) {
+    page_table.Insert(page_id, page_id);
+  }
+
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 2; i++) {
+    readers.emplace_back([&] {
+      while (!stop.load()) {
+        for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_pages); page_id++) {
+          frame_id_t frame_id = -1;
+          bool found = page_table.Find(page_id, &frame_id);
+          if (page_id % 2 == 1) {
+            ASSERT_TRUE(found);
+          }
+          if (found) {
+            ASSERT_EQ(page_id, frame_id);
+          }
+        }
+      }
+    });
+  }
+
+  for (int round = 0; round < 1000; round++) {
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_pages); page_id += 2) {
+      page_table.Insert(page_id, page_id);
+    }
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_pages); page_id += 2) {
+      page_table.Erase(page_id);
+    }
+  }
+  stop = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(num_pages / 2, page_table.Size());
+}
+
+}  // namespace bustub
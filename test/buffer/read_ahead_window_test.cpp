@@ -0,0 +1,126 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_ahead_window_test.cpp
+//
+// Identification: test/buffer/read_ahead_window_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/read_ahead_window.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/disk/disk_manager_memory.h"
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/** Remembers which pages were read from disk. */
+class RecordingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+    std::lock_guard<std::mutex> guard(latch_);
+    reads_.push_back(page_id);
+  }
+
+  auto NumReads(page_id_t page_id) -> size_t {
+    std::lock_guard<std::mutex> guard(latch_);
+    return std::count(reads_.begin(), reads_.end(), page_id);
+  }
+
+  void ClearReads() {
+    std::lock_guard<std::mutex> guard(latch_);
+    reads_.clear();
+  }
+
+  /** Wait up to five seconds for page_id to be read. */
+  auto WaitForRead(page_id_t page_id) -> bool {
+    for (int i = 0; i < 500; ++i) {
+      if (NumReads(page_id) > 0) {
+        return true;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+  }
+
+ private:
+  std::mutex latch_;
+  std::vector<page_id_t> reads_;
+};
+
+// NOLINTNEXTLINE
+TEST(ReadAheadWindowTest, ChainTest) {
+  const size_t buffer_pool_size = 20;
+  const size_t num_pages = 30;
+  const size_t window_size = 4;
+
+  auto disk_manager = std::make_unique<RecordingDiskManager>();
+
+  // Build a chain of pages, each storing the id of the next one at the start of its data.
+  std::vector<page_id_t> page_ids(num_pages);
+  {
+    BufferPoolManager bpm(buffer_pool_size, disk_manager.get());
+    for (auto &page_id : page_ids) {
+      ASSERT_NE(nullptr, bpm.NewPage(&page_id));
+      EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+    }
+    for (size_t i = 0; i < num_pages; ++i) {
+      auto *page = bpm.FetchPage(page_ids[i]);
+      page_id_t next_page_id = i + 1 < num_pages ? page_ids[i + 1] : INVALID_PAGE_ID;
+      memcpy(page->GetData(), &next_page_id, sizeof(page_id_t));
+      EXPECT_EQ(true, bpm.UnpinPage(page_ids[i], true));
+    }
+    bpm.FlushAllPages();
+  }
+  // start over with nothing cached
+  disk_manager->ClearReads();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+  auto next_page_id = [](const char *data) {
+    page_id_t page_id;
+    memcpy(&page_id, data, sizeof(page_id_t));
+    return page_id;
+  };
+  ReadAheadWindow window(bpm.get(), window_size, next_page_id);
+
+  // Scenario: the first page tells the window where the chain goes, and the whole window is read ahead.
+  auto *page = bpm->FetchPage(page_ids[0], AccessType::Scan);
+  ASSERT_NE(nullptr, page);
+  window.Advance(page_ids[0], next_page_id(page->GetData()));
+  bpm->UnpinPage(page_ids[0], false, AccessType::Scan);
+  ASSERT_TRUE(disk_manager->WaitForRead(page_ids[window_size]));
+
+  // Scenario: a scan that waits for every page to be read before it moves on never reads a page itself, since the
+  // read-ahead always gets there first. Every page is read exactly once.
+  for (size_t i = 1; i < num_pages; ++i) {
+    ASSERT_TRUE(disk_manager->WaitForRead(page_ids[i]));
+    page = bpm->FetchPage(page_ids[i], AccessType::Scan);
+    ASSERT_NE(nullptr, page);
+    window.Advance(page_ids[i], next_page_id(page->GetData()));
+    // advancing to the page the scan is already on does nothing
+    window.Advance(page_ids[i], next_page_id(page->GetData()));
+    bpm->UnpinPage(page_ids[i], false, AccessType::Scan);
+  }
+  for (size_t i = 0; i < num_pages; ++i) {
+    EXPECT_EQ(1, disk_manager->NumReads(page_ids[i]));
+  }
+
+  // Scenario: a disabled window does not touch the buffer pool.
+  ReadAheadWindow disabled;
+  disabled.Advance(page_ids[0], page_ids[1]);
+}
+
+}  // namespace bustub
@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer_test.cpp
+//
+// Identification: test/buffer/two_queue_replacer_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "buffer/two_queue_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/** Load a page into a frame the way the buffer pool does, and unpin it. */
+static void LoadPage(Replacer *replacer, frame_id_t frame_id, page_id_t page_id,
+                     AccessType access_type = AccessType::Get) {
+  replacer->SetPage(frame_id, page_id);
+  replacer->RecordAccess(frame_id, access_type);
+  replacer->SetEvictable(frame_id, true);
+}
+
+TEST(TwoQReplacerTest, SampleTest) {
+  // 8 frames: A1in is evicted from while it holds more than 2 frames, A1out remembers 4 pages
+  TwoQReplacer replacer(8);
+  frame_id_t frame_id;
+
+  // Scenario: four pages enter A1in and leave it first in, first out. A hit in A1in does not move a frame.
+  for (frame_id_t i = 0; i < 4; ++i) {
+    LoadPage(&replacer, i, 100 + i);
+  }
+  replacer.RecordAccess(0);
+  EXPECT_EQ(4, replacer.Size());
+  EXPECT_EQ((std::vector<frame_id_t>{0, 1, 2, 3}), replacer.EvictionCandidates(8));
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(0, frame_id);
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(1, frame_id);
+
+  // Scenario: page 100 comes back while A1out remembers it and goes to Am. Page 200 is new and goes to A1in.
+  LoadPage(&replacer, 0, 100);
+  LoadPage(&replacer, 1, 200);
+  // A1in holds 3 frames, one more than its share, then Am goes first
+  EXPECT_EQ((std::vector<frame_id_t>{2, 0, 3, 1}), replacer.EvictionCandidates(8));
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(2, frame_id);
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(0, frame_id);
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(3, frame_id);
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(1, frame_id);
+  EXPECT_FALSE(replacer.Evict(&frame_id));
+  EXPECT_EQ(0, replacer.Size());
+}
+
+TEST(TwoQReplacerTest, ScanTest) {
+  TwoQReplacer replacer(4);
+  frame_id_t frame_id;
+
+  // Scenario: page 10 is used, page 11 only scanned. Both are evicted from A1in.
+  LoadPage(&replacer, 0, 10);
+  LoadPage(&replacer, 1, 11, AccessType::Scan);
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(0, frame_id);
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(1, frame_id);
+
+  // Scenario: only the used page is remembered, so only page 10 goes to Am when both come back. With A1in within its
+  // share, Am is evicted from first.
+  LoadPage(&replacer, 0, 11);
+  LoadPage(&replacer, 1, 10);
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(1, frame_id);
+}
+
+TEST(TwoQReplacerTest, PinTest) {
+  TwoQReplacer replacer(4);
+  frame_id_t frame_id;
+
+  // Scenario: pinned frames keep their place in the queue but are skipped.
+  for (frame_id_t i = 0; i < 4; ++i) {
+    LoadPage(&replacer, i, i);
+  }
+  replacer.SetEvictable(0, false);
+  replacer.SetEvictable(1, false);
+  EXPECT_EQ(2, replacer.Size());
+  ASSERT_ANY_THROW(replacer.Remove(0));
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(2, frame_id);
+
+  // Scenario: once unpinned, the oldest frame is next again.
+  replacer.SetEvictable(0, true);
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(0, frame_id);
+  replacer.Remove(3);
+  EXPECT_EQ(0, replacer.Size());
+  EXPECT_FALSE(replacer.Evict(&frame_id));
+
+  // Scenario: a frame that is still tracked cannot be dropped by a shrink.
+  ASSERT_ANY_THROW(replacer.Resize(1));
+  replacer.SetEvictable(1, true);
+  replacer.Remove(1);
+  replacer.Resize(1);
+  ASSERT_ANY_THROW(replacer.RecordAccess(1));
+}
+
+}  // namespace bustub
@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz_codec_test.cpp
+//
+// Identification: test/common/lz_codec_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/lz_codec.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/** Compress data, check that it decompresses to itself, and return the compressed size. */
+auto RoundTrip(const std::vector<char> &data) -> size_t {
+  std::vector<char> compressed(LzCodec::MaxCompressedSize(data.size()));
+  auto size = LzCodec::Compress(data.data(), data.size(), compressed.data(), compressed.size());
+  EXPECT_GT(size, 0);
+  std::vector<char> decompressed(data.size());
+  EXPECT_TRUE(LzCodec::Decompress(compressed.data(), size, decompressed.data(), decompressed.size()));
+  EXPECT_EQ(data, decompressed);
+  return size;
+}
+
+// NOLINTNEXTLINE
+TEST(LzCodecTest, RoundTripTest) {
+  // Scenario: a page of zeros shrinks to almost nothing.
+  std::vector<char> zeros(BUSTUB_PAGE_SIZE, 0);
+  EXPECT_LT(RoundTrip(zeros), 64);
+
+  // Scenario: repetitive text, like tuples of a table, compresses well.
+  std::vector<char> text;
+  for (int i = 0; text.size() < BUSTUB_PAGE_SIZE; i++) {
+    auto tuple = "tuple " + std::to_string(i) + " name=bustub value=" + std::to_string(i % 10) + ";";
+    text.insert(text.end(), tuple.begin(), tuple.end());
+  }
+  text.resize(BUSTUB_PAGE_SIZE);
+  EXPECT_LT(RoundTrip(text), BUSTUB_PAGE_SIZE / 2);
+
+  // Scenario: random data does not compress, but still round-trips within the bound.
+  std::mt19937 gen(42);
+  std::vector<char> random(BUSTUB_PAGE_SIZE);
+  for (auto &c : random) {
+    c = static_cast<char>(gen());
+  }
+  EXPECT_LE(RoundTrip(random), LzCodec::MaxCompressedSize(random.size()));
+
+  // Scenario: inputs shorter than a match, and long runs whose lengths take continuation bytes.
+  for (size_t size : {1, 3, 4, 5, 20, 300, 1000}) {
+    std::vector<char> data(size);
+    for (size_t i = 0; i < size; i++) {
+      data[i] = static_cast<char>(i < size / 2 ? 'a' : i);
+    }
+    RoundTrip(data);
+  }
+  RoundTrip(std::vector<char>(LzCodec::MAX_INPUT_SIZE, 'x'));
+}
+
+// NOLINTNEXTLINE
+TEST(LzCodecTest, BoundsTest) {
+  std::mt19937 gen(7);
+  std::vector<char> data(BUSTUB_PAGE_SIZE);
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = static_cast<char>(i % 64 < 32 ? gen() : i);
+  }
+  std::vector<char> compressed(LzCodec::MaxCompressedSize(data.size()));
+  auto size = LzCodec::Compress(data.data(), data.size(), compressed.data(), compressed.size());
+  ASSERT_GT(size, 0);
+
+  // Scenario: compression gives up when the output does not fit.
+  std::vector<char> small(size - 1);
+  EXPECT_EQ(0, LzCodec::Compress(data.data(), data.size(), small.data(), small.size()));
+  EXPECT_EQ(size, LzCodec::Compress(data.data(), data.size(), compressed.data(), size));
+
+  // Scenario: truncated input, a wrong output size or a damaged offset are detected.
+  std::vector<char> out(data.size() + 1);
+  EXPECT_FALSE(LzCodec::Decompress(compressed.data(), size - 1, out.data(), data.size()));
+  EXPECT_FALSE(LzCodec::Decompress(compressed.data(), size, out.data(), data.size() - 1));
+  EXPECT_FALSE(LzCodec::Decompress(compressed.data(), size, out.data(), data.size() + 1));
+  std::vector<char> tiny{static_cast<char>(0x10), 'a', static_cast<char>(0xff), static_cast<char>(0xff)};
+  EXPECT_FALSE(LzCodec::Decompress(tiny.data(), tiny.size(), out.data(), 8));
+  EXPECT_TRUE(LzCodec::Decompress(compressed.data(), size, out.data(), data.size()));
+}
+
+}  // namespace bustub
@@ -19,7 +19,9 @@
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager_memory.h"
 #include "storage/index/b_plus_tree.h"
+#include "storage/table/table_heap.h"
 #include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
 
 namespace bustub {
 
@@ -295,6 +297,77 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
   delete bpm;
 }
 
+// Lookups of keys that are already in the tree must find them while a writer splits the pages on their path.
+TEST(BPlusTreeConcurrentTest, OptimisticLookupTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  // small pages so the tree is a few levels deep and the root splits while the lookups run
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator, 3, 5);
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 100; key++) {
+    keys.push_back(key);
+  }
+  InsertHelper(&tree, keys);
+
+  std::vector<int64_t> new_keys;
+  for (int64_t key = 101; key <= 1000; key++) {
+    new_keys.push_back(key);
+  }
+  std::thread writer(InsertHelper, &tree, new_keys, 0);
+  LaunchParallelTest(2, LookupHelper, &tree, keys, 1);
+  writer.join();
+  LookupHelper(&tree, new_keys, 1);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
+// Table pages the TableHeap latched itself must not leave their frames unreadable to the optimistic lookups of the
+// tree pages that are loaded into them afterwards.
+TEST(BPlusTreeConcurrentTest, OptimisticLookupAfterTableHeapTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(10, disk_manager.get());
+
+  // a few tuples to a page, so the table pages go through every frame
+  TableHeap table(bpm);
+  Schema schema({Column("a", TypeId::VARCHAR, 1000)});
+  for (int i = 0; i < 60; i++) {
+    Tuple tuple({ValueFactory::GetVarcharValue(std::string(1000, 'a' + i % 26))}, &schema);
+    ASSERT_TRUE(table.InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, tuple).has_value());
+  }
+  page_id_t header_page_id;
+  auto header_page = bpm->NewPage(&header_page_id);
+  for (page_id_t table_page_id = 0; table_page_id < header_page_id; table_page_id++) {
+    EXPECT_TRUE(bpm->FetchPageOptimistic(table_page_id).Validate()) << "table page " << table_page_id;
+  }
+
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator, 3, 5);
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 200; key++) {
+    keys.push_back(key);
+  }
+  InsertHelper(&tree, keys);
+  LookupHelper(&tree, keys, 1);
+  page_id_t end_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&end_page_id));
+  bpm->UnpinPage(end_page_id, false);
+  for (page_id_t other_page_id = 0; other_page_id < end_page_id; other_page_id++) {
+    EXPECT_TRUE(bpm->FetchPageOptimistic(other_page_id).Validate()) << "page " << other_page_id;
+  }
+
+  bpm->UnpinPage(header_page_id, true);
+  delete bpm;
+}
+
 TEST(BPlusTreeConcurrentTest, DISABLED_MixTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
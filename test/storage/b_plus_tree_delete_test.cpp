@@ -12,6 +12,7 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <string>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
@@ -156,4 +157,53 @@ TEST(BPlusTreeTests, DeleteTest2) {
   delete transaction;
   delete bpm;
 }
+// Pages emptied by merges go back to the disk manager, and new pages reuse them.
+TEST(BPlusTreeTests, DeletePageReuseTest) {
+  const std::string db_name = "test.db";
+  remove(db_name.c_str());
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManager>(db_name);
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  // small pages so that a few keys make a few levels
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator, 3, 3);
+  GenericKey<8> index_key;
+  RID rid;
+  auto *transaction = new Transaction(0);
+
+  for (int64_t key = 1; key <= 50; key++) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+  page_id_t end_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&end_page_id));
+  bpm->UnpinPage(end_page_id, false);
+
+  for (int64_t key = 1; key <= 40; key++) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  std::vector<RID> rids;
+  for (int64_t key = 41; key <= 50; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.GetValue(index_key, &rids));
+  }
+
+  // every page the tree dropped is handed out again before the file grows
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_LT(page_id, end_page_id);
+  bpm->UnpinPage(page_id, false);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+}
+
 }  // namespace bustub
@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap_test.cpp
+//
+// Identification: test/storage/disk_manager_mmap_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_mmap.h"
+
+#include <sys/stat.h>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "common/exception.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+class DiskManagerMmapTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerMmapTest, ReadOnlyTest) {
+  const page_id_t num_pages = 200;
+  std::vector<char> buf(BUSTUB_PAGE_SIZE);
+  {
+    DiskManager dm("test.db");
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      EXPECT_EQ(page_id, dm.AllocatePage());
+      std::fill(buf.begin(), buf.end(), static_cast<char>(page_id));
+      dm.WritePage(page_id, buf.data());
+    }
+    dm.ShutDown();
+  }
+  remove("test.log");
+
+  // Scenario: pages read the same from the mapping, straight or copied, and past the end of the file there is none.
+  DiskManagerMmap dm("test.db");
+  EXPECT_TRUE(dm.IsReadOnly());
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    const auto *data = dm.GetMappedPage(page_id);
+    ASSERT_NE(nullptr, data);
+    ASSERT_EQ(std::string(BUSTUB_PAGE_SIZE, static_cast<char>(page_id)), std::string(data, BUSTUB_PAGE_SIZE));
+  }
+  EXPECT_EQ(nullptr, dm.GetMappedPage(num_pages));
+  dm.ReadPage(3, buf.data());
+  EXPECT_EQ(std::vector<char>(BUSTUB_PAGE_SIZE, 3), buf);
+  dm.ReadPage(num_pages, buf.data());
+  EXPECT_EQ(std::vector<char>(BUSTUB_PAGE_SIZE, 0), buf);
+  EXPECT_TRUE(dm.IsAllocated(num_pages - 1));
+
+  // Scenario: a scan asks for the pages ahead of it once per extent.
+  auto extent_pages = static_cast<page_id_t>(READ_AHEAD_MAX_BYTES / BUSTUB_PAGE_SIZE);
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    dm.GetMappedPage(page_id, true);
+  }
+  EXPECT_EQ((num_pages + extent_pages - 1) / extent_pages, dm.GetNumScanHints());
+
+  // Scenario: every write is rejected, and the log is not created.
+  EXPECT_THROW(dm.WritePage(0, buf.data()), Exception);
+  EXPECT_THROW(dm.WritePages({{0, buf.data()}}), Exception);
+  EXPECT_THROW(dm.AllocatePage(), Exception);
+  EXPECT_THROW(dm.DeallocatePage(0), Exception);
+  EXPECT_THROW(dm.WriteLog(buf.data(), 1), Exception);
+  dm.Sync();
+  struct stat stat_buf;
+  EXPECT_NE(0, stat("test.log", &stat_buf));
+  dm.ShutDown();
+
+  // Scenario: a file that does not exist, or is empty, cannot be mapped.
+  remove("test.db");
+  EXPECT_THROW(DiskManagerMmap("test.db"), Exception);
+  std::ofstream("test.db").close();
+  EXPECT_THROW(DiskManagerMmap("test.db"), Exception);
+}
+
+}  // namespace bustub
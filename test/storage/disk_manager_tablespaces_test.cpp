@@ -0,0 +1,211 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_tablespaces_test.cpp
+//
+// Identification: test/storage/disk_manager_tablespaces_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_tablespaces.h"
+
+#include <sys/stat.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+class DiskManagerTablespacesTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override { RemoveFiles(); }
+
+  // This function is called after every test.
+  void TearDown() override { RemoveFiles(); };
+
+  static void RemoveFiles() {
+    remove("test.db");
+    remove("test.log");
+    for (tablespace_id_t tablespace = 1; tablespace < 4; tablespace++) {
+      remove(("test.db." + std::to_string(tablespace)).c_str());
+    }
+  }
+
+  static auto FileExists(const std::string &file_name) -> bool {
+    struct stat stat_buf;
+    return stat(file_name.c_str(), &stat_buf) == 0;
+  }
+};
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTablespacesTest, ReadWriteTest) {
+  std::vector<char> buf(BUSTUB_PAGE_SIZE);
+  std::vector<char> data(BUSTUB_PAGE_SIZE);
+  page_id_t first_1 = DiskManager::FirstPageOf(1);
+  page_id_t first_2 = DiskManager::FirstPageOf(2);
+  {
+    DiskManagerTablespaces dm("test.db");
+
+    // Scenario: every tablespace is a file of its own, and its page ids say so.
+    EXPECT_EQ(1, dm.CreateTablespace());
+    EXPECT_EQ(2, dm.CreateTablespace());
+    EXPECT_TRUE(FileExists("test.db.1"));
+    EXPECT_TRUE(FileExists(dm.GetTablespaceFile(2)));
+    EXPECT_EQ(0, dm.AllocatePage());
+    EXPECT_EQ(first_1, dm.AllocatePage(0, 1, nullptr, 1));
+    EXPECT_EQ(first_1 + 1, dm.AllocatePage(0, 1, nullptr, 1));
+    EXPECT_EQ(1, DiskManager::TablespaceOf(first_1 + 1));
+    EXPECT_THROW(dm.AllocatePage(0, 1, nullptr, 3), std::logic_error);
+
+    // Scenario: the stripe of a page is that of its page id, whatever the tablespace.
+    for (size_t stripe = 0; stripe < 3; stripe++) {
+      auto page_id = dm.AllocatePage(stripe, 3, nullptr, 2);
+      EXPECT_EQ(2, DiskManager::TablespaceOf(page_id));
+      EXPECT_EQ(stripe, static_cast<size_t>(page_id) % 3);
+    }
+
+    // Scenario: a batch across tablespaces lands in the right files, and reads back the same.
+    std::vector<std::vector<char>> pages;
+    std::vector<DiskManager::PageWrite> writes;
+    for (auto page_id : {first_1 + 1, 0, first_1, first_2}) {
+      // tablespace * 10 + the page in its file
+      auto tablespace = DiskManager::TablespaceOf(page_id);
+      auto value = tablespace * 10 + page_id - DiskManager::FirstPageOf(tablespace);
+      pages.emplace_back(BUSTUB_PAGE_SIZE, static_cast<char>(value));
+      writes.emplace_back(page_id, pages.back().data());
+    }
+    dm.WritePages(writes);
+    for (const auto &[page_id, page_data] : writes) {
+      dm.ReadPage(page_id, buf.data());
+      EXPECT_EQ(0, memcmp(page_data, buf.data(), BUSTUB_PAGE_SIZE));
+    }
+    std::vector<std::vector<char>> reads(writes.size(), std::vector<char>(BUSTUB_PAGE_SIZE));
+    std::vector<DiskManager::PageRead> batch;
+    for (size_t i = 0; i < writes.size(); i++) {
+      batch.emplace_back(writes[i].first, reads[i].data());
+    }
+    dm.ReadPages(batch);
+    for (size_t i = 0; i < writes.size(); i++) {
+      EXPECT_EQ(0, memcmp(writes[i].second, reads[i].data(), BUSTUB_PAGE_SIZE));
+    }
+
+#ifdef __linux__
+    // Scenario: a file reserves disk space a whole extent at a time, without growing.
+    struct stat stat_buf;
+    ASSERT_EQ(0, stat("test.db.1", &stat_buf));
+    EXPECT_LT(stat_buf.st_size, static_cast<off_t>(DISK_EXTENT_BYTES));
+    EXPECT_GE(stat_buf.st_blocks * 512, static_cast<off_t>(DISK_EXTENT_BYTES));
+#endif
+    dm.ShutDown();
+  }
+
+  // Scenario: the tablespaces are found again when the database is opened.
+  DiskManagerTablespaces dm("test.db");
+  EXPECT_TRUE(dm.HasTablespace(1));
+  EXPECT_TRUE(dm.HasTablespace(2));
+  EXPECT_FALSE(dm.HasTablespace(3));
+  EXPECT_TRUE(dm.IsAllocated(first_1 + 1));
+  EXPECT_FALSE(dm.IsAllocated(first_1 + 2));
+  dm.ReadPage(first_1 + 1, buf.data());
+  EXPECT_EQ(std::vector<char>(BUSTUB_PAGE_SIZE, 11), buf);
+  EXPECT_EQ(first_1 + 2, dm.AllocatePage(0, 1, nullptr, 1));
+
+  // Scenario: dropping a tablespace unlinks its file, and its pages are gone; I/O to them fails, in a batch too.
+  EXPECT_TRUE(dm.DropTablespace(1));
+  EXPECT_FALSE(dm.DropTablespace(1));
+  EXPECT_FALSE(dm.DropTablespace(DEFAULT_TABLESPACE));
+  EXPECT_FALSE(FileExists("test.db.1"));
+  EXPECT_FALSE(dm.IsAllocated(first_1));
+  EXPECT_THROW(dm.ReadPage(first_1, buf.data()), std::logic_error);
+  EXPECT_THROW(dm.ReadPages({{first_1, buf.data()}}), std::logic_error);
+  std::fill(data.begin(), data.end(), 1);
+  EXPECT_THROW(dm.WritePage(first_1, data.data()), std::logic_error);
+  EXPECT_THROW(dm.WritePages({{0, data.data()}, {first_1, data.data()}}), std::logic_error);
+  dm.ReadPage(0, buf.data());
+  EXPECT_EQ(std::vector<char>(BUSTUB_PAGE_SIZE, 0), buf);
+  dm.ReadPage(first_2, buf.data());
+  EXPECT_EQ(std::vector<char>(BUSTUB_PAGE_SIZE, 20), buf);
+
+  // Scenario: its id is handed out again, for an empty file.
+  EXPECT_EQ(1, dm.CreateTablespace());
+  EXPECT_FALSE(dm.IsAllocated(first_1));
+  EXPECT_EQ(first_1, dm.AllocatePage(0, 1, nullptr, 1));
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTablespacesTest, CatalogTest) {
+  DiskManagerTablespaces dm("test.db");
+  BufferPoolManager bpm(16, &dm, LRUK_REPLACER_K, nullptr, 2);
+  Catalog catalog(&bpm, nullptr, nullptr);
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::INTEGER)});
+  Schema key_schema({Column("a", TypeId::INTEGER)});
+  auto create_index = [&](const std::string &index_name, const std::string &table_name) {
+    return catalog.CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
+        nullptr, index_name, table_name, schema, key_schema, {0}, TWO_INTEGER_SIZE, IntegerHashFunctionType{});
+  };
+
+  // Scenario: by default, every table and index lives in the database file.
+  auto *shared = catalog.CreateTable(nullptr, "shared", schema);
+  EXPECT_EQ(DEFAULT_TABLESPACE, shared->table_->GetTablespace());
+  EXPECT_EQ(DEFAULT_TABLESPACE, DiskManager::TablespaceOf(shared->table_->GetFirstPageId()));
+  EXPECT_EQ(DEFAULT_TABLESPACE, create_index("shared_a", "shared")->tablespace_);
+
+  // Scenario: per table, a table shares a file with its indexes.
+  catalog.SetTablespacePolicy(TablespacePolicy::PerTable);
+  auto *grouped = catalog.CreateTable(nullptr, "grouped", schema);
+  EXPECT_EQ(1, grouped->table_->GetTablespace());
+  EXPECT_EQ(1, DiskManager::TablespaceOf(grouped->table_->GetFirstPageId()));
+  EXPECT_EQ(1, create_index("grouped_a", "grouped")->tablespace_);
+
+  // Scenario: per object, every table and index has a file of its own.
+  catalog.SetTablespacePolicy(TablespacePolicy::PerObject);
+  auto *table = catalog.CreateTable(nullptr, "table", schema);
+  EXPECT_EQ(2, table->table_->GetTablespace());
+  for (int i = 0; i < 500; i++) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i)};
+    auto rid = table->table_->InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, Tuple(values, &schema));
+    ASSERT_TRUE(rid.has_value());
+  }
+  auto *index = create_index("table_a", "table");
+  EXPECT_EQ(3, index->tablespace_);
+  std::vector<RID> rids;
+  index->index_->ScanKey(Tuple({ValueFactory::GetIntegerValue(42)}, &key_schema), &rids, nullptr);
+  EXPECT_EQ(1, rids.size());
+
+  // Scenario: nothing of a table is dropped while one of its pages is pinned.
+  auto first_page_id = table->table_->GetFirstPageId();
+  ASSERT_NE(nullptr, bpm.FetchPage(first_page_id));
+  EXPECT_FALSE(catalog.DropTable("table"));
+  EXPECT_EQ(table, catalog.GetTable("table"));
+  EXPECT_EQ(index, catalog.GetIndex("table_a", "table"));
+  EXPECT_TRUE(FileExists("test.db.2"));
+  EXPECT_TRUE(FileExists("test.db.3"));
+  EXPECT_TRUE(bpm.UnpinPage(first_page_id, false));
+
+  // Scenario: dropping an index or table unlinks the files it has of its own.
+  EXPECT_TRUE(catalog.DropIndex("table_a", "table"));
+  EXPECT_FALSE(catalog.DropIndex("table_a", "table"));
+  EXPECT_FALSE(FileExists("test.db.3"));
+  EXPECT_TRUE(FileExists("test.db.2"));
+  EXPECT_TRUE(catalog.DropTable("table"));
+  EXPECT_EQ(Catalog::NULL_TABLE_INFO, catalog.GetTable("table"));
+  EXPECT_FALSE(FileExists("test.db.2"));
+  EXPECT_TRUE(catalog.DropTable("grouped"));
+  EXPECT_FALSE(FileExists("test.db.1"));
+  EXPECT_TRUE(catalog.DropTable("shared"));
+  EXPECT_FALSE(catalog.DropTable("shared"));
+  EXPECT_TRUE(catalog.GetTableNames().empty());
+  dm.ShutDown();
+}
+
+}  // namespace bustub
@@ -10,7 +10,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
@@ -55,6 +60,329 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, WritePagesTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  // pages 0 to 9 in one run, page 20 on its own, handed over out of order
+  std::vector<page_id_t> page_ids = {20, 7, 3, 0, 9, 1, 2, 8, 4, 6, 5};
+  std::vector<std::vector<char>> data;
+  for (auto page_id : page_ids) {
+    data.emplace_back(BUSTUB_PAGE_SIZE, static_cast<char>('a' + page_id));
+  }
+  std::vector<DiskManager::PageWrite> pages;
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    pages.emplace_back(page_ids[i], data[i].data());
+  }
+
+  dm.WritePage(3, data[0].data());
+  dm.ReadPage(3, buf);
+  dm.WritePages(pages);
+  EXPECT_EQ(12, dm.GetNumWrites());
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    dm.ReadPage(page_ids[i], buf);
+    EXPECT_EQ(std::memcmp(buf, data[i].data(), sizeof(buf)), 0) << "page " << page_ids[i];
+  }
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ReadPagesTest) {
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  for (page_id_t page_id = 0; page_id < 10; page_id++) {
+    std::vector<char> data(BUSTUB_PAGE_SIZE, static_cast<char>('a' + page_id));
+    dm.WritePage(page_id, data.data());
+  }
+
+  // pages 2 to 6 in one run, page 9 on its own, pages 10 and 11 past the end of the file
+  std::vector<page_id_t> page_ids = {6, 11, 2, 9, 3, 5, 10, 4};
+  std::vector<std::vector<char>> bufs(page_ids.size(), std::vector<char>(BUSTUB_PAGE_SIZE, 'x'));
+  std::vector<DiskManager::PageRead> pages;
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    pages.emplace_back(page_ids[i], bufs[i].data());
+  }
+  dm.ReadPages(pages);
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    auto expected = page_ids[i] < 10 ? static_cast<char>('a' + page_ids[i]) : 0;
+    EXPECT_EQ(std::vector<char>(BUSTUB_PAGE_SIZE, expected), bufs[i]) << "page " << page_ids[i];
+  }
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ConcurrentReadWriteTest) {
+  const size_t num_threads = 8;
+  const size_t pages_per_thread = 16;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  // Scenario: a page never written reads as zeros.
+  std::vector<char> buf(BUSTUB_PAGE_SIZE, 'x');
+  dm.ReadPage(100, buf.data());
+  EXPECT_EQ(std::vector<char>(BUSTUB_PAGE_SIZE, 0), buf);
+
+  // Scenario: threads write and read their own pages at the same time, and every read sees the last write.
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; t++) {
+    threads.emplace_back([&dm, t] {
+      std::vector<char> data(BUSTUB_PAGE_SIZE);
+      std::vector<char> out(BUSTUB_PAGE_SIZE);
+      for (size_t round = 0; round < 20; round++) {
+        for (size_t i = 0; i < pages_per_thread; i++) {
+          auto page_id = static_cast<page_id_t>(i * num_threads + t);
+          std::fill(data.begin(), data.end(), static_cast<char>(page_id + round));
+          dm.WritePage(page_id, data.data());
+          dm.ReadPage(page_id, out.data());
+          ASSERT_EQ(data, out) << "page " << page_id;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  dm.Sync();
+  EXPECT_EQ(num_threads * pages_per_thread * 20, dm.GetNumWrites());
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_threads * pages_per_thread); page_id++) {
+    dm.ReadPage(page_id, buf.data());
+    EXPECT_EQ(std::vector<char>(BUSTUB_PAGE_SIZE, static_cast<char>(page_id + 19)), buf) << "page " << page_id;
+  }
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DirectIoTest) {
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file, BUSTUB_PAGE_SIZE, true);
+  // aligned like a buffer pool frame, and a buffer direct I/O cannot use as it is
+  auto *aligned = static_cast<char *>(std::aligned_alloc(DiskManager::DIRECT_IO_ALIGNMENT, 2 * BUSTUB_PAGE_SIZE));
+  std::vector<char> unaligned_storage(BUSTUB_PAGE_SIZE + 1);
+  char *unaligned = unaligned_storage.data() + 1;
+
+  // Scenario: single pages go through both kinds of buffers.
+  std::memset(aligned, 'a', BUSTUB_PAGE_SIZE);
+  std::memset(unaligned, 'u', BUSTUB_PAGE_SIZE);
+  dm.WritePage(0, aligned);
+  dm.WritePage(1, unaligned);
+  dm.ReadPage(1, aligned);
+  EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, 'u'), std::string(aligned, BUSTUB_PAGE_SIZE));
+  dm.ReadPage(0, unaligned);
+  EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, 'a'), std::string(unaligned, BUSTUB_PAGE_SIZE));
+
+  // Scenario: a batch with an unaligned buffer is still written and read in full, and past the end reads as zeros.
+  std::memset(aligned, 'b', 2 * BUSTUB_PAGE_SIZE);
+  std::memset(unaligned, 'c', BUSTUB_PAGE_SIZE);
+  dm.WritePages({{2, aligned}, {3, aligned + BUSTUB_PAGE_SIZE}, {4, unaligned}});
+  dm.ReadPages({{4, aligned}, {100, aligned + BUSTUB_PAGE_SIZE}, {2, unaligned}});
+  EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, 'c'), std::string(aligned, BUSTUB_PAGE_SIZE));
+  EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, 0), std::string(aligned + BUSTUB_PAGE_SIZE, BUSTUB_PAGE_SIZE));
+  EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, 'b'), std::string(unaligned, BUSTUB_PAGE_SIZE));
+  EXPECT_EQ(5, dm.GetNumWrites());
+  dm.ShutDown();
+
+  // Scenario: the file reads the same without direct I/O.
+  auto buffered = DiskManager(db_file);
+  EXPECT_FALSE(buffered.IsDirectIo());
+  const char expected[] = "aubbc";
+  for (page_id_t page_id = 0; page_id < 5; page_id++) {
+    buffered.ReadPage(page_id, aligned);
+    EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, expected[page_id]), std::string(aligned, BUSTUB_PAGE_SIZE));
+  }
+  buffered.ShutDown();
+  std::free(aligned);
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ReadAheadTest) {
+  const page_id_t num_pages = 200;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  std::vector<char> buf(BUSTUB_PAGE_SIZE);
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    std::fill(buf.begin(), buf.end(), static_cast<char>(page_id));
+    dm.WritePage(page_id, buf.data());
+  }
+  EXPECT_EQ(0, dm.GetReadAheadStats().extents_);
+  dm.EnableReadAhead();
+  auto expect_page = [&](page_id_t page_id, char value) {
+    dm.ReadPage(page_id, buf.data());
+    ASSERT_EQ(std::vector<char>(BUSTUB_PAGE_SIZE, value), buf) << "page " << page_id;
+  };
+
+  // Scenario: from its third page on, a scan reads extents of 16, 32 and then 64 pages, the last one cut short by the
+  // end of the file.
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    expect_page(page_id, static_cast<char>(page_id));
+  }
+  auto stats = dm.GetReadAheadStats();
+  EXPECT_EQ(5, stats.extents_);
+  EXPECT_EQ(16 + 32 + 64 + 64 + 17, stats.pages_read_ahead_);
+  EXPECT_EQ(stats.pages_read_ahead_, stats.hits_);
+  EXPECT_EQ(0, stats.wasted_);
+
+  // Scenario: reads elsewhere read nothing ahead.
+  for (page_id_t page_id : {50, 10, 90, 30}) {
+    expect_page(page_id, static_cast<char>(page_id));
+  }
+  EXPECT_EQ(5, dm.GetReadAheadStats().extents_);
+
+  // Scenario: a page written while it is staged reads as written, and its staged copy is wasted. The stream reads it
+  // from disk, along with the one page before those that are staged still.
+  for (page_id_t page_id = 0; page_id < 3; page_id++) {
+    expect_page(page_id, static_cast<char>(page_id));
+  }
+  std::fill(buf.begin(), buf.end(), 'w');
+  dm.WritePage(5, buf.data());
+  dm.WritePages({{6, buf.data()}}, false);
+  for (page_id_t page_id = 3; page_id < 19; page_id++) {
+    expect_page(page_id, page_id == 5 || page_id == 6 ? 'w' : static_cast<char>(page_id));
+  }
+  stats = dm.GetReadAheadStats();
+  EXPECT_EQ(7, stats.extents_);
+  EXPECT_EQ(16 + 32 + 64 + 64 + 17 + 16 + 1, stats.pages_read_ahead_);
+  EXPECT_EQ(2, stats.wasted_);
+  dm.ShutDown();
+
+  // Scenario: the staging area holds no more than it is given, and a scan that moves on wastes what it left behind.
+  auto small = DiskManager(db_file);
+  small.EnableReadAhead(8 * BUSTUB_PAGE_SIZE);
+  for (page_id_t page_id : {0, 1, 2, 100, 101, 102}) {
+    small.ReadPage(page_id, buf.data());
+  }
+  stats = small.GetReadAheadStats();
+  EXPECT_EQ(2, stats.extents_);
+  EXPECT_EQ(16, stats.pages_read_ahead_);
+  EXPECT_EQ(8, stats.wasted_);
+  for (page_id_t page_id = 103; page_id < 111; page_id++) {
+    small.ReadPage(page_id, buf.data());
+    ASSERT_EQ(std::vector<char>(BUSTUB_PAGE_SIZE, static_cast<char>(page_id)), buf) << "page " << page_id;
+  }
+  EXPECT_EQ(8, small.GetReadAheadStats().hits_);
+  small.ShutDown();
+
+  // Scenario: threads scanning at the same time each have a stream of their own.
+  auto shared = DiskManager(db_file);
+  shared.EnableReadAhead();
+  const page_id_t num_threads = 4;
+  std::vector<std::thread> threads;
+  for (page_id_t t = 0; t < num_threads; t++) {
+    threads.emplace_back([&shared, t] {
+      std::vector<char> out(BUSTUB_PAGE_SIZE);
+      for (auto page_id = t * num_pages / num_threads; page_id < (t + 1) * num_pages / num_threads; page_id++) {
+        shared.ReadPage(page_id, out.data());
+        auto expected = page_id == 5 || page_id == 6 ? 'w' : static_cast<char>(page_id);
+        ASSERT_EQ(std::vector<char>(BUSTUB_PAGE_SIZE, expected), out) << "page " << page_id;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_LT(0, shared.GetReadAheadStats().hits_);
+  shared.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, FreeSpaceMapTest) {
+  std::string db_file("test.db");
+  const auto pages_per_map = static_cast<page_id_t>(BUSTUB_PAGE_SIZE * 8);
+  std::vector<char> data(BUSTUB_PAGE_SIZE);
+  std::vector<char> buf(BUSTUB_PAGE_SIZE);
+  {
+    auto dm = DiskManager(db_file);
+    EXPECT_TRUE(dm.HasFreeSpaceMap());
+
+    // Scenario: pages are allocated in order, and a freed page is handed out again, the lowest first.
+    for (page_id_t page_id = 0; page_id < 6; page_id++) {
+      bool reused = true;
+      EXPECT_EQ(page_id, dm.AllocatePage(0, 1, &reused));
+      EXPECT_FALSE(reused);
+    }
+    EXPECT_TRUE(dm.DeallocatePage(4));
+    EXPECT_TRUE(dm.DeallocatePage(1));
+    EXPECT_TRUE(dm.DeallocatePage(2));
+    EXPECT_FALSE(dm.DeallocatePage(2));
+    EXPECT_FALSE(dm.DeallocatePage(100));
+    auto stats = dm.GetFreeSpaceStats();
+    EXPECT_EQ(6, stats.num_pages_);
+    EXPECT_EQ(3, stats.allocated_pages_);
+    EXPECT_EQ(3, stats.free_pages_);
+    EXPECT_EQ(2, stats.free_runs_);
+    EXPECT_EQ(2, stats.largest_free_run_);
+    bool reused = false;
+    EXPECT_EQ(2, dm.AllocatePage(0, 1, &reused));
+    EXPECT_TRUE(reused);
+
+    // Scenario: striped allocation only hands out pages of the stripe asked for.
+    EXPECT_EQ(1, dm.AllocatePage(1, 3));
+    EXPECT_EQ(4, dm.AllocatePage(1, 3));
+    EXPECT_EQ(7, dm.AllocatePage(1, 3));
+    EXPECT_EQ(6, dm.AllocatePage(0, 3));
+    EXPECT_EQ(8, dm.AllocatePage(2, 3));
+    EXPECT_EQ(0, dm.GetFreeSpaceStats().free_pages_);
+
+    // Scenario: pages on both sides of a map page are written and read in one batch.
+    std::vector<std::vector<char>> pages(3, std::vector<char>(BUSTUB_PAGE_SIZE));
+    std::vector<DiskManager::PageWrite> writes;
+    for (page_id_t i = 0; i < 3; i++) {
+      std::fill(pages[i].begin(), pages[i].end(), static_cast<char>('x' + i));
+      writes.emplace_back(pages_per_map - 1 + i, pages[i].data());
+    }
+    dm.WritePages(writes);
+    std::fill(data.begin(), data.end(), 'a');
+    dm.WritePage(0, data.data());
+    dm.DeallocatePage(3);
+    dm.ShutDown();
+  }
+
+  // Scenario: after a restart the allocated pages are still allocated and allocation goes on where it left off.
+  auto dm = DiskManager(db_file);
+  EXPECT_TRUE(dm.IsAllocated(8));
+  EXPECT_FALSE(dm.IsAllocated(3));
+  EXPECT_EQ(9, dm.GetFreeSpaceStats().num_pages_);
+  EXPECT_EQ(3, dm.AllocatePage());
+  EXPECT_EQ(9, dm.AllocatePage());
+  dm.ReadPage(0, buf.data());
+  EXPECT_EQ(data, buf);
+  for (page_id_t i = 0; i < 3; i++) {
+    dm.ReadPage(pages_per_map - 1 + i, buf.data());
+    EXPECT_EQ(std::vector<char>(BUSTUB_PAGE_SIZE, static_cast<char>('x' + i)), buf);
+  }
+
+  // Scenario: a limit stops new pages, never below the allocated ones, while freed pages are still handed out.
+  EXPECT_FALSE(dm.LimitPages(9));
+  EXPECT_TRUE(dm.LimitPages(11));
+  EXPECT_EQ(10, dm.AllocatePage());
+  EXPECT_THROW(dm.AllocatePage(), std::logic_error);
+  EXPECT_TRUE(dm.DeallocatePage(5));
+  EXPECT_EQ(5, dm.AllocatePage());
+  dm.ShutDown();
+
+  // Scenario: a file without a free-space map hands out pages past its end.
+  {
+    std::ofstream legacy("test.db", std::ios::binary | std::ios::trunc);
+    std::vector<char> superblock(BUSTUB_PAGE_SIZE, 0);
+    std::memcpy(superblock.data(), "BUSTUBDB", 8);
+    uint32_t page_size = BUSTUB_PAGE_SIZE;
+    std::memcpy(superblock.data() + 8, &page_size, sizeof(page_size));
+    legacy.write(superblock.data(), superblock.size());
+    for (int i = 0; i < 3; i++) {
+      legacy.write(data.data(), data.size());
+    }
+  }
+  auto legacy_dm = DiskManager(db_file);
+  EXPECT_FALSE(legacy_dm.HasFreeSpaceMap());
+  legacy_dm.ReadPage(2, buf.data());
+  EXPECT_EQ(data, buf);
+  EXPECT_EQ(3, legacy_dm.AllocatePage());
+  legacy_dm.ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ReadWriteLogTest) {
   char buf[16] = {0};
@@ -72,6 +400,38 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, PageSizeTest) {
+  const size_t page_size = 4 * BUSTUB_PAGE_SIZE;
+  std::vector<char> buf(page_size);
+  std::vector<char> data(page_size);
+  std::string db_file("test.db");
+  {
+    auto dm = DiskManager(db_file, page_size);
+    EXPECT_EQ(page_size, dm.GetPageSize());
+    for (size_t i = 0; i < page_size; i++) {
+      data[i] = static_cast<char>(i % 127);
+    }
+    dm.WritePage(0, data.data());
+    dm.WritePage(3, data.data());
+    dm.ShutDown();
+  }
+
+  // the page size is read back from the file, whatever the caller asks for
+  auto dm = DiskManager(db_file);
+  EXPECT_EQ(page_size, dm.GetPageSize());
+  dm.ReadPage(3, buf.data());
+  EXPECT_EQ(0, std::memcmp(buf.data(), data.data(), page_size));
+  dm.ReadPage(0, buf.data());
+  EXPECT_EQ(0, std::memcmp(buf.data(), data.data(), page_size));
+  dm.ShutDown();
+
+  EXPECT_THROW(DiskManager("test2.db", 3000), Exception);
+  EXPECT_THROW(DiskManager("test2.db", 2 * BUSTUB_MAX_PAGE_SIZE), Exception);
+  remove("test2.db");
+  remove("test2.log");
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
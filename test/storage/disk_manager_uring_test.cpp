@@ -0,0 +1,157 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_uring_test.cpp
+//
+// Identification: test/storage/disk_manager_uring_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_uring.h"
+
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+class DiskManagerUringTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerUringTest, ReadWritePagesTest) {
+  // every scenario runs through io_uring and through the pread/pwrite fallback
+  for (bool use_uring : {true, false}) {
+    remove("test.db");
+    DiskManagerUring dm("test.db", BUSTUB_PAGE_SIZE, use_uring);
+    if (!use_uring) {
+      EXPECT_FALSE(dm.IsUringEnabled());
+    }
+
+    // Scenario: a batch with more runs than a ring holds, out of order, lands on the right pages.
+    const size_t num_runs = DiskManagerUring::RING_ENTRIES * 2 + 3;
+    std::vector<page_id_t> page_ids;
+    for (size_t run = num_runs; run-- > 0;) {
+      // runs of two pages with a gap between them
+      page_ids.push_back(static_cast<page_id_t>(run * 3 + 1));
+      page_ids.push_back(static_cast<page_id_t>(run * 3));
+    }
+    std::vector<std::vector<char>> data;
+    std::vector<DiskManager::PageWrite> writes;
+    for (auto page_id : page_ids) {
+      data.emplace_back(BUSTUB_PAGE_SIZE, static_cast<char>(page_id));
+    }
+    for (size_t i = 0; i < page_ids.size(); i++) {
+      writes.emplace_back(page_ids[i], data[i].data());
+    }
+    auto submits = dm.GetNumSubmits();
+    dm.WritePages(writes);
+    EXPECT_EQ(static_cast<int>(page_ids.size()), dm.GetNumWrites());
+    if (dm.IsUringEnabled()) {
+      // one submission per ring full
+      EXPECT_EQ(submits + 3, dm.GetNumSubmits());
+    }
+    std::vector<char> buf(BUSTUB_PAGE_SIZE);
+    for (auto page_id : page_ids) {
+      dm.ReadPage(page_id, buf.data());
+      ASSERT_EQ(std::vector<char>(BUSTUB_PAGE_SIZE, static_cast<char>(page_id)), buf) << "page " << page_id;
+    }
+
+    // Scenario: a batched read sees the pages, the gaps between them and pages past the end of the file as zeros.
+    auto num_pages = static_cast<page_id_t>(num_runs * 3 + 4);
+    std::vector<std::vector<char>> bufs(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE, 'x'));
+    std::vector<DiskManager::PageRead> reads;
+    for (page_id_t page_id = num_pages; page_id-- > 0;) {
+      reads.emplace_back(page_id, bufs[page_id].data());
+    }
+    dm.ReadPages(reads);
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      bool written = page_id % 3 != 2 && page_id < static_cast<page_id_t>(num_runs * 3);
+      auto expected = written ? static_cast<char>(page_id) : 0;
+      ASSERT_EQ(std::vector<char>(BUSTUB_PAGE_SIZE, expected), bufs[page_id]) << "page " << page_id;
+    }
+    dm.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerUringTest, ConcurrentBatchTest) {
+  const size_t num_threads = 8;
+  const size_t pages_per_thread = 16;
+  DiskManagerUring dm("test.db");
+
+  // Scenario: threads write and read batches of their own pages at the same time, each on a ring of its own.
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; t++) {
+    threads.emplace_back([&dm, t] {
+      std::vector<std::vector<char>> data(pages_per_thread, std::vector<char>(BUSTUB_PAGE_SIZE));
+      std::vector<std::vector<char>> out(pages_per_thread, std::vector<char>(BUSTUB_PAGE_SIZE));
+      for (size_t round = 0; round < 20; round++) {
+        std::vector<DiskManager::PageWrite> writes;
+        std::vector<DiskManager::PageRead> reads;
+        for (size_t i = 0; i < pages_per_thread; i++) {
+          auto page_id = static_cast<page_id_t>(i * num_threads + t);
+          std::fill(data[i].begin(), data[i].end(), static_cast<char>(page_id + round));
+          writes.emplace_back(page_id, data[i].data());
+          reads.emplace_back(page_id, out[i].data());
+        }
+        dm.WritePages(writes, round % 2 == 0);
+        dm.ReadPages(reads);
+        ASSERT_EQ(data, out) << "thread " << t;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads * pages_per_thread * 20, dm.GetNumWrites());
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerUringTest, ReadWriteLogTest) {
+  // WriteLog wants the log buffers swapped between calls
+  char data1[16] = {0};
+  char data2[16] = {0};
+  char buf[16] = {0};
+  std::strncpy(data1, "first record", sizeof(data1));
+  std::strncpy(data2, "second record", sizeof(data2));
+
+  // Scenario: log appends land one after the other, also after reopening the log.
+  {
+    DiskManagerUring dm("test.db");
+    dm.WriteLog(data1, sizeof(data1));
+    dm.WriteLog(data2, sizeof(data2));
+    EXPECT_EQ(2, dm.GetNumFlushes());
+    EXPECT_FALSE(dm.GetFlushState());
+    dm.ShutDown();
+  }
+  DiskManagerUring dm("test.db");
+  dm.WriteLog(data1, sizeof(data1));
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(dm.ReadLog(buf, sizeof(buf), i * static_cast<int>(sizeof(buf))));
+    EXPECT_STREQ(i == 1 ? data2 : data1, buf);
+  }
+  EXPECT_FALSE(dm.ReadLog(buf, sizeof(buf), 3 * sizeof(buf)));
+  dm.ShutDown();
+}
+
+}  // namespace bustub
@@ -0,0 +1,132 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler_test.cpp
+//
+// Identification: test/storage/disk_scheduler_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_scheduler.h"
+
+#include <condition_variable>  // NOLINT
+#include <cstring>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "storage/disk/disk_manager_memory.h"
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, ScheduleWriteReadPageTest) {
+  auto dm = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto disk_scheduler = std::make_unique<DiskScheduler>(dm.get());
+
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  // Scenario: a read scheduled right after a write of the same page sees the write.
+  auto promise1 = disk_scheduler->CreatePromise();
+  auto future1 = promise1.get_future();
+  auto promise2 = disk_scheduler->CreatePromise();
+  auto future2 = promise2.get_future();
+  disk_scheduler->Schedule({true, data, 0, std::move(promise1)});
+  disk_scheduler->Schedule({false, buf, 0, std::move(promise2)});
+  ASSERT_TRUE(future1.get());
+  ASSERT_TRUE(future2.get());
+  ASSERT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  // Scenario: requests for one page complete in order, whichever workers pick them up.
+  std::vector<std::vector<char>> versions(20, std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<std::vector<char>> reads(20, std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<std::future<bool>> futures;
+  for (size_t i = 0; i < versions.size(); i++) {
+    std::fill(versions[i].begin(), versions[i].end(), static_cast<char>(i));
+    futures.push_back(disk_scheduler->ScheduleWrite(1, versions[i].data()));
+    futures.push_back(disk_scheduler->ScheduleRead(1, reads[i].data()));
+  }
+  for (auto &future : futures) {
+    ASSERT_TRUE(future.get());
+  }
+  for (size_t i = 0; i < versions.size(); i++) {
+    EXPECT_EQ(versions[i], reads[i]) << "version " << i;
+  }
+
+  // Scenario: requests still queued when the scheduler is destroyed complete first.
+  auto future3 = disk_scheduler->ScheduleWrite(2, data);
+  disk_scheduler.reset();
+  ASSERT_EQ(std::future_status::ready, future3.wait_for(std::chrono::seconds(0)));
+  dm->ReadPage(2, buf);
+  ASSERT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+}
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, BatchTest) {
+  /** Holds up the first write until released, and remembers how many pages every vectored read asked for. */
+  class BlockingDiskManager : public DiskManagerUnlimitedMemory {
+   public:
+    void WritePages(std::vector<PageWrite> pages, bool sync) override {
+      std::unique_lock<std::mutex> lock(latch_);
+      entered_ = true;
+      cv_.notify_all();
+      cv_.wait(lock, [this] { return released_; });
+      lock.unlock();
+      DiskManagerUnlimitedMemory::WritePages(std::move(pages), sync);
+    }
+    void ReadPages(std::vector<PageRead> pages) override {
+      {
+        std::lock_guard<std::mutex> guard(latch_);
+        read_sizes_.push_back(pages.size());
+      }
+      DiskManagerUnlimitedMemory::ReadPages(std::move(pages));
+    }
+    void WaitEntered() {
+      std::unique_lock<std::mutex> lock(latch_);
+      cv_.wait(lock, [this] { return entered_; });
+    }
+    void Release() {
+      std::lock_guard<std::mutex> guard(latch_);
+      released_ = true;
+      cv_.notify_all();
+    }
+    std::mutex latch_;
+    std::condition_variable cv_;
+    bool entered_{false};
+    bool released_{false};
+    std::vector<size_t> read_sizes_;
+  };
+  auto dm = std::make_unique<BlockingDiskManager>();
+  auto disk_scheduler = std::make_unique<DiskScheduler>(dm.get(), 1);
+
+  // Scenario: reads queued while the only worker is busy are serviced together in one batch.
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::strncpy(data, "page 0", sizeof(data));
+  auto write = disk_scheduler->ScheduleWrite(0, data);
+  dm->WaitEntered();
+  const size_t num_reads = 10;
+  std::vector<std::vector<char>> bufs(num_reads, std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<std::future<bool>> reads;
+  // the read of page 0 may not overtake the write, which is done by the time the worker looks at the queue again
+  for (size_t i = 0; i < num_reads; i++) {
+    reads.push_back(disk_scheduler->ScheduleRead(static_cast<page_id_t>(i), bufs[i].data()));
+  }
+  dm->Release();
+  ASSERT_TRUE(write.get());
+  for (auto &read : reads) {
+    ASSERT_TRUE(read.get());
+  }
+  EXPECT_EQ(0, std::strcmp(bufs[0].data(), "page 0"));
+  EXPECT_EQ(2, disk_scheduler->GetNumBatches());
+  EXPECT_EQ(std::vector<size_t>{num_reads}, dm->read_sizes_);
+}
+
+}  // namespace bustub
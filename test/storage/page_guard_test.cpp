@@ -10,9 +10,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "storage/disk/disk_manager_memory.h"
@@ -48,4 +51,90 @@ TEST(PageGuardTest, SampleTest) {
   disk_manager->ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST(PageGuardTest, OptimisticTest) {
+  const size_t buffer_pool_size = 5;
+
+  auto disk_manager = std::make_shared<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_shared<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+
+  page_id_t page_id;
+  auto *page0 = bpm->NewPage(&page_id);
+  bpm->UnpinPage(page_id, false);
+
+  // Scenario: readers do not invalidate an optimistic read, a writer does.
+  auto optimistic_guard = bpm->FetchPageOptimistic(page_id);
+  EXPECT_EQ(page0->GetData(), optimistic_guard.GetData());
+  EXPECT_EQ(1, page0->GetPinCount());
+  bpm->FetchPageRead(page_id).Drop();
+  EXPECT_TRUE(optimistic_guard.Validate());
+  {
+    auto write_guard = bpm->FetchPageWrite(page_id);
+    EXPECT_FALSE(optimistic_guard.Validate());
+    // Scenario: an optimistic read that starts while a writer holds the page never validates.
+    auto during_write_guard = bpm->FetchPageOptimistic(page_id);
+    EXPECT_FALSE(during_write_guard.Validate());
+  }
+  EXPECT_FALSE(optimistic_guard.Validate());
+  EXPECT_TRUE(bpm->FetchPageOptimistic(page_id).Validate());
+
+  optimistic_guard.Drop();
+  EXPECT_EQ(0, page0->GetPinCount());
+
+  // Scenario: a validated read never sees a half-done write. The writer keeps both halves of the page equal.
+  std::thread writer([&bpm, page_id] {
+    for (int i = 1; i <= 10000; i++) {
+      auto write_guard = bpm->FetchPageWrite(page_id);
+      auto *data = write_guard.AsMut<std::atomic<int>>();
+      data[0].store(i, std::memory_order_relaxed);
+      data[1].store(i, std::memory_order_relaxed);
+    }
+  });
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 2; t++) {
+    readers.emplace_back([&bpm, page_id] {
+      for (int i = 0; i < 10000; i++) {
+        auto guard = bpm->FetchPageOptimistic(page_id);
+        auto *data = guard.As<std::atomic<int>>();
+        int first = data[0].load(std::memory_order_relaxed);
+        int second = data[1].load(std::memory_order_relaxed);
+        if (guard.Validate()) {
+          EXPECT_EQ(first, second);
+        }
+      }
+    });
+  }
+  writer.join();
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(0, page0->GetPinCount());
+
+  disk_manager->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, NoFreeFrameTest) {
+  auto disk_manager = std::make_shared<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_shared<BufferPoolManager>(1, disk_manager.get());
+
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  bpm->UnpinPage(page_id, true);
+  page_id_t pinned_page_id;
+  auto pinned_guard = bpm->NewPageGuarded(&pinned_page_id);
+
+  // Scenario: with every frame pinned, the guards come back empty instead of crashing.
+  EXPECT_EQ(nullptr, bpm->FetchPageRead(page_id).GetData());
+  EXPECT_EQ(nullptr, bpm->FetchPageWrite(page_id).GetData());
+  auto optimistic_guard = bpm->FetchPageOptimistic(page_id);
+  EXPECT_EQ(nullptr, optimistic_guard.GetData());
+  EXPECT_FALSE(optimistic_guard.Validate());
+
+  pinned_guard.Drop();
+  EXPECT_NE(nullptr, bpm->FetchPageRead(page_id).GetData());
+
+  disk_manager->ShutDown();
+}
+
 }  // namespace bustub
@@ -1,4 +1,8 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstdio>
 #include <iostream>
 #include <memory>
 #include <mutex>  // NOLINT
@@ -20,8 +24,19 @@
 #include "fmt/core.h"
 #include "fmt/std.h"
 #include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_manager_uring.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
 
 auto ClockMs() -> uint64_t {
   struct timeval tm;
@@ -34,6 +49,7 @@ static const size_t BUSTUB_GET_THREAD = 8;
 static const size_t LRU_K_SIZE = 16;
 static const size_t BUSTUB_PAGE_CNT = 6400;
 static const size_t BUSTUB_BPM_SIZE = 64;
+static const size_t BUSTUB_TRACE_LENGTH = 1000000;
 
 struct BpmTotalMetrics {
   uint64_t scan_cnt_{0};
@@ -100,6 +116,261 @@ struct BpmMetrics {
   }
 };
 
+/**
+ * Count the data TLB load misses of the process, including the threads it starts while counting. Reports nothing
+ * where hardware perf events are not available, e.g. in most containers.
+ */
+class TlbMissCounter {
+ public:
+  TlbMissCounter() {
+#ifdef __linux__
+    perf_event_attr attr{};
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+  }
+
+  ~TlbMissCounter() {
+#ifdef __linux__
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+#endif
+  }
+
+  void Start() {
+#ifdef __linux__
+    if (fd_ >= 0) {
+      ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+
+  /** @return the misses since Start, or a note why there are none. Counted threads must have exited. */
+  auto Stop() -> std::string {
+#ifdef __linux__
+    uint64_t misses;
+    if (fd_ >= 0 && ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0) == 0 &&
+        read(fd_, &misses, sizeof(misses)) == static_cast<ssize_t>(sizeof(misses))) {
+      return std::to_string(misses);
+    }
+#endif
+    return "unavailable";
+  }
+
+ private:
+  int fd_{-1};
+};
+
+auto ParseHugePagePolicy(const std::string &name) -> bustub::HugePagePolicy {
+  if (name == "none") {
+    return bustub::HugePagePolicy::None;
+  }
+  if (name == "transparent") {
+    return bustub::HugePagePolicy::Transparent;
+  }
+  if (name == "explicit") {
+    return bustub::HugePagePolicy::Explicit;
+  }
+  throw bustub::Exception(fmt::format("unknown huge page policy {}", name));
+}
+
+auto HugePagePolicyName(bustub::HugePagePolicy policy) -> const char * {
+  switch (policy) {
+    case bustub::HugePagePolicy::None:
+      return "none";
+    case bustub::HugePagePolicy::Transparent:
+      return "transparent";
+    case bustub::HugePagePolicy::Explicit:
+      return "explicit";
+  }
+  return "unknown";
+}
+
+auto ParseReplacerPolicy(const std::string &name) -> bustub::ReplacerPolicy {
+  bustub::ReplacerPolicy policy;
+  if (!bustub::ParseReplacerPolicy(name, &policy)) {
+    throw bustub::Exception(fmt::format("unknown replacer {}", name));
+  }
+  return policy;
+}
+
+static const std::array<bustub::ReplacerPolicy, 4> ALL_REPLACER_POLICIES{
+    bustub::ReplacerPolicy::LRUK, bustub::ReplacerPolicy::Clock, bustub::ReplacerPolicy::TwoQ,
+    bustub::ReplacerPolicy::ARC};
+
+/**
+ * Measure the buffer pool hit path alone: every page fits in the pool, so each FetchPage is a hit and each UnpinPage
+ * only makes the frame evictable again.
+ */
+auto HitPathThroughput(bustub::ReplacerPolicy policy, uint64_t num_instances, uint64_t duration_ms) -> double {
+  using bustub::AccessType;
+  using bustub::page_id_t;
+
+  auto disk_manager = std::make_unique<bustub::DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<bustub::BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE, nullptr,
+                                                         num_instances, policy);
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < BUSTUB_BPM_SIZE; i++) {
+    page_id_t page_id;
+    if (bpm->NewPage(&page_id) == nullptr) {
+      throw std::runtime_error("new page failed");
+    }
+    bpm->UnpinPage(page_id, false);
+    page_ids.push_back(page_id);
+  }
+
+  std::atomic<uint64_t> total_cnt{0};
+  std::vector<std::thread> threads;
+  auto start_time = ClockMs();
+  for (size_t thread_id = 0; thread_id < BUSTUB_GET_THREAD; thread_id++) {
+    threads.emplace_back([thread_id, &page_ids, &bpm, duration_ms, start_time, &total_cnt] {
+      uint64_t cnt = 0;
+      size_t page_idx = thread_id;
+      while (ClockMs() - start_time < duration_ms) {
+        auto page_id = page_ids[page_idx];
+        if (bpm->FetchPage(page_id, AccessType::Get) == nullptr) {
+          throw std::runtime_error("hit path missed");
+        }
+        bpm->UnpinPage(page_id, false, AccessType::Get);
+        page_idx = (page_idx + 1) % page_ids.size();
+        cnt++;
+      }
+      total_cnt += cnt;
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return total_cnt / static_cast<double>(ClockMs() - start_time) * 1000;
+}
+
+/**
+ * Build the trace replayed by --compare-replacers: the accesses of the benchmark threads, one scan access for every get
+ * like with BUSTUB_SCAN_THREAD scan and BUSTUB_GET_THREAD get threads. The scans walk the pages from
+ * BUSTUB_SCAN_THREAD evenly spaced starting points in turn, the gets follow the same zipfian distribution. The seed is
+ * fixed, so every policy sees the same trace.
+ */
+auto MakeTrace(size_t num_accesses) -> std::vector<std::pair<size_t, bustub::AccessType>> {
+  std::default_random_engine gen(42);
+  zipfian_int_distribution<size_t> dist(0, BUSTUB_PAGE_CNT - 1, 0.8);
+  std::vector<size_t> scan_positions;
+  for (size_t i = 0; i < BUSTUB_SCAN_THREAD; i++) {
+    scan_positions.push_back(BUSTUB_PAGE_CNT * i / BUSTUB_SCAN_THREAD);
+  }
+  std::vector<std::pair<size_t, bustub::AccessType>> trace;
+  trace.reserve(num_accesses);
+  for (size_t i = 0; i < num_accesses; i++) {
+    if (i % 2 == 0) {
+      auto &position = scan_positions[(i / 2) % BUSTUB_SCAN_THREAD];
+      trace.emplace_back(position, bustub::AccessType::Scan);
+      position = (position + 1) % BUSTUB_PAGE_CNT;
+    } else {
+      trace.emplace_back(dist(gen), bustub::AccessType::Get);
+    }
+  }
+  return trace;
+}
+
+/**
+ * Replay a trace from a single thread against a fresh buffer pool with the given policy, and print the hit ratios and
+ * throughput.
+ */
+void ReplayTrace(bustub::ReplacerPolicy policy, const std::vector<std::pair<size_t, bustub::AccessType>> &trace,
+                 size_t bpm_size, uint64_t num_instances) {
+  using bustub::AccessType;
+  using bustub::page_id_t;
+
+  auto disk_manager = std::make_unique<bustub::DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<bustub::BufferPoolManager>(bpm_size, disk_manager.get(), LRU_K_SIZE, nullptr,
+                                                         num_instances, policy);
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < BUSTUB_PAGE_CNT; i++) {
+    page_id_t page_id;
+    if (bpm->NewPage(&page_id) == nullptr) {
+      throw std::runtime_error("new page failed");
+    }
+    bpm->UnpinPage(page_id, false);
+    page_ids.push_back(page_id);
+  }
+
+  auto before = bpm->GetStats();
+  auto start = std::chrono::steady_clock::now();
+  for (const auto &[page_idx, access_type] : trace) {
+    if (bpm->FetchPage(page_ids[page_idx], access_type) == nullptr) {
+      throw std::runtime_error("fetch page failed");
+    }
+    bpm->UnpinPage(page_ids[page_idx], false, access_type);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  auto stats = bpm->GetStats().Since(before);
+
+  auto ratio = [&stats](AccessType access_type) {
+    auto hits = stats.hits_[static_cast<size_t>(access_type)];
+    auto total = hits + stats.misses_[static_cast<size_t>(access_type)];
+    return total == 0 ? 0.0 : hits / static_cast<double>(total);
+  };
+  fmt::print(stderr,
+             "[info] replacer {:<5}: hit_ratio={:.4f} get_hit_ratio={:.4f} scan_hit_ratio={:.4f} ops/s={:.3f}\n",
+             bustub::ReplacerPolicyToString(policy), stats.HitRatio(), ratio(AccessType::Get),
+             ratio(AccessType::Scan), trace.size() / elapsed.count());
+}
+
+/** The database file of the file-backed disk managers, and its log. Both are removed before and after a run. */
+static const char *const BENCH_DB_FILE = "bpm_bench.db";
+static const char *const BENCH_LOG_FILE = "bpm_bench.log";
+
+/** Create the disk manager named by --disk: memory, file (pread/pwrite) or uring. */
+auto MakeDiskManager(const std::string &name, bool direct_io) -> std::unique_ptr<bustub::DiskManager> {
+  if (name == "memory") {
+    return std::make_unique<bustub::DiskManagerUnlimitedMemory>();
+  }
+  if (name == "file" || name == "uring") {
+    std::remove(BENCH_DB_FILE);
+    std::remove(BENCH_LOG_FILE);
+    return std::make_unique<bustub::DiskManagerUring>(BENCH_DB_FILE, bustub::BUSTUB_PAGE_SIZE, name == "uring",
+                                                      direct_io);
+  }
+  throw bustub::Exception(fmt::format("unknown disk {}", name));
+}
+
+/**
+ * Count the pages of a file in the operating system page cache, which with buffered I/O hold a second copy of what the
+ * buffer pool caches. @return 0 if the file cannot be mapped
+ */
+auto CachedFileBytes(const char *file_name) -> size_t {
+  int fd = open(file_name, O_RDONLY);
+  struct stat stat_buf;
+  if (fd < 0 || fstat(fd, &stat_buf) != 0 || stat_buf.st_size == 0) {
+    if (fd >= 0) {
+      close(fd);
+    }
+    return 0;
+  }
+  auto length = static_cast<size_t>(stat_buf.st_size);
+  void *base = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    return 0;
+  }
+  auto os_page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  std::vector<unsigned char> resident((length + os_page_size - 1) / os_page_size);
+  size_t cached = 0;
+  if (mincore(base, length, resident.data()) == 0) {
+    cached = std::count_if(resident.begin(), resident.end(), [](unsigned char r) { return (r & 1) != 0; });
+  }
+  munmap(base, length);
+  return cached * os_page_size;
+}
+
 // NOLINTNEXTLINE
 auto main(int argc, char **argv) -> int {
   using bustub::AccessType;
@@ -109,7 +380,33 @@ auto main(int argc, char **argv) -> int {
 
   argparse::ArgumentParser program("bustub-bpm-bench");
   program.add_argument("--duration").help("run bpm bench for n milliseconds");
-  program.add_argument("--latency").help("set disk latency to n milliseconds");
+  program.add_argument("--latency").help("set disk latency to n milliseconds, for the memory disk");
+  program.add_argument("--disk").help("backing of the pages: memory (default), file (pread/pwrite) or uring");
+  program.add_argument("--direct-io")
+      .help("open the database file of --disk file or uring with O_DIRECT, bypassing the OS page cache")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--read-ahead")
+      .help("read extents ahead of sequential page reads of --disk file or uring")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--instances").help("split the buffer pool into n instances");
+  program.add_argument("--replacer").help("replacement policy: lru_k (default), clock, 2q or arc");
+  program.add_argument("--page-cleaner")
+      .help("run the background page cleaner with the default watermarks")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--bpm-size").help("number of frames in the buffer pool");
+  program.add_argument("--huge-pages").help("backing of the frames: none, transparent (default) or explicit");
+  program.add_argument("--compressed-cache").help("keep evicted pages in a compressed cache of n KiB");
+  program.add_argument("--hit-path")
+      .help("also measure hit-path throughput of every replacer for 1/10 of the duration each")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--compare-replacers")
+      .help("also replay one trace of the workload under every replacer and compare the hit ratios")
+      .default_value(false)
+      .implicit_value(true);
 
   try {
     program.parse_args(argc, argv);
@@ -129,12 +426,72 @@ auto main(int argc, char **argv) -> int {
     latency_ms = std::stoi(program.get("--latency"));
   }
 
-  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
-  auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
+  uint64_t num_instances = 1;
+  if (program.present("--instances")) {
+    num_instances = std::stoi(program.get("--instances"));
+  }
+
+  std::string replacer = "lru_k";
+  if (program.present("--replacer")) {
+    replacer = program.get("--replacer");
+  }
+  auto replacer_policy = ParseReplacerPolicy(replacer);
+
+  size_t bpm_size = BUSTUB_BPM_SIZE;
+  if (program.present("--bpm-size")) {
+    bpm_size = std::stoi(program.get("--bpm-size"));
+  }
+
+  std::string huge_pages = "transparent";
+  if (program.present("--huge-pages")) {
+    huge_pages = program.get("--huge-pages");
+  }
+  auto huge_page_policy = ParseHugePagePolicy(huge_pages);
+
+  size_t compressed_cache_kb = 0;
+  if (program.present("--compressed-cache")) {
+    compressed_cache_kb = std::stoi(program.get("--compressed-cache"));
+  }
+
+  std::string disk = "memory";
+  if (program.present("--disk")) {
+    disk = program.get("--disk");
+  }
+
+  if (program.get<bool>("--hit-path")) {
+    for (auto policy : ALL_REPLACER_POLICIES) {
+      fmt::print(stderr, "[info] hit path {}: {:.3f} ops/s\n", bustub::ReplacerPolicyToString(policy),
+                 HitPathThroughput(policy, num_instances, duration_ms / 10));
+    }
+  }
+
+  if (program.get<bool>("--compare-replacers")) {
+    auto trace = MakeTrace(BUSTUB_TRACE_LENGTH);
+    for (auto policy : ALL_REPLACER_POLICIES) {
+      ReplayTrace(policy, trace, bpm_size, num_instances);
+    }
+  }
+
+  auto disk_manager = MakeDiskManager(disk, program.get<bool>("--direct-io"));
+  bool read_ahead = program.get<bool>("--read-ahead");
+  if (read_ahead) {
+    disk_manager->EnableReadAhead();
+  }
+  auto startup_begin = std::chrono::steady_clock::now();
+  auto bpm = std::make_unique<BufferPoolManager>(bpm_size, disk_manager.get(), LRU_K_SIZE, nullptr, num_instances,
+                                                 replacer_policy, huge_page_policy, compressed_cache_kb * 1024);
+  std::chrono::duration<double, std::milli> startup = std::chrono::steady_clock::now() - startup_begin;
   std::vector<page_id_t> page_ids;
 
-  fmt::print(stderr, "[info] total_page={}, duration_ms={}, latency_ms={}, lru_k_size={}, bpm_size={}\n",
-             BUSTUB_PAGE_CNT, duration_ms, latency_ms, LRU_K_SIZE, BUSTUB_BPM_SIZE);
+  fmt::print(stderr,
+             "[info] total_page={}, duration_ms={}, latency_ms={}, lru_k_size={}, bpm_size={}, instances={}, "
+             "replacer={}\n",
+             BUSTUB_PAGE_CNT, duration_ms, latency_ms, LRU_K_SIZE, bpm_size, num_instances, replacer);
+  fmt::print(stderr, "[info] huge_pages={} (requested {}), startup_ms={:.3f}, compressed_cache_kb={}\n",
+             HugePagePolicyName(bpm->GetHugePagePolicy()), huge_pages, startup.count(), compressed_cache_kb);
+  auto *uring_disk = dynamic_cast<bustub::DiskManagerUring *>(disk_manager.get());
+  fmt::print(stderr, "[info] disk={}, io_uring={}, direct_io={}, read_ahead={}\n", disk,
+             uring_disk != nullptr && uring_disk->IsUringEnabled(), disk_manager->IsDirectIo(), read_ahead);
 
   for (size_t i = 0; i < BUSTUB_PAGE_CNT; i++) {
     page_id_t page_id;
@@ -150,11 +507,19 @@ auto main(int argc, char **argv) -> int {
   }
 
   // enable disk latency after creating all pages
-  disk_manager->SetLatency(latency_ms);
+  if (auto *memory_disk = dynamic_cast<DiskManagerUnlimitedMemory *>(disk_manager.get()); memory_disk != nullptr) {
+    memory_disk->SetLatency(latency_ms);
+  }
+  bool page_cleaner = program.get<bool>("--page-cleaner");
+  if (page_cleaner) {
+    bpm->StartPageCleaner();
+  }
 
   fmt::print(stderr, "[info] benchmark start\n");
 
   BpmTotalMetrics total_metrics;
+  TlbMissCounter tlb_misses;
+  tlb_misses.Start();
   total_metrics.Begin();
 
   std::vector<std::thread> threads;
@@ -222,11 +587,50 @@ auto main(int argc, char **argv) -> int {
     }));
   }
 
+  // print what the buffer pool did in the last second, next to the per-thread throughput
+  std::thread stats_thread([&bpm, duration_ms] {
+    auto start_time = ClockMs();
+    auto last_time = start_time;
+    auto last_stats = bpm->GetStats();
+    while (last_time - start_time < duration_ms) {
+      auto remaining_ms = duration_ms - (last_time - start_time);
+      std::this_thread::sleep_for(std::chrono::milliseconds(std::min<uint64_t>(1000, remaining_ms)));
+      auto now = ClockMs();
+      auto stats = bpm->GetStats();
+      fmt::print(stderr, "[{:5.2f}] stats: {}\n", (now - start_time) / 1000.0, stats.Since(last_stats).ToString());
+      last_time = now;
+      last_stats = stats;
+    }
+  });
+
   for (auto &thread : threads) {
     thread.join();
   }
+  stats_thread.join();
 
   total_metrics.Report();
+  fmt::print(stderr, "[info] dtlb_load_misses={}\n", tlb_misses.Stop());
+  auto stats = bpm->GetStats();
+  fmt::print(stderr, "[info] page_cleaner={}, foreground_write_backs={}, background_write_backs={}\n", page_cleaner,
+             stats.foreground_write_backs_, stats.background_write_backs_);
+  fmt::print(stderr, "[info] stats: {}\n", stats.ToString());
+  if (uring_disk != nullptr) {
+    fmt::print(stderr, "[info] disk_writes={}, io_uring_submits={}\n", uring_disk->GetNumWrites(),
+               uring_disk->GetNumSubmits());
+    auto read_ahead_stats = uring_disk->GetReadAheadStats();
+    fmt::print(stderr, "[info] read_ahead_extents={}, read_ahead_pages={}, read_ahead_hits={}, read_ahead_wasted={}\n",
+               read_ahead_stats.extents_, read_ahead_stats.pages_read_ahead_, read_ahead_stats.hits_,
+               read_ahead_stats.wasted_);
+    // the memory holding pages: the frames, plus what the OS caches of the file unless it is opened with O_DIRECT
+    auto pool_bytes = bpm_size * bustub::BUSTUB_PAGE_SIZE;
+    auto os_cached_bytes = CachedFileBytes(BENCH_DB_FILE);
+    fmt::print(stderr, "[info] pool_kib={}, os_cached_kib={}, total_kib={}\n", pool_bytes / 1024,
+               os_cached_bytes / 1024, (pool_bytes + os_cached_bytes) / 1024);
+    bpm.reset();
+    disk_manager.reset();
+    std::remove(BENCH_DB_FILE);
+    std::remove(BENCH_LOG_FILE);
+  }
 
   return 0;
 }
@@ -0,0 +1,84 @@
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "argparse/argparse.hpp"
+#include "common/exception.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager.h"
+
+/**
+ * Report how the pages of a database file are used: how many are allocated, how many were freed and not reused yet,
+ * and how the free ones are spread, from the free-space map of the file.
+ */
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-fragmentation-report");
+  program.add_argument("db_file").help("the database file to report on");
+  program.add_argument("--width").help("draw the file as a map n characters wide, 0 for none (default 64)");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  auto db_file = program.get("db_file");
+  size_t width = 64;
+  if (program.present("--width")) {
+    width = std::stoi(program.get("--width"));
+  }
+
+  struct stat stat_buf;
+  if (stat(db_file.c_str(), &stat_buf) != 0) {
+    fmt::print(stderr, "cannot open {}\n", db_file);
+    return 1;
+  }
+  // the disk manager creates the log file of the database if there is none; leave no trace behind
+  auto dot = db_file.rfind('.');
+  auto log_file = dot == std::string::npos ? "" : db_file.substr(0, dot) + ".log";
+  struct stat log_stat_buf;
+  bool had_log = log_file.empty() || stat(log_file.c_str(), &log_stat_buf) == 0;
+
+  try {
+    bustub::DiskManager disk_manager(db_file);
+    auto stats = disk_manager.GetFreeSpaceStats();
+    auto num_pages = static_cast<size_t>(stats.num_pages_);
+    fmt::print("file: {} ({} bytes), page size {}\n", db_file, stat_buf.st_size, disk_manager.GetPageSize());
+    if (!disk_manager.HasFreeSpaceMap()) {
+      fmt::print("free-space map: none, the file predates it; every page in it counts as allocated\n");
+    }
+    fmt::print("pages: {}, allocated {}, free {} ({:.1f}%)\n", num_pages, stats.allocated_pages_, stats.free_pages_,
+               num_pages == 0 ? 0.0 : 100.0 * stats.free_pages_ / num_pages);
+    fmt::print("free runs: {}, largest {} pages\n", stats.free_runs_, stats.largest_free_run_);
+
+    if (width > 0 && num_pages > 0) {
+      // one character per slice of the page ids: '#' all allocated, '.' all free, '+' some of each
+      std::string map;
+      for (size_t slice = 0; slice < std::min(width, num_pages); slice++) {
+        auto begin = slice * num_pages / std::min(width, num_pages);
+        auto end = (slice + 1) * num_pages / std::min(width, num_pages);
+        size_t allocated = 0;
+        for (auto page_id = begin; page_id < end; page_id++) {
+          allocated += disk_manager.IsAllocated(static_cast<bustub::page_id_t>(page_id)) ? 1 : 0;
+        }
+        map += allocated == end - begin ? '#' : allocated == 0 ? '.' : '+';
+      }
+      fmt::print("map: {}\n", map);
+    }
+    disk_manager.ShutDown();
+  } catch (const bustub::Exception &e) {
+    fmt::print(stderr, "cannot read {}: {}\n", db_file, e.what());
+    return 1;
+  }
+
+  if (!had_log) {
+    std::remove(log_file.c_str());
+  }
+  return 0;
+}